@@ -1,21 +1,86 @@
 #include "Engine/Allocators/BlockAllocator.hpp"
+#include "Engine/Allocators/SizeClassAllocator.hpp"
+#include "Engine/Allocators/UntrackedAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
 #include "Engine/Core/MemTracking.hpp"
+#include "Engine/Core/Time.hpp"
+#include <stdlib.h>
+#include <thread>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------
 typedef uint8_t byte;
 BlockAllocator* gBlockAllocator = nullptr;
 
+//Every Initialize gets a new id, slot owners hold the id of the live allocator using that magazine slot (0 when free)
+static std::atomic<uint64_t> gNextBlockAllocatorId = 1;
+static std::atomic<uint64_t> gBlockCacheSlotOwners[BLOCK_ALLOCATOR_MAX_THREAD_CACHES];
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ThreadBlockMagazines_T
+{
+	~ThreadBlockMagazines_T();
+
+	BlockMagazine_T		magazines[BLOCK_ALLOCATOR_MAX_THREAD_CACHES];
+};
+
+static thread_local ThreadBlockMagazines_T tBlockMagazines;
+
+//------------------------------------------------------------------------------------------------------------------------------
+ThreadBlockMagazines_T::~ThreadBlockMagazines_T()
+{
+	//Hand whatever this thread is holding back to the shared lists so exiting threads don't leak blocks
+	for (uint slotIndex = 0; slotIndex < BLOCK_ALLOCATOR_MAX_THREAD_CACHES; ++slotIndex)
+	{
+		BlockMagazine_T& magazine = magazines[slotIndex];
+		if (magazine.numFreeBlocks == 0)
+		{
+			continue;
+		}
+
+		//Only if the allocator that gave us these blocks is still alive
+		if (gBlockCacheSlotOwners[slotIndex].load(std::memory_order_acquire) != magazine.allocatorId)
+		{
+			continue;
+		}
+
+		Block_T* tail = magazine.freeBlocks;
+		while (tail->next != nullptr)
+		{
+			tail = tail->next;
+		}
+
+		magazine.allocator->PushFreeBlockList(magazine.freeBlocks, tail);
+		magazine.freeBlocks = nullptr;
+		magazine.numFreeBlocks = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uintptr_t AlignUp(uintptr_t value, size_t alignment)
+{
+	return (value + alignment - 1) & ~((uintptr_t)alignment - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BlockAllocator::~BlockAllocator()
+{
+	UnregisterThreadCaches();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 bool BlockAllocator::Initialize(InternalAllocator* base, size_t blockSize, size_t alignment, uint blocksPerChunk)
 {
 	m_base = base;
-	m_blockSize = blockSize;
-	m_alignment = alignment;
+	SetBlockLayout(blockSize, alignment);
 	m_blocksPerChunk = blocksPerChunk;
 
 	m_freeBlocks = nullptr;
 	m_chunkList = nullptr;
+	m_numChunks = 0;
 
+	RegisterThreadCaches();
 	AllocateChunk();  
 
 	return true;
@@ -25,17 +90,28 @@ bool BlockAllocator::Initialize(InternalAllocator* base, size_t blockSize, size_
 bool BlockAllocator::Initialize(void* buffer, size_t bufferSize, size_t blockSize, size_t alignment)
 {
 	// infer class members based on parameters
-	m_blocksPerChunk = bufferSize/ blockSize;
+	SetBlockLayout(blockSize, alignment);
+
+	//Skip ahead to the first aligned address, whatever is left over at the front can't hold an aligned block
+	byte* alignedBuffer = (byte*)AlignUp((uintptr_t)buffer, m_alignment);
+	size_t alignmentPadding = (size_t)(alignedBuffer - (byte*)buffer);
+	size_t usableSize = (bufferSize > alignmentPadding) ? bufferSize - alignmentPadding : 0;
+
+	m_blocksPerChunk = usableSize / m_blockSize;
 	m_bufferSize = bufferSize;
-	m_blockSize = blockSize;
-	m_alignment = alignment;
 
 	m_base = nullptr;
 	m_freeBlocks = nullptr;
 
+	RegisterThreadCaches();
+
 	// allocating blocks from a chunk
 	// may move this to a different method later; 
-	BreakUpChunk(buffer);
+	if (m_blocksPerChunk > 0)
+	{
+		BreakUpChunk(alignedBuffer);
+	}
+	m_numChunks = 1;
 
 	if (m_freeBlocks != nullptr)
 	{
@@ -50,6 +126,9 @@ bool BlockAllocator::Initialize(void* buffer, size_t bufferSize, size_t blockSiz
 //------------------------------------------------------------------------------------------------------------------------------
 void BlockAllocator::Deinitialize()
 {
+	//Magazines still holding our blocks become stale and get dropped the next time their thread looks at them
+	UnregisterThreadCaches();
+
 	//If m_base is not nullptr, we have chunks
 	if (m_base) 
 	{
@@ -73,6 +152,7 @@ void BlockAllocator::Deinitialize()
 	m_freeBlocks = nullptr;
 	m_blockSize = 0U;
 	m_blocksPerChunk = 0U;
+	m_numChunks = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -97,18 +177,34 @@ void BlockAllocator::Free(void* ptr)
 //------------------------------------------------------------------------------------------------------------------------------
 void* BlockAllocator::AllocateBlock()
 {
-	Block_T* block = PopFreeBlock();
-	
-	while (block == nullptr) 
+	BlockMagazine_T* magazine = GetThreadMagazine();
+	if (magazine == nullptr)
 	{
-		if (!AllocateChunk()) 
+		//No magazine slot for this allocator, go to the shared list every time
+		Block_T* block = PopFreeBlock();
+
+		while (block == nullptr)
 		{
-			return nullptr;
+			if (!AllocateChunk())
+			{
+				return nullptr;
+			}
+
+			block = PopFreeBlock();
 		}
 
-		block = PopFreeBlock();
+		return block;
 	}
 
+	if (magazine->numFreeBlocks == 0 && !RefillMagazine(magazine))
+	{
+		return nullptr;
+	}
+
+	Block_T* block = magazine->freeBlocks;
+	magazine->freeBlocks = block->next;
+	magazine->numFreeBlocks--;
+
 	return block;
 }
 
@@ -116,7 +212,22 @@ void* BlockAllocator::AllocateBlock()
 void BlockAllocator::FreeBlock(void* ptr)
 {
 	Block_T* block = (Block_T*)ptr;
-	PushFreeBlock(block);
+
+	BlockMagazine_T* magazine = GetThreadMagazine();
+	if (magazine == nullptr)
+	{
+		PushFreeBlock(block);
+		return;
+	}
+
+	block->next = magazine->freeBlocks;
+	magazine->freeBlocks = block;
+	magazine->numFreeBlocks++;
+
+	if (magazine->numFreeBlocks >= BLOCK_ALLOCATOR_MAGAZINE_CAPACITY)
+	{
+		ReturnMagazineBatch(magazine);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -160,29 +271,51 @@ bool BlockAllocator::AllocateChunk()
 		return false;
 	}
 
-	if (m_chunkLock.try_lock()) 
-	{
-		//Allocate a chunk of memory if the base allocator is able to 
-		size_t chunkSize = m_blocksPerChunk * m_blockSize + sizeof(Block_T);
+	//Wait our turn rather than bailing, a thread that loses the race must still come back with blocks to use
+	std::scoped_lock chunkLock(m_chunkLock);
 
-		Chunck_T* chunk = (Chunck_T*)m_base->Allocate(chunkSize);
-		if (chunk == nullptr) 
+	{
+		//Another thread may have added a chunk while we were waiting for the lock
+		std::scoped_lock blockLock(m_blockLock);
+		if (m_freeBlocks != nullptr)
 		{
-			return false;
+			return true;
 		}
+	}
 
-		//Track this chunk so we can free this later
-		chunk->next = m_chunkList;
-		m_chunkList = chunk;
+	//Allocate a chunk of memory if the base allocator is able to. The chunk header is followed by enough padding to get the
+	//first block aligned however aligned the base allocator's memory happens to be
+	size_t chunkSize = sizeof(Chunck_T) + (m_alignment - 1) + m_blocksPerChunk * m_blockSize;
 
-		//Break up newly allocated chunk
-		BreakUpChunk(chunk + 1);
-		m_chunkLock.unlock();
+	Chunck_T* chunk = (Chunck_T*)m_base->Allocate(chunkSize);
+	if (chunk == nullptr) 
+	{
+		return false;
 	}
 
+	//Track this chunk so we can free this later
+	chunk->next = m_chunkList;
+	m_chunkList = chunk;
+	m_numChunks++;
+
+	//Break up newly allocated chunk
+	BreakUpChunk((void*)AlignUp((uintptr_t)(chunk + 1), m_alignment));
+
 	return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void BlockAllocator::SetBlockLayout(size_t blockSize, size_t alignment)
+{
+	ASSERT_OR_DIE((alignment & (alignment - 1)) == 0, "BlockAllocator alignment has to be a power of 2");
+
+	//Free blocks hold the free list link so they must be at least big enough and aligned enough for one
+	m_alignment = (alignment > alignof(Block_T)) ? alignment : alignof(Block_T);
+
+	size_t linkedBlockSize = (blockSize > sizeof(Block_T)) ? blockSize : sizeof(Block_T);
+	m_blockSize = (size_t)AlignUp(linkedBlockSize, m_alignment);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void BlockAllocator::BreakUpChunk(void* buffer)
 {
@@ -231,3 +364,329 @@ Block_T* BlockAllocator::PopFreeBlock()
 	return head;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void BlockAllocator::PushFreeBlockList(Block_T* head, Block_T* tail)
+{
+	std::scoped_lock blockLock(m_blockLock);
+
+	tail->next = m_freeBlocks;
+	m_freeBlocks = head;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint BlockAllocator::PopFreeBlockList(Block_T** outHead, uint maxCount)
+{
+	std::scoped_lock blockLock(m_blockLock);
+
+	Block_T* head = m_freeBlocks;
+	Block_T* tail = nullptr;
+	uint count = 0;
+
+	while (m_freeBlocks != nullptr && count < maxCount)
+	{
+		tail = m_freeBlocks;
+		m_freeBlocks = m_freeBlocks->next;
+		count++;
+	}
+
+	if (tail != nullptr)
+	{
+		tail->next = nullptr;
+	}
+
+	*outHead = (count > 0) ? head : nullptr;
+	return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BlockAllocator::RegisterThreadCaches()
+{
+	m_allocatorId = gNextBlockAllocatorId.fetch_add(1);
+
+	//Re-initializing keeps our slot, the new id is enough to invalidate the old magazines
+	if (m_cacheSlot >= 0)
+	{
+		gBlockCacheSlotOwners[m_cacheSlot].store(m_allocatorId, std::memory_order_release);
+		return;
+	}
+
+	for (uint slotIndex = 0; slotIndex < BLOCK_ALLOCATOR_MAX_THREAD_CACHES; ++slotIndex)
+	{
+		uint64_t freeSlot = 0;
+		if (gBlockCacheSlotOwners[slotIndex].compare_exchange_strong(freeSlot, m_allocatorId, std::memory_order_acq_rel))
+		{
+			m_cacheSlot = (int)slotIndex;
+			return;
+		}
+	}
+
+	//Out of slots, this allocator will only use the shared list. DebuggerPrintf doesn't allocate so this is fine under operator new
+	m_cacheSlot = -1;
+	DebuggerPrintf("\n BlockAllocator (%zu byte blocks) didn't get one of the %u thread cache slots, every call will lock. Raise BLOCK_ALLOCATOR_MAX_THREAD_CACHES",
+		m_blockSize, BLOCK_ALLOCATOR_MAX_THREAD_CACHES);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BlockAllocator::UnregisterThreadCaches()
+{
+	if (m_cacheSlot >= 0)
+	{
+		gBlockCacheSlotOwners[m_cacheSlot].store(0, std::memory_order_release);
+	}
+
+	m_cacheSlot = -1;
+	m_allocatorId = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+BlockMagazine_T* BlockAllocator::GetThreadMagazine()
+{
+	if (m_cacheSlot < 0)
+	{
+		return nullptr;
+	}
+
+	BlockMagazine_T* magazine = &tBlockMagazines.magazines[m_cacheSlot];
+	if (magazine->allocatorId != m_allocatorId)
+	{
+		//Anything in here belonged to an allocator that has since been deinitialized so just forget it
+		magazine->allocatorId = m_allocatorId;
+		magazine->allocator = this;
+		magazine->freeBlocks = nullptr;
+		magazine->numFreeBlocks = 0;
+	}
+
+	return magazine;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool BlockAllocator::RefillMagazine(BlockMagazine_T* magazine)
+{
+	Block_T* head = nullptr;
+	uint count = PopFreeBlockList(&head, BLOCK_ALLOCATOR_MAGAZINE_BATCH);
+
+	while (count == 0)
+	{
+		if (!AllocateChunk())
+		{
+			return false;
+		}
+
+		count = PopFreeBlockList(&head, BLOCK_ALLOCATOR_MAGAZINE_BATCH);
+	}
+
+	magazine->freeBlocks = head;
+	magazine->numFreeBlocks = count;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void BlockAllocator::ReturnMagazineBatch(BlockMagazine_T* magazine)
+{
+	//Split a batch off the front of the magazine and give it back in one go
+	Block_T* head = magazine->freeBlocks;
+	Block_T* tail = head;
+	for (uint blockIndex = 1; blockIndex < BLOCK_ALLOCATOR_MAGAZINE_BATCH; ++blockIndex)
+	{
+		tail = tail->next;
+	}
+
+	magazine->freeBlocks = tail->next;
+	magazine->numFreeBlocks -= BLOCK_ALLOCATOR_MAGAZINE_BATCH;
+
+	PushFreeBlockList(head, tail);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define BLOCKTEST_BLOCK_SIZE 64
+#define BLOCKTEST_LIVE_BLOCKS 96
+#define BLOCKTEST_ROUNDS 20'000
+#define BLOCKTEST_MAX_THREADS 8
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Each thread keeps a window of live blocks, stamps them with its index and checks nobody else was handed the same memory
+static void BlockAllocatorTestThread(BlockAllocator* allocator, uint threadIndex, uint rounds, std::atomic<bool>* failed)
+{
+	void* liveBlocks[BLOCKTEST_LIVE_BLOCKS];
+
+	for (uint roundIndex = 0; roundIndex < rounds; ++roundIndex)
+	{
+		for (uint blockIndex = 0; blockIndex < BLOCKTEST_LIVE_BLOCKS; ++blockIndex)
+		{
+			uint* block = (uint*)allocator->Allocate(BLOCKTEST_BLOCK_SIZE);
+			if (block == nullptr)
+			{
+				failed->store(true);
+				return;
+			}
+
+			block[1] = threadIndex;
+			block[2] = blockIndex;
+			liveBlocks[blockIndex] = block;
+		}
+
+		for (uint blockIndex = 0; blockIndex < BLOCKTEST_LIVE_BLOCKS; ++blockIndex)
+		{
+			uint* block = (uint*)liveBlocks[blockIndex];
+			if (block[1] != threadIndex || block[2] != blockIndex)
+			{
+				failed->store(true);
+			}
+
+			allocator->Free(block);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void MallocTestThread(uint threadIndex, uint rounds)
+{
+	void* liveBlocks[BLOCKTEST_LIVE_BLOCKS];
+
+	for (uint roundIndex = 0; roundIndex < rounds; ++roundIndex)
+	{
+		for (uint blockIndex = 0; blockIndex < BLOCKTEST_LIVE_BLOCKS; ++blockIndex)
+		{
+			uint* block = (uint*)malloc(BLOCKTEST_BLOCK_SIZE);
+			block[1] = threadIndex;
+			liveBlocks[blockIndex] = block;
+		}
+
+		for (uint blockIndex = 0; blockIndex < BLOCKTEST_LIVE_BLOCKS; ++blockIndex)
+		{
+			free(liveBlocks[blockIndex]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Blocks allocated on one thread and freed on another must make it back into circulation through the magazines
+UNITTEST("BlockAllocatorThreadCaches", "Allocators", 100)
+{
+	BlockAllocator allocator;
+	allocator.Initialize(UntrackedAllocator::GetInstance(), BLOCKTEST_BLOCK_SIZE, alignof(void*), 128);
+	CONFIRM(allocator.HasThreadCaches());
+
+	//Two full sets of size classes on top of everything the engine already has alive still get magazines
+	{
+		BlockAllocator sizeClassSets[SIZE_CLASS_COUNT * 2];
+		for (BlockAllocator& sizeClass : sizeClassSets)
+		{
+			sizeClass.Initialize(UntrackedAllocator::GetInstance(), BLOCKTEST_BLOCK_SIZE, alignof(void*), 1);
+			CONFIRM(sizeClass.HasThreadCaches());
+		}
+	}
+
+	std::atomic<bool> failed = false;
+	std::vector<std::thread> threads;
+	for (uint threadIndex = 0; threadIndex < 4; ++threadIndex)
+	{
+		threads.emplace_back(BlockAllocatorTestThread, &allocator, threadIndex, 200, &failed);
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	CONFIRM(!failed.load());
+
+	//Producer allocates, consumer frees
+	std::vector<void*> handOff;
+	for (uint blockIndex = 0; blockIndex < 1000; ++blockIndex)
+	{
+		handOff.push_back(allocator.Allocate(BLOCKTEST_BLOCK_SIZE));
+		CONFIRM(handOff.back() != nullptr);
+	}
+
+	std::thread consumer([&]()
+	{
+		for (void* block : handOff)
+		{
+			allocator.Free(block);
+		}
+	});
+	consumer.join();
+
+	//Oversized requests still fail
+	CONFIRM(allocator.Allocate(BLOCKTEST_BLOCK_SIZE + 1) == nullptr);
+
+	allocator.Deinitialize();
+
+	//Blocks honor the alignment they were asked for, both when growing from a base and from a fixed buffer
+	for (size_t alignment = 8; alignment <= 256; alignment *= 2)
+	{
+		BlockAllocator alignedAllocator;
+		alignedAllocator.Initialize(UntrackedAllocator::GetInstance(), 24, alignment, 16);
+
+		std::vector<void*> alignedBlocks;
+		for (uint blockIndex = 0; blockIndex < 100; ++blockIndex)
+		{
+			alignedBlocks.push_back(alignedAllocator.Allocate(24));
+			CONFIRM(((uintptr_t)alignedBlocks.back() & (alignment - 1)) == 0);
+		}
+
+		for (void* block : alignedBlocks)
+		{
+			alignedAllocator.Free(block);
+		}
+		alignedAllocator.Deinitialize();
+	}
+
+	alignas(64) byte fixedBuffer[1024];
+	BlockAllocator fixedAllocator;
+	CONFIRM(fixedAllocator.Initialize(fixedBuffer + 8, sizeof(fixedBuffer) - 8, 48, 64));
+
+	void* fixedBlock = fixedAllocator.Allocate(48);
+	CONFIRM(fixedBlock != nullptr && ((uintptr_t)fixedBlock & 63) == 0);
+	CONFIRM((byte*)fixedBlock + 64 <= fixedBuffer + sizeof(fixedBuffer));
+	fixedAllocator.Free(fixedBlock);
+	fixedAllocator.Deinitialize();
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Alloc/free throughput of the block allocator against malloc as more threads hammer it
+UNITTEST("BlockAllocatorContention", "Allocators", 200)
+{
+	for (uint threadCount = 1; threadCount <= BLOCKTEST_MAX_THREADS; threadCount *= 2)
+	{
+		BlockAllocator allocator;
+		allocator.Initialize(UntrackedAllocator::GetInstance(), BLOCKTEST_BLOCK_SIZE, alignof(void*), 1024);
+
+		std::atomic<bool> failed = false;
+		std::vector<std::thread> threads;
+
+		double startTime = GetCurrentTimeSeconds();
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			threads.emplace_back(BlockAllocatorTestThread, &allocator, threadIndex, BLOCKTEST_ROUNDS, &failed);
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		double blockTime = GetCurrentTimeSeconds() - startTime;
+		threads.clear();
+
+		allocator.Deinitialize();
+		CONFIRM(!failed.load());
+
+		startTime = GetCurrentTimeSeconds();
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			threads.emplace_back(MallocTestThread, threadIndex, BLOCKTEST_ROUNDS);
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		double mallocTime = GetCurrentTimeSeconds() - startTime;
+
+		double numPairs = (double)threadCount * BLOCKTEST_ROUNDS * BLOCKTEST_LIVE_BLOCKS;
+		DebuggerPrintf("\n %u threads: BlockAllocator %.1f ns per alloc/free, malloc %.1f ns per alloc/free", threadCount, (blockTime * 1'000'000'000.0) / numPairs, (mallocTime * 1'000'000'000.0) / numPairs);
+	}
+
+	return true;
+}
\ No newline at end of file
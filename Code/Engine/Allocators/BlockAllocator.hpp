@@ -1,10 +1,19 @@
 #pragma once
 //------------------------------------------------------------------------------------------------------------------------------
 #include "Engine/Allocators/InternalAllocator.hpp"
+#include <atomic>
 #include <mutex>
+#include <stdint.h>
 
 typedef unsigned int uint;
 
+//------------------------------------------------------------------------------------------------------------------------------
+//Allocators that can hand out per-thread magazines at the same time. The engine keeps 13 alive (11 size classes for the pooled
+//global new, the job pool and gBlockAllocator), every other SizeClassAllocator takes 11 more and the rest is headroom
+constexpr uint BLOCK_ALLOCATOR_MAX_THREAD_CACHES = 64;
+constexpr uint BLOCK_ALLOCATOR_MAGAZINE_BATCH = 32;			// Blocks moved between a magazine and the shared free list at once
+constexpr uint BLOCK_ALLOCATOR_MAGAZINE_CAPACITY = BLOCK_ALLOCATOR_MAGAZINE_BATCH * 2;
+
 //------------------------------------------------------------------------------------------------------------------------------
 struct Block_T
 {
@@ -17,18 +26,42 @@ struct Chunck_T
 	Chunck_T* next;
 };
 
-// Single-Threaded Block Allocator
+class BlockAllocator;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Per-thread stash of free blocks for one allocator. Only ever touched by the thread that owns it
+struct BlockMagazine_T
+{
+	uint64_t			allocatorId = 0;
+	BlockAllocator*		allocator = nullptr;
+	Block_T*			freeBlocks = nullptr;
+	uint				numFreeBlocks = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Thread-Safe Block Allocator
+// Every thread keeps a magazine of free blocks per allocator so Allocate and Free don't touch a lock in the common case.
+// Magazines refill from and return to the shared free list BLOCK_ALLOCATOR_MAGAZINE_BATCH blocks at a time under a single
+// lock. A thread's magazine is handed back to the shared list when the thread exits. Only the first
+// BLOCK_ALLOCATOR_MAX_THREAD_CACHES live allocators get magazines, any others warn and fall back to the shared list on
+// every call.
+// With a fixed buffer each thread may hold up to BLOCK_ALLOCATOR_MAGAZINE_CAPACITY blocks other threads can't use.
+//------------------------------------------------------------------------------------------------------------------------------
 class BlockAllocator : public InternalAllocator
 {
 public:
+	~BlockAllocator();
+
 	//This Initialization takes a base allocator to sub allocate from
 	//The allocation can grow as long as the base allocator can allocate
+	//Every block starts on a multiple of alignment (a power of 2), blockSize is rounded up to keep the blocks after it aligned
 	bool						Initialize(InternalAllocator* base,
 								size_t blockSize,
 								size_t alignment,
 								uint blocksPerChunk);
 
 	//Takes a static buffer of fixed size. This allocation is not allowed to grow
+	//The first block starts at the first aligned address in the buffer
 	bool						Initialize(void* buffer,
 								size_t bufferSize,
 								size_t blockSize,
@@ -40,6 +73,10 @@ public:
 	virtual void*				Allocate(size_t size) final; // works as long as size <= block_size
 	virtual void				Free(void* ptr) final;
 
+	size_t						GetBlockSize() const		{ return m_blockSize; }
+	size_t						GetNumReservedBlocks() const	{ return m_numChunks.load(std::memory_order_relaxed) * m_blocksPerChunk; }
+	bool						HasThreadCaches() const		{ return m_cacheSlot >= 0; }
+
 	//------------------------------------------------------------------------------------------------------------------------------
 	//Static methods
 	static	BlockAllocator*		CreateInstance();
@@ -57,9 +94,25 @@ private:
 	bool						AllocateChunk();
 	void						BreakUpChunk(void* buffer);
 
+	//Clamps the alignment to what a free list link needs and rounds the block size up to it
+	void						SetBlockLayout(size_t blockSize, size_t alignment);
+
 	void						PushFreeBlock(Block_T* block);
 	Block_T*					PopFreeBlock();
 
+	//Batched versions for moving blocks between a magazine and the shared list
+	void						PushFreeBlockList(Block_T* head, Block_T* tail);
+	uint						PopFreeBlockList(Block_T** outHead, uint maxCount);
+
+	//Per-thread magazines
+	void						RegisterThreadCaches();
+	void						UnregisterThreadCaches();
+	BlockMagazine_T*			GetThreadMagazine();
+	bool						RefillMagazine(BlockMagazine_T* magazine);
+	void						ReturnMagazineBatch(BlockMagazine_T* magazine);
+
+	friend struct ThreadBlockMagazines_T;
+
 private: 
 
 	//Sub allocator to use for allocation
@@ -73,6 +126,11 @@ private:
 	size_t						m_blocksPerChunk;
 
 	size_t						m_bufferSize;
+	std::atomic<size_t>			m_numChunks = 0;
+
+	//Unique for every Initialize so magazines left over from a previous life of this allocator are never reused
+	uint64_t					m_allocatorId = 0;
+	int							m_cacheSlot = -1;
 
 	// AsyncBlockAllocator
 	std::mutex					m_chunkLock;
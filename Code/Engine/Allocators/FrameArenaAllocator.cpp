@@ -0,0 +1,248 @@
+#include "Engine/Allocators/FrameArenaAllocator.hpp"
+#include "Engine/Allocators/StackAllocator.hpp"
+#include "Engine/Allocators/UntrackedAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <stdlib.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static FrameArenaAllocator* gFrameArenaAllocator = nullptr;
+
+//------------------------------------------------------------------------------------------------------------------------------
+FrameArenaAllocator::~FrameArenaAllocator()
+{
+	Deinitialize();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool FrameArenaAllocator::Initialize(InternalAllocator* base, size_t bytesPerFrame)
+{
+	if (base == nullptr)
+	{
+		return false;
+	}
+
+	//Both frames come out of one allocation, padded so we can line the start up ourselves
+	bytesPerFrame = (bytesPerFrame + FRAME_ARENA_ALIGNMENT - 1) & ~(FRAME_ARENA_ALIGNMENT - 1);
+	uint8_t* memory = (uint8_t*)base->Allocate(bytesPerFrame * 2 + FRAME_ARENA_ALIGNMENT);
+	if (memory == nullptr)
+	{
+		return false;
+	}
+
+	m_base = base;
+	m_memory = memory;
+	m_bytesPerFrame = bytesPerFrame;
+
+	uintptr_t alignedStart = ((uintptr_t)memory + FRAME_ARENA_ALIGNMENT - 1) & ~(uintptr_t)(FRAME_ARENA_ALIGNMENT - 1);
+	m_buffers[0] = (uint8_t*)alignedStart;
+	m_buffers[1] = m_buffers[0] + bytesPerFrame;
+
+	m_currentBuffer = 0;
+	m_offset = 0;
+	m_peakBytesUsed = 0;
+	m_numFailedAllocations = 0;
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameArenaAllocator::Deinitialize()
+{
+	if (m_base == nullptr)
+	{
+		return;
+	}
+
+	m_base->Free(m_memory);
+
+	m_base = nullptr;
+	m_memory = nullptr;
+	m_buffers[0] = nullptr;
+	m_buffers[1] = nullptr;
+	m_bytesPerFrame = 0;
+	m_offset = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameArenaAllocator::BeginFrame()
+{
+	size_t bytesUsed = GetBytesUsedThisFrame();
+	m_peakBytesUsed = (bytesUsed > m_peakBytesUsed) ? bytesUsed : m_peakBytesUsed;
+
+	//The other buffer was last written two frames ago so nobody should be holding on to it anymore
+	m_currentBuffer ^= 1;
+	m_offset.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* FrameArenaAllocator::Allocate(size_t size)
+{
+	//Keeping every size a multiple of the alignment keeps every offset aligned without a CAS loop
+	size_t alignedSize = (size + FRAME_ARENA_ALIGNMENT - 1) & ~(FRAME_ARENA_ALIGNMENT - 1);
+	size_t offset = m_offset.fetch_add(alignedSize, std::memory_order_relaxed);
+
+	if (offset + alignedSize > m_bytesPerFrame)
+	{
+		m_numFailedAllocations.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	return m_buffers[m_currentBuffer] + offset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void FrameArenaAllocator::Free(void* ptr)
+{
+	UNUSED(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t FrameArenaAllocator::GetBytesUsedThisFrame() const
+{
+	//Failed allocations still bump the offset past the end
+	size_t offset = m_offset.load(std::memory_order_relaxed);
+	return (offset < m_bytesPerFrame) ? offset : m_bytesPerFrame;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC FrameArenaAllocator* FrameArenaAllocator::CreateInstance()
+{
+	if (gFrameArenaAllocator == nullptr)
+	{
+		gFrameArenaAllocator = new FrameArenaAllocator();
+		gFrameArenaAllocator->Initialize(UntrackedAllocator::GetInstance(), FRAME_ARENA_DEFAULT_BYTES_PER_FRAME);
+	}
+
+	return gFrameArenaAllocator;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void FrameArenaAllocator::DestroyInstance()
+{
+	if (gFrameArenaAllocator != nullptr)
+	{
+		delete gFrameArenaAllocator;
+		gFrameArenaAllocator = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC FrameArenaAllocator* FrameArenaAllocator::GetInstance()
+{
+	if (gFrameArenaAllocator == nullptr)
+	{
+		CreateInstance();
+	}
+
+	return gFrameArenaAllocator;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define FRAMETEST_FRAMES 500
+#define FRAMETEST_ALLOCS_PER_FRAME 2'000
+#define FRAMETEST_SYSTEM_ALLOCS 100
+
+//Rough mix of what a frame asks for: small strings, split results, a few vertex arrays
+static const size_t FRAMETEST_SIZES[] = { 24, 32, 48, 64, 96, 128, 256, 512, 1024, 4096 };
+static const uint FRAMETEST_NUM_SIZES = sizeof(FRAMETEST_SIZES) / sizeof(FRAMETEST_SIZES[0]);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Data from the last frame survives one BeginFrame and the buffer is handed out again after the second
+UNITTEST("FrameArenaDoubleBuffer", "Allocators", 100)
+{
+	FrameArenaAllocator arena;
+	CONFIRM(arena.Initialize(UntrackedAllocator::GetInstance(), 1024));
+
+	int* frameData = arena.Create<int>(42);
+	CONFIRM(frameData != nullptr && ((uintptr_t)frameData % FRAME_ARENA_ALIGNMENT) == 0);
+	CONFIRM(arena.GetBytesUsedThisFrame() == FRAME_ARENA_ALIGNMENT);
+
+	arena.BeginFrame();
+	int* nextFrameData = arena.Create<int>(7);
+	CONFIRM(*frameData == 42 && nextFrameData != frameData);
+
+	arena.BeginFrame();
+	CONFIRM(arena.GetBytesUsedThisFrame() == 0);
+	CONFIRM(arena.Allocate(sizeof(int)) == frameData);
+
+	//Running out fails the allocation instead of stomping the other frame
+	CONFIRM(arena.Allocate(2048) == nullptr);
+	CONFIRM(arena.GetNumFailedAllocations() == 1);
+	CONFIRM(*nextFrameData == 7);
+
+	arena.Deinitialize();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Typical per-frame scratch allocation pattern against malloc
+UNITTEST("FrameAllocatorsVsMalloc", "Allocators", 200)
+{
+	std::vector<void*> allocations(FRAMETEST_ALLOCS_PER_FRAME);
+
+	double startTime = GetCurrentTimeSeconds();
+	for (uint frameIndex = 0; frameIndex < FRAMETEST_FRAMES; ++frameIndex)
+	{
+		for (uint allocIndex = 0; allocIndex < FRAMETEST_ALLOCS_PER_FRAME; ++allocIndex)
+		{
+			uint8_t* memory = (uint8_t*)malloc(FRAMETEST_SIZES[allocIndex % FRAMETEST_NUM_SIZES]);
+			memory[0] = (uint8_t)allocIndex;
+			allocations[allocIndex] = memory;
+		}
+
+		for (uint allocIndex = 0; allocIndex < FRAMETEST_ALLOCS_PER_FRAME; ++allocIndex)
+		{
+			free(allocations[allocIndex]);
+		}
+	}
+	double mallocTime = GetCurrentTimeSeconds() - startTime;
+
+	FrameArenaAllocator arena;
+	arena.Initialize(UntrackedAllocator::GetInstance(), 4 * 1024 * 1024);
+
+	startTime = GetCurrentTimeSeconds();
+	for (uint frameIndex = 0; frameIndex < FRAMETEST_FRAMES; ++frameIndex)
+	{
+		arena.BeginFrame();
+		for (uint allocIndex = 0; allocIndex < FRAMETEST_ALLOCS_PER_FRAME; ++allocIndex)
+		{
+			uint8_t* memory = (uint8_t*)arena.Allocate(FRAMETEST_SIZES[allocIndex % FRAMETEST_NUM_SIZES]);
+			memory[0] = (uint8_t)allocIndex;
+			allocations[allocIndex] = memory;
+		}
+	}
+	double arenaTime = GetCurrentTimeSeconds() - startTime;
+	CONFIRM(arena.GetNumFailedAllocations() == 0);
+	arena.Deinitialize();
+
+	//Same pattern but every system rolls its scratch back when it is done
+	StackAllocator stack;
+	stack.Initialize(UntrackedAllocator::GetInstance(), 1024 * 1024);
+
+	startTime = GetCurrentTimeSeconds();
+	for (uint frameIndex = 0; frameIndex < FRAMETEST_FRAMES; ++frameIndex)
+	{
+		for (uint allocIndex = 0; allocIndex < FRAMETEST_ALLOCS_PER_FRAME; allocIndex += FRAMETEST_SYSTEM_ALLOCS)
+		{
+			ScopedStackMarker marker(stack);
+			for (uint systemIndex = 0; systemIndex < FRAMETEST_SYSTEM_ALLOCS; ++systemIndex)
+			{
+				uint8_t* memory = (uint8_t*)stack.Allocate(FRAMETEST_SIZES[(allocIndex + systemIndex) % FRAMETEST_NUM_SIZES]);
+				memory[0] = (uint8_t)systemIndex;
+				allocations[allocIndex + systemIndex] = memory;
+			}
+		}
+	}
+	double stackTime = GetCurrentTimeSeconds() - startTime;
+	stack.Deinitialize();
+
+	double numAllocations = (double)FRAMETEST_FRAMES * FRAMETEST_ALLOCS_PER_FRAME;
+	DebuggerPrintf("\n Per frame allocation: malloc %.1f ns, frame arena %.1f ns, stack allocator %.1f ns per allocation", (mallocTime * 1'000'000'000.0) / numAllocations, (arenaTime * 1'000'000'000.0) / numAllocations, (stackTime * 1'000'000'000.0) / numAllocations);
+
+	return true;
+}
\ No newline at end of file
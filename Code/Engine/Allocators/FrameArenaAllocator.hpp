@@ -0,0 +1,57 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Allocators/InternalAllocator.hpp"
+#include <atomic>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr size_t FRAME_ARENA_ALIGNMENT = 16;
+constexpr size_t FRAME_ARENA_DEFAULT_BYTES_PER_FRAME = 4 * 1024 * 1024;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Double buffered bump pointer allocator for per-frame scratch memory.
+// Allocate just bumps an atomic offset so any thread can use it, and Free does nothing. BeginFrame flips to the other buffer
+// and resets it in O(1), so anything allocated during a frame stays valid until the end of the next frame and is then
+// reused without destructors being called. Only put trivially destructible data here or Destroy it yourself.
+// BeginFrame must not race with allocations, call it from the main thread at the frame boundary. RenderContext::BeginFrame
+// does that for the GetInstance arena.
+//------------------------------------------------------------------------------------------------------------------------------
+class FrameArenaAllocator : public InternalAllocator
+{
+public:
+	~FrameArenaAllocator();
+
+	bool							Initialize(InternalAllocator* base, size_t bytesPerFrame);
+	void							Deinitialize();
+
+	void							BeginFrame();
+
+	//Interface methods
+	virtual void*					Allocate(size_t size) final;	// returns nullptr once this frame's buffer is used up
+	virtual void					Free(void* ptr) final;			// no-op, memory comes back when the buffer is reused
+
+	size_t							GetBytesPerFrame() const		{ return m_bytesPerFrame; }
+	size_t							GetBytesUsedThisFrame() const;
+	size_t							GetPeakBytesUsed() const		{ return m_peakBytesUsed; }
+	uint							GetNumFailedAllocations() const	{ return m_numFailedAllocations.load(std::memory_order_relaxed); }
+
+	//------------------------------------------------------------------------------------------------------------------------------
+	//Static methods
+	static	FrameArenaAllocator*	CreateInstance();
+	static	void					DestroyInstance();
+	static	FrameArenaAllocator*	GetInstance();
+
+private:
+	InternalAllocator*				m_base = nullptr;
+	size_t							m_bytesPerFrame = 0;
+
+	uint8_t*						m_memory = nullptr;
+	uint8_t*						m_buffers[2] = { nullptr, nullptr };
+	uint							m_currentBuffer = 0;
+
+	std::atomic<size_t>				m_offset = 0;
+	size_t							m_peakBytesUsed = 0;
+	std::atomic<uint>				m_numFailedAllocations = 0;
+};
\ No newline at end of file
@@ -0,0 +1,546 @@
+#include "Engine/Allocators/SizeClassAllocator.hpp"
+#include "Engine/Allocators/TemplatedUntrackedAllocator.hpp"
+#include "Engine/Allocators/UntrackedAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <map>
+#include <new>
+#include <string>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static SizeClassAllocator* gSizeClassAllocator = nullptr;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SizeClassHeader_T
+{
+	size_t		requestedSize;
+	uint		sizeClass;
+};
+
+static_assert(sizeof(SizeClassHeader_T) <= SIZE_CLASS_HEADER_SIZE, "SizeClassHeader_T no longer fits in the allocation header");
+
+//------------------------------------------------------------------------------------------------------------------------------
+SizeClassAllocator::~SizeClassAllocator()
+{
+	Deinitialize();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SizeClassAllocator::Initialize(InternalAllocator* base, bool trackStats /*= true*/)
+{
+	if (base == nullptr)
+	{
+		return false;
+	}
+
+	m_base = base;
+	m_trackStats = trackStats;
+
+	for (uint sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+	{
+		size_t blockSize = SIZE_CLASS_BLOCK_SIZES[sizeClass];
+		uint blocksPerChunk = (uint)(SIZE_CLASS_CHUNK_BYTES / blockSize);
+
+		m_sizeClasses[sizeClass].Initialize(base, blockSize, SIZE_CLASS_ALIGNMENT, blocksPerChunk);
+	}
+
+	//Fill the lookup so every 16 byte step maps to the smallest class it fits in
+	uint sizeClass = 0;
+	for (uint lookupIndex = 0; lookupIndex < sizeof(m_sizeClassLookup); ++lookupIndex)
+	{
+		while (SIZE_CLASS_BLOCK_SIZES[sizeClass] < lookupIndex * 16)
+		{
+			sizeClass++;
+		}
+
+		m_sizeClassLookup[lookupIndex] = (uint8_t)sizeClass;
+	}
+
+	for (uint statsIndex = 0; statsIndex <= SIZE_CLASS_COUNT; ++statsIndex)
+	{
+		SizeClassCounters_T& counters = m_counters[statsIndex];
+		counters.m_numLiveAllocations = 0;
+		counters.m_peakLiveAllocations = 0;
+		counters.m_totalAllocations = 0;
+		counters.m_requestedBytes = 0;
+		counters.m_usedBytes = 0;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SizeClassAllocator::Deinitialize()
+{
+	if (m_base == nullptr)
+	{
+		return;
+	}
+
+	for (uint sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+	{
+		m_sizeClasses[sizeClass].Deinitialize();
+	}
+
+	m_base = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* SizeClassAllocator::Allocate(size_t size)
+{
+	size_t totalSize = size + SIZE_CLASS_HEADER_SIZE;
+	uint sizeClass = GetSizeClassForSize(totalSize);
+
+	SizeClassHeader_T* header = nullptr;
+	if (sizeClass == SIZE_CLASS_LARGE)
+	{
+		header = (SizeClassHeader_T*)m_base->Allocate(totalSize);
+		if (header == nullptr)
+		{
+			return nullptr;
+		}
+
+		RecordAllocation(SIZE_CLASS_COUNT, size, totalSize);
+	}
+	else
+	{
+		header = (SizeClassHeader_T*)m_sizeClasses[sizeClass].Allocate(totalSize);
+		if (header == nullptr)
+		{
+			return nullptr;
+		}
+
+		RecordAllocation(sizeClass, size, SIZE_CLASS_BLOCK_SIZES[sizeClass]);
+	}
+
+	header->requestedSize = size;
+	header->sizeClass = sizeClass;
+
+	return (uint8_t*)header + SIZE_CLASS_HEADER_SIZE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SizeClassAllocator::Free(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	SizeClassHeader_T* header = (SizeClassHeader_T*)((uint8_t*)ptr - SIZE_CLASS_HEADER_SIZE);
+	size_t requestedSize = header->requestedSize;
+	uint sizeClass = header->sizeClass;
+
+	if (sizeClass == SIZE_CLASS_LARGE)
+	{
+		RecordFree(SIZE_CLASS_COUNT, requestedSize, requestedSize + SIZE_CLASS_HEADER_SIZE);
+		m_base->Free(header);
+	}
+	else
+	{
+		ASSERT_OR_DIE(sizeClass < SIZE_CLASS_COUNT, "Freeing memory that did not come from a SizeClassAllocator");
+
+		RecordFree(sizeClass, requestedSize, SIZE_CLASS_BLOCK_SIZES[sizeClass]);
+		m_sizeClasses[sizeClass].Free(header);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SizeClassAllocator::GetSizeClassStats(uint sizeClass, SizeClassStats_T* out) const
+{
+	ASSERT_OR_DIE(sizeClass <= SIZE_CLASS_COUNT, "Invalid size class passed to GetSizeClassStats");
+
+	SizeClassCounters_T const& counters = m_counters[sizeClass];
+	out->m_numLiveAllocations = counters.m_numLiveAllocations.load(std::memory_order_relaxed);
+	out->m_peakLiveAllocations = counters.m_peakLiveAllocations.load(std::memory_order_relaxed);
+	out->m_totalAllocations = counters.m_totalAllocations.load(std::memory_order_relaxed);
+	out->m_requestedBytes = counters.m_requestedBytes.load(std::memory_order_relaxed);
+	out->m_usedBytes = counters.m_usedBytes.load(std::memory_order_relaxed);
+
+	if (sizeClass < SIZE_CLASS_COUNT)
+	{
+		out->m_blockSize = SIZE_CLASS_BLOCK_SIZES[sizeClass];
+		out->m_reservedBytes = m_sizeClasses[sizeClass].GetNumReservedBlocks() * SIZE_CLASS_BLOCK_SIZES[sizeClass];
+	}
+	else
+	{
+		//The base allocator hands out exactly what we ask for
+		out->m_blockSize = 0;
+		out->m_reservedBytes = out->m_usedBytes;
+	}
+
+	out->m_occupancy = (out->m_reservedBytes > 0) ? (float)((double)out->m_usedBytes / (double)out->m_reservedBytes) : 0.f;
+	out->m_internalFragmentation = (out->m_usedBytes > 0) ? (float)(1.0 - (double)out->m_requestedBytes / (double)out->m_usedBytes) : 0.f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SizeClassAllocator::ResetPeakStats()
+{
+	for (uint statsIndex = 0; statsIndex <= SIZE_CLASS_COUNT; ++statsIndex)
+	{
+		SizeClassCounters_T& counters = m_counters[statsIndex];
+		counters.m_peakLiveAllocations = counters.m_numLiveAllocations.load(std::memory_order_relaxed);
+		counters.m_totalAllocations = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC size_t SizeClassAllocator::GetAllocationSize(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return 0;
+	}
+
+	SizeClassHeader_T* header = (SizeClassHeader_T*)((uint8_t*)ptr - SIZE_CLASS_HEADER_SIZE);
+	return header->requestedSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC SizeClassAllocator* SizeClassAllocator::CreateInstance()
+{
+	if (gSizeClassAllocator == nullptr)
+	{
+		gSizeClassAllocator = new SizeClassAllocator();
+		gSizeClassAllocator->Initialize(UntrackedAllocator::GetInstance());
+	}
+
+	return gSizeClassAllocator;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void SizeClassAllocator::DestroyInstance()
+{
+	if (gSizeClassAllocator != nullptr)
+	{
+		delete gSizeClassAllocator;
+		gSizeClassAllocator = nullptr;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC SizeClassAllocator* SizeClassAllocator::GetInstance()
+{
+	if (gSizeClassAllocator == nullptr)
+	{
+		CreateInstance();
+	}
+
+	return gSizeClassAllocator;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The global new pools can't come from new, so they are built in place in static storage on first use
+//------------------------------------------------------------------------------------------------------------------------------
+static UntrackedAllocator gPooledNewBase;
+static std::atomic<SizeClassAllocator*> gPooledNewAllocator = nullptr;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static SizeClassAllocator* GetPooledNewAllocator()
+{
+	alignas(SizeClassAllocator) static uint8_t pooledAllocatorStorage[sizeof(SizeClassAllocator)];
+	static SizeClassAllocator* pooledAllocator = [&]()
+	{
+		SizeClassAllocator* allocator = new (pooledAllocatorStorage) SizeClassAllocator();
+		allocator->Initialize(&gPooledNewBase);
+		gPooledNewAllocator.store(allocator, std::memory_order_release);
+		return allocator;
+	}();
+
+	return pooledAllocator;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+SizeClassAllocator* FindPooledAllocator()
+{
+	return gPooledNewAllocator.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* PooledAlloc(size_t byteCount)
+{
+	return GetPooledNewAllocator()->Allocate(byteCount);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PooledFree(void* ptr)
+{
+	GetPooledNewAllocator()->Free(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint SizeClassAllocator::GetSizeClassForSize(size_t totalSize) const
+{
+	if (totalSize > SIZE_CLASS_BLOCK_SIZES[SIZE_CLASS_COUNT - 1])
+	{
+		return SIZE_CLASS_LARGE;
+	}
+
+	return m_sizeClassLookup[(totalSize + 15) / 16];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SizeClassAllocator::RecordAllocation(uint statsIndex, size_t requestedSize, size_t usedSize)
+{
+	if (!m_trackStats)
+	{
+		return;
+	}
+
+	SizeClassCounters_T& counters = m_counters[statsIndex];
+
+	uint64_t numLive = counters.m_numLiveAllocations.fetch_add(1, std::memory_order_relaxed) + 1;
+	counters.m_totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.m_requestedBytes.fetch_add(requestedSize, std::memory_order_relaxed);
+	counters.m_usedBytes.fetch_add(usedSize, std::memory_order_relaxed);
+
+	//Only pay for the CAS when we are actually setting a new peak
+	uint64_t peak = counters.m_peakLiveAllocations.load(std::memory_order_relaxed);
+	while (numLive > peak && !counters.m_peakLiveAllocations.compare_exchange_weak(peak, numLive, std::memory_order_relaxed))
+	{
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SizeClassAllocator::RecordFree(uint statsIndex, size_t requestedSize, size_t usedSize)
+{
+	if (!m_trackStats)
+	{
+		return;
+	}
+
+	SizeClassCounters_T& counters = m_counters[statsIndex];
+
+	counters.m_numLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	counters.m_requestedBytes.fetch_sub(requestedSize, std::memory_order_relaxed);
+	counters.m_usedBytes.fetch_sub(usedSize, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define SIZECLASSTEST_THREADS 4
+#define SIZECLASSTEST_ROUNDS 2'000
+#define SIZECLASSTEST_LIVE_ALLOCATIONS 64
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Mix of sizes across every class plus the large fallback, each allocation is filled and checked before it is freed
+static void SizeClassTestThread(SizeClassAllocator* allocator, uint threadIndex, std::atomic<bool>* failed)
+{
+	void* liveAllocations[SIZECLASSTEST_LIVE_ALLOCATIONS];
+	size_t liveSizes[SIZECLASSTEST_LIVE_ALLOCATIONS];
+
+	for (uint roundIndex = 0; roundIndex < SIZECLASSTEST_ROUNDS; ++roundIndex)
+	{
+		for (uint allocIndex = 0; allocIndex < SIZECLASSTEST_LIVE_ALLOCATIONS; ++allocIndex)
+		{
+			size_t size = 1 + ((roundIndex * 131 + allocIndex * 37 + threadIndex * 7) % 1400);
+			uint8_t* memory = (uint8_t*)allocator->Allocate(size);
+			if (memory == nullptr)
+			{
+				failed->store(true);
+				return;
+			}
+
+			memset(memory, (int)(threadIndex + allocIndex), size);
+			liveAllocations[allocIndex] = memory;
+			liveSizes[allocIndex] = size;
+		}
+
+		for (uint allocIndex = 0; allocIndex < SIZECLASSTEST_LIVE_ALLOCATIONS; ++allocIndex)
+		{
+			uint8_t* memory = (uint8_t*)liveAllocations[allocIndex];
+			uint8_t expected = (uint8_t)(threadIndex + allocIndex);
+			if (memory[0] != expected || memory[liveSizes[allocIndex] - 1] != expected)
+			{
+				failed->store(true);
+			}
+
+			allocator->Free(memory);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("SizeClassAllocator", "Allocators", 100)
+{
+	SizeClassAllocator allocator;
+	allocator.Initialize(UntrackedAllocator::GetInstance());
+
+	//Sizes land in the smallest class that fits them and their header
+	void* small = allocator.Allocate(16);
+	void* medium = allocator.Allocate(200);
+	void* large = allocator.Allocate(4096);
+	CONFIRM(small != nullptr && medium != nullptr && large != nullptr);
+
+	SizeClassStats_T stats;
+	allocator.GetSizeClassStats(0, &stats);
+	CONFIRM(stats.m_numLiveAllocations == 1 && stats.m_requestedBytes == 16 && stats.m_usedBytes == 32);
+	allocator.GetSizeClassStats(6, &stats);
+	CONFIRM(stats.m_blockSize == 256 && stats.m_numLiveAllocations == 1);
+	allocator.GetSizeClassStats(SIZE_CLASS_COUNT, &stats);
+	CONFIRM(stats.m_numLiveAllocations == 1 && stats.m_requestedBytes == 4096);
+
+	allocator.Free(small);
+	allocator.Free(medium);
+	allocator.Free(large);
+	allocator.Free(nullptr);
+
+	//Every size has to come back as aligned as the global operator new promises
+	std::vector<void*> alignedAllocations;
+	for (size_t size = 0; size <= 2048; size += 7)
+	{
+		alignedAllocations.push_back(allocator.Allocate(size));
+		CONFIRM(((uintptr_t)alignedAllocations.back() & (SIZE_CLASS_ALIGNMENT - 1)) == 0);
+	}
+
+	for (void* allocation : alignedAllocations)
+	{
+		allocator.Free(allocation);
+	}
+
+	std::atomic<bool> failed = false;
+	std::vector<std::thread> threads;
+	for (uint threadIndex = 0; threadIndex < SIZECLASSTEST_THREADS; ++threadIndex)
+	{
+		threads.emplace_back(SizeClassTestThread, &allocator, threadIndex, &failed);
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	CONFIRM(!failed.load());
+
+	//Everything went back where it came from
+	for (uint statsIndex = 0; statsIndex <= SIZE_CLASS_COUNT; ++statsIndex)
+	{
+		allocator.GetSizeClassStats(statsIndex, &stats);
+		CONFIRM(stats.m_numLiveAllocations == 0 && stats.m_usedBytes == 0);
+	}
+
+	allocator.Deinitialize();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+#define POOLEDTEST_ITERATIONS 2'000
+#define POOLEDTEST_ENTRIES 256
+#define POOLEDTEST_THREADS 4
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Same as what the global new does with ENGINE_USE_POOLED_NEW, in allocator form so the benchmark can run in any build
+template <typename T>
+struct PooledTestAllocator
+{
+	PooledTestAllocator() = default;
+
+	template <class U>
+	constexpr PooledTestAllocator(PooledTestAllocator<U> const&) noexcept {}
+
+	typedef T               value_type;
+	typedef std::true_type  is_always_equal;
+
+	T*		allocate(size_t count)				{ return (T*)PooledAlloc(count * sizeof(T)); }
+	void	deallocate(T* ptr, size_t count)	{ UNUSED(count); PooledFree(ptr); }
+};
+
+template<typename T, class U>
+bool operator==(PooledTestAllocator<T> const&, PooledTestAllocator<U> const&) { return true; }
+
+template<typename T, class U>
+bool operator!=(PooledTestAllocator<T> const&, PooledTestAllocator<U> const&) { return false; }
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Typical gameplay churn: names built up as strings, kept in a vector and looked up through a map, half thrown away
+template <template <typename> class ALLOCATOR>
+static void RunContainerWorkload(uint threadIndex, std::atomic<size_t>* checksum)
+{
+	typedef std::basic_string<char, std::char_traits<char>, ALLOCATOR<char>> TestString;
+	typedef std::vector<TestString, ALLOCATOR<TestString>> TestStringVector;
+	typedef std::map<int, TestString, std::less<int>, ALLOCATOR<std::pair<int const, TestString>>> TestStringMap;
+
+	size_t localChecksum = 0;
+	for (uint iteration = 0; iteration < POOLEDTEST_ITERATIONS; ++iteration)
+	{
+		TestStringVector names;
+		TestStringMap lookup;
+
+		for (int entryIndex = 0; entryIndex < POOLEDTEST_ENTRIES; ++entryIndex)
+		{
+			char suffix[32];
+			snprintf(suffix, sizeof(suffix), "_%u_%d", threadIndex, entryIndex);
+
+			TestString name("entity_with_a_name_past_small_string_size");
+			name += suffix;
+
+			names.push_back(name);
+			lookup[entryIndex] = name;
+		}
+
+		for (int entryIndex = 0; entryIndex < POOLEDTEST_ENTRIES; entryIndex += 2)
+		{
+			lookup.erase(entryIndex);
+		}
+
+		localChecksum += lookup.size() + names.back().size();
+	}
+
+	checksum->fetch_add(localChecksum);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <template <typename> class ALLOCATOR>
+static double TimeContainerWorkload(uint threadCount, size_t* outChecksum)
+{
+	std::atomic<size_t> checksum = 0;
+	std::vector<std::thread> threads;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+	{
+		threads.emplace_back(RunContainerWorkload<ALLOCATOR>, threadIndex, &checksum);
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	*outChecksum = checksum.load();
+	return GetCurrentTimeSeconds() - startTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Strings, vectors and maps on the pools that back ENGINE_USE_POOLED_NEW against the system allocator
+UNITTEST("PooledNewVsMalloc", "Allocators", 200)
+{
+	void* sizes[3] = { PooledAlloc(1), PooledAlloc(500), PooledAlloc(5000) };
+	CONFIRM(SizeClassAllocator::GetAllocationSize(sizes[1]) == 500 && SizeClassAllocator::GetAllocationSize(sizes[2]) == 5000);
+
+	//The pools the dev console reports on are the ones PooledAlloc used
+	SizeClassStats_T largeStats;
+	CONFIRM(FindPooledAllocator() != nullptr);
+	FindPooledAllocator()->GetSizeClassStats(SIZE_CLASS_COUNT, &largeStats);
+	CONFIRM(largeStats.m_numLiveAllocations >= 1 && largeStats.m_requestedBytes >= 5000);
+
+	for (void* ptr : sizes)
+	{
+		PooledFree(ptr);
+	}
+
+	for (uint threadCount = 1; threadCount <= POOLEDTEST_THREADS; threadCount *= 2)
+	{
+		size_t mallocChecksum = 0;
+		size_t pooledChecksum = 0;
+		double mallocTime = TimeContainerWorkload<TemplatedUntrackedAllocator>(threadCount, &mallocChecksum);
+		double pooledTime = TimeContainerWorkload<PooledTestAllocator>(threadCount, &pooledChecksum);
+		CONFIRM(mallocChecksum == pooledChecksum);
+
+		DebuggerPrintf("\n %u threads: system allocator %.2f ms, pooled %.2f ms for the container workload", threadCount, mallocTime * 1000.0, pooledTime * 1000.0);
+	}
+
+	return true;
+}
\ No newline at end of file
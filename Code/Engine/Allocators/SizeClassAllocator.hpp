@@ -0,0 +1,114 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Allocators/BlockAllocator.hpp"
+#include <atomic>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint SIZE_CLASS_COUNT = 11;
+constexpr size_t SIZE_CLASS_BLOCK_SIZES[SIZE_CLASS_COUNT] = { 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024 };
+constexpr size_t SIZE_CLASS_HEADER_SIZE = 16;		// Every allocation remembers which pool it came from
+constexpr size_t SIZE_CLASS_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;	// What the global operator new has to hand out
+constexpr size_t SIZE_CLASS_CHUNK_BYTES = 64 * 1024;	// Roughly how much each pool grows by at a time
+constexpr uint SIZE_CLASS_LARGE = 0xFFFFFFFF;			// Index used for allocations that went to the base allocator
+
+//Blocks start aligned, so the header and every block size must keep the payload after them aligned too
+constexpr bool AreSizeClassesAligned()
+{
+	for (uint sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+	{
+		if (SIZE_CLASS_BLOCK_SIZES[sizeClass] % SIZE_CLASS_ALIGNMENT != 0)
+		{
+			return false;
+		}
+	}
+
+	return (SIZE_CLASS_HEADER_SIZE % SIZE_CLASS_ALIGNMENT) == 0;
+}
+
+static_assert(AreSizeClassesAligned(), "Size class block sizes and the header must be multiples of SIZE_CLASS_ALIGNMENT");
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct SizeClassStats_T
+{
+	size_t		m_blockSize = 0;				// 0 for the large allocation fallback
+	uint64_t	m_numLiveAllocations = 0;
+	uint64_t	m_peakLiveAllocations = 0;
+	uint64_t	m_totalAllocations = 0;
+	uint64_t	m_requestedBytes = 0;			// What callers asked for on the live allocations
+	uint64_t	m_usedBytes = 0;				// What the live allocations actually take up including headers
+	uint64_t	m_reservedBytes = 0;			// Everything the pool has grabbed from the base allocator
+
+	float		m_occupancy = 0.f;				// usedBytes / reservedBytes
+	float		m_internalFragmentation = 0.f;	// Portion of usedBytes lost to headers and rounding up to the block size
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: General purpose small object allocator. Requests are rounded up to the closest of a fixed set of size classes and
+// served from a BlockAllocator per class, so they get the per-thread magazines for free. Anything that doesn't fit the
+// largest class goes straight to the base allocator. Each allocation carries a small header so Free knows where it goes.
+// Payloads are aligned to SIZE_CLASS_ALIGNMENT as long as the base allocator hands out memory aligned at least that much.
+// Payloads that fit the size classes can be up to SIZE_CLASS_BLOCK_SIZES[SIZE_CLASS_COUNT - 1] - SIZE_CLASS_HEADER_SIZE bytes.
+//------------------------------------------------------------------------------------------------------------------------------
+class SizeClassAllocator : public InternalAllocator
+{
+public:
+	~SizeClassAllocator();
+
+	//trackStats off skips the shared stat counters, for callers that keep their own
+	bool							Initialize(InternalAllocator* base, bool trackStats = true);
+	void							Deinitialize();
+
+	//Interface methods
+	virtual void*					Allocate(size_t size) final;
+	virtual void					Free(void* ptr) final;
+
+	//Stats for the size classes, pass SIZE_CLASS_COUNT for the large allocation fallback
+	void							GetSizeClassStats(uint sizeClass, SizeClassStats_T* out) const;
+	void							ResetPeakStats();
+
+	//------------------------------------------------------------------------------------------------------------------------------
+	//Static methods
+	static	size_t					GetAllocationSize(void* ptr);	// size that was asked for when ptr was allocated
+
+	static	SizeClassAllocator*		CreateInstance();
+	static	void					DestroyInstance();
+	static	SizeClassAllocator*		GetInstance();
+
+private:
+	uint							GetSizeClassForSize(size_t totalSize) const;
+
+	void							RecordAllocation(uint statsIndex, size_t requestedSize, size_t usedSize);
+	void							RecordFree(uint statsIndex, size_t requestedSize, size_t usedSize);
+
+private:
+	//A cache line per class so threads allocating different sizes don't fight over the counters
+	struct alignas(64) SizeClassCounters_T
+	{
+		std::atomic<uint64_t>		m_numLiveAllocations = 0;
+		std::atomic<uint64_t>		m_peakLiveAllocations = 0;
+		std::atomic<uint64_t>		m_totalAllocations = 0;
+		std::atomic<uint64_t>		m_requestedBytes = 0;
+		std::atomic<uint64_t>		m_usedBytes = 0;
+	};
+
+	InternalAllocator*				m_base = nullptr;
+	bool							m_trackStats = true;
+	BlockAllocator					m_sizeClasses[SIZE_CLASS_COUNT];
+
+	//One entry per 16 bytes up to the largest class so picking a class is a single lookup
+	uint8_t							m_sizeClassLookup[SIZE_CLASS_BLOCK_SIZES[SIZE_CLASS_COUNT - 1] / 16 + 1];
+
+	//The last entry tracks the large allocation fallback
+	SizeClassCounters_T				m_counters[SIZE_CLASS_COUNT + 1];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Process wide size class pools used by the global operator new and delete when ENGINE_USE_POOLED_NEW is defined.
+// The pools never go through operator new themselves and are never torn down, so memory can be freed at any point of
+// static destruction. Usable directly as well, PooledFree only takes pointers that came from PooledAlloc.
+// The pools keep stats, FindPooledAllocator returns nullptr until the first PooledAlloc so reading them doesn't build the pools.
+//------------------------------------------------------------------------------------------------------------------------------
+void*					PooledAlloc(size_t byteCount);
+void					PooledFree(void* ptr);
+SizeClassAllocator*		FindPooledAllocator();
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "Engine/Allocators/StackAllocator.hpp"
+#include "Engine/Allocators/UntrackedAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Sits right in front of every allocation so Free can tell if it is the top of the stack
+struct StackAllocationHeader_T
+{
+	size_t		end;
+};
+
+static_assert(sizeof(StackAllocationHeader_T) <= STACK_ALLOCATOR_ALIGNMENT, "StackAllocationHeader_T must fit in one alignment step");
+
+//------------------------------------------------------------------------------------------------------------------------------
+StackAllocator::~StackAllocator()
+{
+	Deinitialize();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool StackAllocator::Initialize(InternalAllocator* base, size_t capacity)
+{
+	if (base == nullptr)
+	{
+		return false;
+	}
+
+	capacity = (capacity + STACK_ALLOCATOR_ALIGNMENT - 1) & ~(STACK_ALLOCATOR_ALIGNMENT - 1);
+	m_buffer = (uint8_t*)base->Allocate(capacity);
+	if (m_buffer == nullptr)
+	{
+		return false;
+	}
+
+	m_base = base;
+	m_capacity = capacity;
+	m_top = 0;
+	m_peakBytesUsed = 0;
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StackAllocator::Deinitialize()
+{
+	if (m_base == nullptr)
+	{
+		return;
+	}
+
+	m_base->Free(m_buffer);
+
+	m_base = nullptr;
+	m_buffer = nullptr;
+	m_capacity = 0;
+	m_top = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* StackAllocator::Allocate(size_t size)
+{
+	size_t alignedSize = (size + STACK_ALLOCATOR_ALIGNMENT - 1) & ~(STACK_ALLOCATOR_ALIGNMENT - 1);
+	size_t newTop = m_top + STACK_ALLOCATOR_ALIGNMENT + alignedSize;
+	if (newTop > m_capacity)
+	{
+		return nullptr;
+	}
+
+	StackAllocationHeader_T* header = (StackAllocationHeader_T*)(m_buffer + m_top);
+	header->end = newTop;
+
+	m_top = newTop;
+	m_peakBytesUsed = (m_top > m_peakBytesUsed) ? m_top : m_peakBytesUsed;
+
+	return (uint8_t*)header + STACK_ALLOCATOR_ALIGNMENT;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StackAllocator::Free(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	uint8_t* headerAddress = (uint8_t*)ptr - STACK_ALLOCATOR_ALIGNMENT;
+	StackAllocationHeader_T* header = (StackAllocationHeader_T*)headerAddress;
+
+	//Anything below the top stays put until a marker rolls the stack back past it
+	if (header->end == m_top)
+	{
+		m_top = (size_t)(headerAddress - m_buffer);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void StackAllocator::FreeToMarker(StackMarker marker)
+{
+	ASSERT_OR_DIE(marker <= m_top, "Freeing a StackAllocator to a marker above the current top");
+	m_top = marker;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("StackAllocatorMarkers", "Allocators", 100)
+{
+	StackAllocator stack;
+	CONFIRM(stack.Initialize(UntrackedAllocator::GetInstance(), 256));
+
+	//LIFO frees pop the stack, out of order frees wait for the marker
+	int* first = stack.Create<int>(1);
+	int* second = stack.Create<int>(2);
+	CONFIRM(((uintptr_t)first % STACK_ALLOCATOR_ALIGNMENT) == 0 && ((uintptr_t)second % STACK_ALLOCATOR_ALIGNMENT) == 0);
+
+	size_t usedWithBoth = stack.GetBytesUsed();
+	stack.Destroy(first);
+	CONFIRM(stack.GetBytesUsed() == usedWithBoth);
+	stack.Destroy(second);
+	stack.Destroy(first);
+	CONFIRM(stack.GetBytesUsed() == 0);
+
+	{
+		ScopedStackMarker marker(stack);
+		CONFIRM(stack.Allocate(64) != nullptr);
+		CONFIRM(stack.Allocate(64) != nullptr);
+		CONFIRM(stack.Allocate(256) == nullptr);
+	}
+	CONFIRM(stack.GetBytesUsed() == 0 && stack.GetPeakBytesUsed() == 160);
+
+	stack.Deinitialize();
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Allocators/InternalAllocator.hpp"
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr size_t STACK_ALLOCATOR_ALIGNMENT = 16;
+
+typedef size_t StackMarker;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Single threaded marker based stack allocator.
+// Allocations bump the top of the stack. Free only releases the most recent allocation (LIFO, so Create/Destroy pairs work
+// when nested properly), anything else has to wait until the stack is rolled back past it with FreeToMarker.
+// Use ScopedStackMarker to roll back everything allocated inside a scope.
+//------------------------------------------------------------------------------------------------------------------------------
+class StackAllocator : public InternalAllocator
+{
+public:
+	~StackAllocator();
+
+	bool							Initialize(InternalAllocator* base, size_t capacity);
+	void							Deinitialize();
+
+	//Interface methods
+	virtual void*					Allocate(size_t size) final;	// returns nullptr when the stack is full
+	virtual void					Free(void* ptr) final;			// only pops if ptr is the top allocation
+
+	StackMarker						GetMarker() const				{ return m_top; }
+	void							FreeToMarker(StackMarker marker);
+
+	size_t							GetCapacity() const				{ return m_capacity; }
+	size_t							GetBytesUsed() const			{ return m_top; }
+	size_t							GetPeakBytesUsed() const		{ return m_peakBytesUsed; }
+
+private:
+	InternalAllocator*				m_base = nullptr;
+	uint8_t*						m_buffer = nullptr;
+	size_t							m_capacity = 0;
+
+	size_t							m_top = 0;
+	size_t							m_peakBytesUsed = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+class ScopedStackMarker
+{
+public:
+	explicit ScopedStackMarker(StackAllocator& allocator) : m_allocator(allocator), m_marker(allocator.GetMarker()) {}
+	~ScopedStackMarker() { m_allocator.FreeToMarker(m_marker); }
+
+private:
+	StackAllocator&					m_allocator;
+	StackMarker						m_marker;
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include "Engine/Allocators/InternalAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+
+// STL allocator that forwards to any InternalAllocator, meant for std::vector and friends on top of a FrameArenaAllocator,
+// StackAllocator or SizeClassAllocator. Unlike the untracked and pool allocators this one carries state (the arena), so
+// two instances are only equal if they share the arena and the arena travels with the container on copy, move and swap.
+// Arenas that ignore Free don't get growth memory back until they reset, so reserve up front when you can.
+template <typename T>
+struct TemplatedArenaAllocator
+{
+	explicit TemplatedArenaAllocator(InternalAllocator* arena) noexcept : m_arena(arena) {}
+
+	template <class U>
+	constexpr TemplatedArenaAllocator(TemplatedArenaAllocator<U> const& other) noexcept : m_arena(other.m_arena) {}
+
+	typedef T               value_type;
+	typedef size_t          size_type;
+	typedef std::ptrdiff_t  difference_type;
+
+	typedef std::true_type  propagate_on_container_copy_assignment;
+	typedef std::true_type  propagate_on_container_move_assignment;
+	typedef std::true_type  propagate_on_container_swap;
+	typedef std::false_type is_always_equal;
+
+	T* allocate(size_t count) 
+	{ 
+		T* ptr = (T*)m_arena->Allocate(count * sizeof(T));
+		ASSERT_OR_DIE(ptr != nullptr, "TemplatedArenaAllocator ran out of memory in its arena");
+		return ptr;
+	}
+
+	void deallocate(T* ptr, size_t count) 
+	{ 
+		UNUSED(count);
+		m_arena->Free(ptr);
+	}
+
+	InternalAllocator* m_arena = nullptr;
+};
+
+template<typename T, class U>
+bool operator==(TemplatedArenaAllocator<T> const& a, TemplatedArenaAllocator<U> const& b)
+{ 
+	return a.m_arena == b.m_arena; 
+}
+
+template<typename T, class U>
+bool operator!=(TemplatedArenaAllocator<T> const& a, TemplatedArenaAllocator<U> const& b)
+{ 
+	return a.m_arena != b.m_arena; 
+}
\ No newline at end of file
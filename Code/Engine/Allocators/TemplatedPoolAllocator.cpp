@@ -0,0 +1,96 @@
+#include "Engine/Allocators/TemplatedPoolAllocator.hpp"
+#include "Engine/Allocators/StackAllocator.hpp"
+#include "Engine/Allocators/TemplatedArenaAllocator.hpp"
+#include "Engine/Allocators/TemplatedUntrackedAllocator.hpp"
+#include "Engine/Allocators/UntrackedAllocator.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include <list>
+#include <map>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The pools never go through operator new, so this is safe to hit from inside it while mem tracking. Sizes past the
+// largest class go to the pools' untracked base allocator
+//------------------------------------------------------------------------------------------------------------------------------
+void* NodePoolAllocate(size_t byteSize)
+{
+	return PooledAlloc(byteSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void NodePoolFree(void* ptr, size_t byteSize)
+{
+	//Every allocation remembers its size class, the size is only part of the signature to match the STL allocators
+	UNUSED(byteSize);
+	PooledFree(ptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+struct PoolTestValue_T
+{
+	int		m_value = 0;
+	char	m_padding[100];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Node containers on the pools and vectors on arenas both have to honor the count they are asked for
+UNITTEST("STLAllocators", "Allocators", 100)
+{
+	{
+		std::map<int, PoolTestValue_T, std::less<int>, TemplatedPoolAllocator<std::pair<int const, PoolTestValue_T>>> poolMap;
+		for (int key = 0; key < 5000; ++key)
+		{
+			poolMap[key].m_value = key * 3;
+		}
+		for (int key = 0; key < 5000; key += 2)
+		{
+			poolMap.erase(key);
+		}
+		CONFIRM(poolMap.size() == 2500 && poolMap[4999].m_value == 4999 * 3);
+
+		std::list<int, TemplatedPoolAllocator<int>> poolList(1000, 7);
+		CONFIRM(poolList.size() == 1000 && poolList.back() == 7);
+
+		//Arrays through the node allocator still get room for every element
+		std::vector<int, TemplatedPoolAllocator<int>> poolVector;
+		for (int index = 0; index < 10000; ++index)
+		{
+			poolVector.push_back(index);
+		}
+		CONFIRM(poolVector[9999] == 9999);
+	}
+
+	{
+		std::vector<int, TemplatedUntrackedAllocator<int>> untrackedVector;
+		for (int index = 0; index < 10000; ++index)
+		{
+			untrackedVector.push_back(index);
+		}
+		CONFIRM(untrackedVector[0] == 0 && untrackedVector[9999] == 9999);
+	}
+
+	StackAllocator stack;
+	stack.Initialize(UntrackedAllocator::GetInstance(), 64 * 1024);
+	{
+		ScopedStackMarker marker(stack);
+
+		TemplatedArenaAllocator<int> arenaAllocator(&stack);
+		std::vector<int, TemplatedArenaAllocator<int>> arenaVector(arenaAllocator);
+		arenaVector.reserve(1000);
+		for (int index = 0; index < 1000; ++index)
+		{
+			arenaVector.push_back(index);
+		}
+		CONFIRM(arenaVector[999] == 999 && stack.GetBytesUsed() >= 1000 * sizeof(int));
+
+		//Copies keep using the same arena
+		std::vector<int, TemplatedArenaAllocator<int>> arenaCopy = arenaVector;
+		CONFIRM(arenaCopy.get_allocator() == arenaVector.get_allocator() && arenaCopy[500] == 500);
+	}
+	CONFIRM(stack.GetBytesUsed() == 0);
+	stack.Deinitialize();
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include "Engine/Allocators/SizeClassAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/MemTracking.hpp"
+
+// Node allocations go to the process wide size class pools (PooledAlloc), which live until the process exits so static
+// containers can still free into them during shutdown. Pass the same size to the free as you did to the allocate.
+void*		NodePoolAllocate(size_t byteSize);
+void		NodePoolFree(void* ptr, size_t byteSize);
+
+// STL allocator for node based containers (std::map, std::set, std::list). Every node comes out of the size class pools,
+// which all hold per-thread magazine slots, so inserts and erases skip malloc and usually skip locks. Each node pays the
+// SIZE_CLASS_HEADER_SIZE header and is rounded up to its size class. Honors count so it is also safe (just not ideal) for
+// containers that allocate arrays.
+template <typename T>
+struct TemplatedPoolAllocator
+{
+	TemplatedPoolAllocator() = default;
+
+	template <class U>
+	constexpr TemplatedPoolAllocator(TemplatedPoolAllocator<U> const&) noexcept {}
+
+	typedef T               value_type;
+	typedef size_t          size_type;
+	typedef std::ptrdiff_t  difference_type;
+
+	// no local state, every instance talks to the same pools
+	typedef std::true_type  propagate_on_container_move_assignment;
+	typedef std::true_type  is_always_equal;
+
+	T* allocate(size_t count) 
+	{ 
+		// the size class pools only guarantee what the global operator new does
+		if constexpr (alignof(T) > SIZE_CLASS_ALIGNMENT)
+		{
+			return (T*)UntrackedAlloc(count * sizeof(T));
+		}
+
+		T* ptr = (T*)NodePoolAllocate(count * sizeof(T));
+		ASSERT_OR_DIE(ptr != nullptr, "TemplatedPoolAllocator ran out of memory");
+		return ptr;
+	}
+
+	void deallocate(T* ptr, size_t count) 
+	{ 
+		if constexpr (alignof(T) > SIZE_CLASS_ALIGNMENT)
+		{
+			UntrackedFree(ptr);
+			return;
+		}
+
+		NodePoolFree(ptr, count * sizeof(T));
+	}
+};
+
+template<typename T, class U>
+bool operator==(TemplatedPoolAllocator<T> const&, TemplatedPoolAllocator<U> const&)
+{ 
+	return true; 
+}
+
+template<typename T, class U>
+bool operator!=(TemplatedPoolAllocator<T> const&, TemplatedPoolAllocator<U> const&)
+{ 
+	return false; 
+}
\ No newline at end of file
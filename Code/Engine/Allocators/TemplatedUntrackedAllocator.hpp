@@ -25,15 +25,15 @@ struct TemplatedUntrackedAllocator
 	typedef std::true_type  propagate_on_container_move_assignment;   // when moving - does the allocator local state move with it?
 	typedef std::true_type  is_always_equal;                          // can optimize some containers (allocator of this type is always equal to others of its type)                         
 
-	T* allocate(size_t byte_size) 
+	// count is the number of T's the container wants room for, not a byte size
+	T* allocate(size_t count) 
 	{ 
-		UNUSED(byte_size);
-		return (T*) ::malloc(sizeof(T)); 
+		return (T*) ::malloc(count * sizeof(T)); 
 	}
 
-	void deallocate(T* ptr, size_t byte_size) 
+	void deallocate(T* ptr, size_t count) 
 	{ 
-		UNUSED(byte_size);
+		UNUSED(count);
 		::free(ptr); 
 	}
 };
@@ -18,6 +18,13 @@ Callstack CallstackGet(uint skip_frames /*= 0*/)
 	return stackTraceObject;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+uint CallstackCapture(void** out_trace, uint max_depth, uint skip_frames, unsigned long* out_hash)
+{
+	//Skip this function as well
+	return CaptureStackBackTrace(skip_frames + 1, max_depth, out_trace, out_hash);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 std::vector<std::string> GetCallstackToString(Callstack const& callStack)
 {
@@ -18,6 +18,10 @@ public:
 // skip frames is the number of frames from where we are to skip (ie, ignore)
 Callstack CallstackGet(uint skip_frames = 0);
 
+// Cheaper capture for hot paths, writes at most max_depth frames straight into out_trace instead of filling a whole
+// Callstack. Returns the number of frames captured, the hash covers only those frames
+uint CallstackCapture(void** out_trace, uint max_depth, uint skip_frames, unsigned long* out_hash);
+
 // Convert a callstack to strings
 // with one string per line
 // Strings should return in this format...
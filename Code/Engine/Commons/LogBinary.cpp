@@ -0,0 +1,1405 @@
+#include "Engine/Commons/LogBinary.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Async/MPSCAsyncRingBuffer.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/MemTracking.hpp"
+#include "Engine/Core/Time.hpp"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint LOG_STRING_SLOTS = LOG_MAX_STRINGS * 2;		// keep the tables at most half full so probes stay short
+constexpr uint LOG_CALLSTACK_SLOTS = LOG_MAX_CALLSTACKS * 2;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct LogSlot_T
+{
+	std::atomic<uint64_t>		hash;			// 0 while empty, written last so a reader that sees it also sees the ID
+	std::atomic<uint>			id;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One printf conversion, rebuilt with the length modifier of the type it was stored as
+struct LogFormatSpec_T
+{
+	char						spec[32];
+	uint						numStars = 0;
+	uint8_t						argType = LOG_ARG_INT;
+	bool						hasArg = true;			// false for %%
+	bool						isCount = false;		// %n, the pointer is read but nothing is printed
+	bool						isUnsigned = false;		// %u %o %x %X
+	uint8_t						narrowBits = 0;			// 16 for h and 8 for hh, the int printf reads is cut down to that
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static LogSlot_T			gLogStringSlots[LOG_STRING_SLOTS] = {};
+static LogFormat_T				gLogFormats[LOG_MAX_STRINGS] = { { "" }, { "%s", 1, { LOG_ARG_STRING } } };
+static std::atomic<uint>		gNumLogStrings = LOG_FORMATTED_STRING + 1;
+static std::atomic<bool>		gHasWarnedLogStringsFull = false;
+static std::mutex				gLogStringLock;
+
+static LogSlot_T				gLogCallstackSlots[LOG_CALLSTACK_SLOTS] = {};
+static Callstack*				gLogCallstacks[LOG_MAX_CALLSTACKS] = {};
+static std::atomic<uint>		gNumLogCallstacks = 1;
+static std::mutex				gLogCallstackLock;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t HashLogString(char const* text)
+{
+	//FNV-1a, never 0 so 0 can mean an empty slot
+	uint64_t hash = 14695981039346656037ULL;
+	for (char const* character = text; *character != '\0'; ++character)
+	{
+		hash = (hash ^ (uint64_t)(unsigned char)*character) * 1099511628211ULL;
+	}
+
+	return hash | 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Parses the spec that starts at percent. Returns where the format carries on after it, or nullptr if printf wouldn't
+// know what to do with it either
+static char const* ParseFormatSpec(char const* percent, LogFormatSpec_T& outSpec)
+{
+	char const* cursor = percent + 1;
+	if (*cursor == '%')
+	{
+		outSpec.hasArg = false;
+		return cursor + 1;
+	}
+
+	//Leave room for "ll", the conversion and the null terminator
+	char* specCursor = outSpec.spec;
+	char* specEnd = outSpec.spec + sizeof(outSpec.spec) - 4;
+	*specCursor++ = '%';
+
+	//Flags
+	while (*cursor != '\0' && strchr("-+ #0'", *cursor) != nullptr && specCursor < specEnd)
+	{
+		*specCursor++ = *cursor++;
+	}
+
+	//Width and precision
+	for (uint part = 0; part < 2; ++part)
+	{
+		if (part == 1)
+		{
+			if (*cursor != '.')
+			{
+				break;
+			}
+
+			*specCursor++ = *cursor++;
+		}
+
+		if (*cursor == '*')
+		{
+			outSpec.numStars++;
+			*specCursor++ = *cursor++;
+		}
+
+		while (*cursor >= '0' && *cursor <= '9' && specCursor < specEnd)
+		{
+			*specCursor++ = *cursor++;
+		}
+
+		if (specCursor >= specEnd)
+		{
+			return nullptr;
+		}
+	}
+
+	//Length, dropped from the spec since it is replaced by the stored type
+	bool is64Bit = false;
+	bool isWide = false;
+	bool isLongDouble = false;
+	uint8_t narrowBits = 0;
+	switch (*cursor)
+	{
+	case 'h':
+		narrowBits = (cursor[1] == 'h') ? 8 : 16;
+		cursor += (cursor[1] == 'h') ? 2 : 1;
+		break;
+	case 'l':
+		if (cursor[1] == 'l')
+		{
+			is64Bit = true;
+			cursor += 2;
+		}
+		else
+		{
+			is64Bit = (sizeof(long) == 8);
+			isWide = true;
+			cursor++;
+		}
+		break;
+	case 'j':
+	case 'q':
+		is64Bit = true;
+		cursor++;
+		break;
+	case 'z':
+	case 't':
+		is64Bit = (sizeof(size_t) == 8);
+		cursor++;
+		break;
+	case 'L':
+		isLongDouble = true;
+		cursor++;
+		break;
+	case 'I':
+		//MSVC I64, I32 and I (size_t)
+		if (cursor[1] == '6' && cursor[2] == '4')
+		{
+			is64Bit = true;
+			cursor += 3;
+		}
+		else if (cursor[1] == '3' && cursor[2] == '2')
+		{
+			cursor += 3;
+		}
+		else
+		{
+			is64Bit = (sizeof(size_t) == 8);
+			cursor++;
+		}
+		break;
+	default:
+		break;
+	}
+
+	char conversion = *cursor;
+	switch (conversion)
+	{
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+		outSpec.argType = is64Bit ? LOG_ARG_INT64 : LOG_ARG_INT;
+		outSpec.isUnsigned = (conversion != 'd' && conversion != 'i');
+		outSpec.narrowBits = narrowBits;
+		if (is64Bit)
+		{
+			*specCursor++ = 'l';
+			*specCursor++ = 'l';
+		}
+		break;
+	case 'c':
+		outSpec.argType = LOG_ARG_INT;
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		outSpec.argType = isLongDouble ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+		break;
+	case 's':
+	case 'S':
+		//Wide strings aren't copied, the pointer is logged instead
+		if (isWide || conversion == 'S')
+		{
+			outSpec.argType = LOG_ARG_POINTER;
+			conversion = 'p';
+		}
+		else
+		{
+			outSpec.argType = LOG_ARG_STRING;
+		}
+		break;
+	case 'p':
+		outSpec.argType = LOG_ARG_POINTER;
+		break;
+	case 'n':
+		outSpec.argType = LOG_ARG_POINTER;
+		outSpec.isCount = true;
+		break;
+	default:
+		return nullptr;
+	}
+
+	*specCursor++ = conversion;
+	*specCursor = '\0';
+	return cursor + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void ParseFormat(char const* text, LogFormat_T& outFormat)
+{
+	outFormat.text = text;
+	outFormat.numArgs = 0;
+
+	char const* cursor = strchr(text, '%');
+	while (cursor != nullptr)
+	{
+		LogFormatSpec_T spec;
+		char const* specEnd = ParseFormatSpec(cursor, spec);
+		if (specEnd == nullptr)
+		{
+			//Not a spec, the '%' is printed as is
+			cursor = strchr(cursor + 1, '%');
+			continue;
+		}
+
+		if (spec.hasArg)
+		{
+			if (outFormat.numArgs + spec.numStars + 1 > LOG_MAX_FORMAT_ARGS)
+			{
+				ERROR_RECOVERABLE("Log format reads too many arguments, the rest will be missing");
+				return;
+			}
+
+			for (uint starIndex = 0; starIndex < spec.numStars; ++starIndex)
+			{
+				outFormat.argTypes[outFormat.numArgs++] = LOG_ARG_INT;
+			}
+
+			outFormat.argTypes[outFormat.numArgs++] = spec.argType;
+		}
+
+		cursor = strchr(specEnd, '%');
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Returns the ID if the string is interned, otherwise the slot it would go in
+static uint FindLogString(char const* text, uint64_t hash, uint* outEmptySlot)
+{
+	uint slotIndex = (uint)hash & (LOG_STRING_SLOTS - 1);
+
+	while (true)
+	{
+		LogSlot_T& slot = gLogStringSlots[slotIndex];
+		uint64_t slotHash = slot.hash.load(std::memory_order_acquire);
+
+		if (slotHash == 0)
+		{
+			*outEmptySlot = slotIndex;
+			return LOG_INVALID_STRING;
+		}
+
+		if (slotHash == hash)
+		{
+			uint stringID = slot.id.load(std::memory_order_relaxed);
+			if (strcmp(gLogFormats[stringID].text, text) == 0)
+			{
+				return stringID;
+			}
+		}
+
+		slotIndex = (slotIndex + 1) & (LOG_STRING_SLOTS - 1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint LogInternString(char const* text)
+{
+	uint64_t hash = HashLogString(text);
+	uint emptySlot = 0;
+
+	uint stringID = FindLogString(text, hash, &emptySlot);
+	if (stringID != LOG_INVALID_STRING)
+	{
+		return stringID;
+	}
+
+	//Callers fall back to formatting the message themselves, so a full table is only worth mentioning once
+	if (gNumLogStrings.load(std::memory_order_relaxed) >= LOG_MAX_STRINGS)
+	{
+		if (!gHasWarnedLogStringsFull.exchange(true))
+		{
+			ERROR_RECOVERABLE("Ran out of log strings, new strings are formatted by the thread that logs them from now on. Raise LOG_MAX_STRINGS or log runtime text with LogFormattedf");
+		}
+
+		return LOG_INVALID_STRING;
+	}
+
+	//Not there yet, look again under the lock in case another thread just added it
+	std::scoped_lock<std::mutex> lock(gLogStringLock);
+	stringID = FindLogString(text, hash, &emptySlot);
+	if (stringID != LOG_INVALID_STRING)
+	{
+		return stringID;
+	}
+
+	uint numStrings = gNumLogStrings.load(std::memory_order_relaxed);
+	if (numStrings >= LOG_MAX_STRINGS)
+	{
+		return LOG_INVALID_STRING;
+	}
+
+	//Strings live as long as the process, keep them out of the tracked allocations
+	size_t textSize = strlen(text) + 1;
+	char* textCopy = (char*)UntrackedAlloc(textSize);
+	memcpy(textCopy, text, textSize);
+
+	stringID = numStrings;
+	ParseFormat(textCopy, gLogFormats[stringID]);
+	gNumLogStrings.store(numStrings + 1, std::memory_order_release);
+
+	LogSlot_T& slot = gLogStringSlots[emptySlot];
+	slot.id.store(stringID, std::memory_order_relaxed);
+	slot.hash.store(hash, std::memory_order_release);
+
+	return stringID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+char const* LogGetString(uint stringID)
+{
+	return LogGetFormat(stringID).text;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+LogFormat_T const& LogGetFormat(uint stringID)
+{
+	if (stringID >= gNumLogStrings.load(std::memory_order_acquire))
+	{
+		return gLogFormats[LOG_INVALID_STRING];
+	}
+
+	return gLogFormats[stringID];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint LogGetNumStrings()
+{
+	return gNumLogStrings.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t HashCallstack(void* const* trace, uint depth)
+{
+	//FNV-1a a frame at a time, never 0 so 0 can mean an empty slot
+	uint64_t hash = 14695981039346656037ULL;
+	for (uint frameIndex = 0; frameIndex < depth; ++frameIndex)
+	{
+		hash = (hash ^ (uint64_t)(uintptr_t)trace[frameIndex]) * 1099511628211ULL;
+	}
+
+	return hash | 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Returns the ID if the callstack is interned, otherwise the slot it would go in
+static uint FindLogCallstack(void* const* trace, uint depth, uint64_t hash, uint* outEmptySlot)
+{
+	uint slotIndex = (uint)hash & (LOG_CALLSTACK_SLOTS - 1);
+
+	while (true)
+	{
+		LogSlot_T& slot = gLogCallstackSlots[slotIndex];
+		uint64_t slotHash = slot.hash.load(std::memory_order_acquire);
+
+		if (slotHash == 0)
+		{
+			*outEmptySlot = slotIndex;
+			return LOG_NO_CALLSTACK;
+		}
+
+		if (slotHash == hash)
+		{
+			uint callstackID = slot.id.load(std::memory_order_relaxed);
+			Callstack const* callstack = gLogCallstacks[callstackID];
+			if (callstack->m_depth == depth && memcmp(callstack->m_trace, trace, depth * sizeof(void*)) == 0)
+			{
+				return callstackID;
+			}
+		}
+
+		slotIndex = (slotIndex + 1) & (LOG_CALLSTACK_SLOTS - 1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint LogInternCallstack(void* const* trace, uint depth)
+{
+	if (depth == 0)
+	{
+		return LOG_NO_CALLSTACK;
+	}
+
+	depth = (depth < MAX_TRACE) ? depth : MAX_TRACE;
+	uint64_t hash = HashCallstack(trace, depth);
+	uint emptySlot = 0;
+
+	uint callstackID = FindLogCallstack(trace, depth, hash, &emptySlot);
+	if (callstackID != LOG_NO_CALLSTACK)
+	{
+		return callstackID;
+	}
+
+	//Not there yet, look again under the lock in case another thread just added it
+	std::scoped_lock<std::mutex> lock(gLogCallstackLock);
+	callstackID = FindLogCallstack(trace, depth, hash, &emptySlot);
+	if (callstackID != LOG_NO_CALLSTACK)
+	{
+		return callstackID;
+	}
+
+	uint numCallstacks = gNumLogCallstacks.load(std::memory_order_relaxed);
+	ASSERT_RECOVERABLE(numCallstacks < LOG_MAX_CALLSTACKS, "Ran out of log callstacks, raise LOG_MAX_CALLSTACKS");
+	if (numCallstacks >= LOG_MAX_CALLSTACKS)
+	{
+		return LOG_NO_CALLSTACK;
+	}
+
+	Callstack* callstack = new (UntrackedAlloc(sizeof(Callstack))) Callstack();
+	memcpy(callstack->m_trace, trace, depth * sizeof(void*));
+	callstack->m_depth = depth;
+	callstack->m_hash = (unsigned long)hash;
+
+	callstackID = numCallstacks;
+	gLogCallstacks[callstackID] = callstack;
+	gNumLogCallstacks.store(numCallstacks + 1, std::memory_order_release);
+
+	LogSlot_T& slot = gLogCallstackSlots[emptySlot];
+	slot.id.store(callstackID, std::memory_order_relaxed);
+	slot.hash.store(hash, std::memory_order_release);
+
+	return callstackID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Callstack const* LogGetCallstack(uint callstackID)
+{
+	if (callstackID == LOG_NO_CALLSTACK || callstackID >= gNumLogCallstacks.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+
+	return gLogCallstacks[callstackID];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint LogGetNumCallstacks()
+{
+	return gNumLogCallstacks.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool WriteArg(char* outArgs, uint& argSize, uint maxBytes, void const* value, uint valueSize)
+{
+	if (argSize + valueSize > maxBytes)
+	{
+		return false;
+	}
+
+	memcpy(outArgs + argSize, value, valueSize);
+	argSize += valueSize;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint LogEncodeArgs(LogFormat_T const& format, va_list args, char* outArgs, uint maxBytes)
+{
+	uint argSize = 0;
+	for (uint argIndex = 0; argIndex < format.numArgs; ++argIndex)
+	{
+		bool wasWritten = true;
+		switch (format.argTypes[argIndex])
+		{
+		case LOG_ARG_INT:
+		{
+			int value = va_arg(args, int);
+			wasWritten = WriteArg(outArgs, argSize, maxBytes, &value, sizeof(value));
+		}
+		break;
+		case LOG_ARG_INT64:
+		{
+			long long value = va_arg(args, long long);
+			wasWritten = WriteArg(outArgs, argSize, maxBytes, &value, sizeof(value));
+		}
+		break;
+		case LOG_ARG_DOUBLE:
+		{
+			double value = va_arg(args, double);
+			wasWritten = WriteArg(outArgs, argSize, maxBytes, &value, sizeof(value));
+		}
+		break;
+		case LOG_ARG_LONG_DOUBLE:
+		{
+			double value = (double)va_arg(args, long double);
+			wasWritten = WriteArg(outArgs, argSize, maxBytes, &value, sizeof(value));
+		}
+		break;
+		case LOG_ARG_POINTER:
+		{
+			uint64_t value = (uint64_t)(uintptr_t)va_arg(args, void*);
+			wasWritten = WriteArg(outArgs, argSize, maxBytes, &value, sizeof(value));
+		}
+		break;
+		case LOG_ARG_STRING:
+		{
+			char const* value = va_arg(args, char const*);
+			if (value == nullptr)
+			{
+				value = "(null)";
+			}
+
+			//Cut the string down to whatever room is left rather than dropping it
+			uint room = maxBytes - argSize;
+			if (room <= sizeof(uint16_t) + 1)
+			{
+				return argSize;
+			}
+
+			size_t length = strlen(value);
+			size_t maxLength = room - sizeof(uint16_t) - 1;
+			if (maxLength > UINT16_MAX - 1)
+			{
+				maxLength = UINT16_MAX - 1;
+			}
+			length = (length < maxLength) ? length : maxLength;
+
+			uint16_t storedSize = (uint16_t)(length + 1);
+			WriteArg(outArgs, argSize, maxBytes, &storedSize, sizeof(storedSize));
+			WriteArg(outArgs, argSize, maxBytes, value, (uint)length);
+			outArgs[argSize++] = '\0';
+		}
+		break;
+		default:
+			break;
+		}
+
+		if (!wasWritten)
+		{
+			break;
+		}
+	}
+
+	return argSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+static int FormatArg(char* buffer, size_t bufferSize, LogFormatSpec_T const& spec, int const* stars, TYPE value)
+{
+	switch (spec.numStars)
+	{
+	case 0:
+		return snprintf(buffer, bufferSize, spec.spec, value);
+	case 1:
+		return snprintf(buffer, bufferSize, spec.spec, stars[0], value);
+	default:
+		return snprintf(buffer, bufferSize, spec.spec, stars[0], stars[1], value);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+static void AppendFormattedArg(std::string& outText, LogFormatSpec_T const& spec, int const* stars, TYPE value)
+{
+	char buffer[256];
+	int length = FormatArg(buffer, sizeof(buffer), spec, stars, value);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	if (length < (int)sizeof(buffer))
+	{
+		outText.append(buffer, length);
+		return;
+	}
+
+	//Didn't fit on the stack, format straight into the string
+	size_t oldSize = outText.size();
+	outText.resize(oldSize + length + 1);
+	FormatArg(&outText[oldSize], length + 1, spec, stars, value);
+	outText.resize(oldSize + length);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// printf reads a whole int for %hd or %hhu and then converts it to the short or char the spec asks for
+static int NarrowFormatInt(LogFormatSpec_T const& spec, int value)
+{
+	switch (spec.narrowBits)
+	{
+	case 16:
+		return spec.isUnsigned ? (int)(unsigned short)value : (int)(short)value;
+	case 8:
+		return spec.isUnsigned ? (int)(unsigned char)value : (int)(signed char)value;
+	default:
+		return value;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool ReadBytes(char const*& cursor, char const* end, void* outData, size_t size)
+{
+	if ((size_t)(end - cursor) < size)
+	{
+		return false;
+	}
+
+	memcpy(outData, cursor, size);
+	cursor += size;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFormatArgs(std::string& outText, char const* format, char const* args, uint argSize)
+{
+	char const* argCursor = args;
+	char const* argEnd = args + argSize;
+
+	char const* cursor = format;
+	while (*cursor != '\0')
+	{
+		char const* percent = strchr(cursor, '%');
+		if (percent == nullptr)
+		{
+			outText += cursor;
+			return;
+		}
+
+		outText.append(cursor, percent - cursor);
+
+		LogFormatSpec_T spec;
+		char const* specEnd = ParseFormatSpec(percent, spec);
+		if (specEnd == nullptr)
+		{
+			outText += '%';
+			cursor = percent + 1;
+			continue;
+		}
+
+		cursor = specEnd;
+		if (!spec.hasArg)
+		{
+			outText += '%';
+			continue;
+		}
+
+		//Arguments that were cut off on the producer print the spec itself
+		int stars[2] = {};
+		bool isMissing = false;
+		for (uint starIndex = 0; starIndex < spec.numStars; ++starIndex)
+		{
+			isMissing = isMissing || !ReadBytes(argCursor, argEnd, &stars[starIndex], sizeof(int));
+		}
+
+		switch (spec.argType)
+		{
+		case LOG_ARG_INT:
+		{
+			int value = 0;
+			isMissing = isMissing || !ReadBytes(argCursor, argEnd, &value, sizeof(value));
+			if (!isMissing)
+			{
+				AppendFormattedArg(outText, spec, stars, NarrowFormatInt(spec, value));
+			}
+		}
+		break;
+		case LOG_ARG_INT64:
+		{
+			long long value = 0;
+			isMissing = isMissing || !ReadBytes(argCursor, argEnd, &value, sizeof(value));
+			if (!isMissing)
+			{
+				AppendFormattedArg(outText, spec, stars, value);
+			}
+		}
+		break;
+		case LOG_ARG_DOUBLE:
+		case LOG_ARG_LONG_DOUBLE:
+		{
+			double value = 0.0;
+			isMissing = isMissing || !ReadBytes(argCursor, argEnd, &value, sizeof(value));
+			if (!isMissing)
+			{
+				AppendFormattedArg(outText, spec, stars, value);
+			}
+		}
+		break;
+		case LOG_ARG_POINTER:
+		{
+			uint64_t value = 0;
+			isMissing = isMissing || !ReadBytes(argCursor, argEnd, &value, sizeof(value));
+			if (!isMissing && !spec.isCount)
+			{
+				AppendFormattedArg(outText, spec, stars, (void*)(uintptr_t)value);
+			}
+		}
+		break;
+		case LOG_ARG_STRING:
+		{
+			uint16_t storedSize = 0;
+			isMissing = isMissing || !ReadBytes(argCursor, argEnd, &storedSize, sizeof(storedSize));
+			isMissing = isMissing || storedSize == 0 || (size_t)(argEnd - argCursor) < storedSize;
+			if (!isMissing)
+			{
+				AppendFormattedArg(outText, spec, stars, argCursor);
+				argCursor += storedSize;
+			}
+		}
+		break;
+		default:
+			break;
+		}
+
+		if (isMissing)
+		{
+			outText.append(percent, specEnd - percent);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogDecodeBinary(char const* data, size_t dataSize, std::string& outText)
+{
+	char const* cursor = data;
+	char const* end = data + dataSize;
+
+	LogFileHeader_T header;
+	if (!ReadBytes(cursor, end, &header, sizeof(header)) || header.magic != LOG_FILE_MAGIC || header.version != LOG_FILE_VERSION)
+	{
+		return false;
+	}
+
+	outText += "Log Initialized";
+
+	std::vector<std::string> strings;
+	std::vector<std::string> callstacks;
+	char timeBuffer[64];
+	while (cursor < end)
+	{
+		uint8_t recordType = 0;
+		ReadBytes(cursor, end, &recordType, sizeof(recordType));
+
+		switch (recordType)
+		{
+		case LOG_RECORD_STRING:
+		{
+			uint stringID = 0;
+			uint length = 0;
+			if (!ReadBytes(cursor, end, &stringID, sizeof(stringID)) || !ReadBytes(cursor, end, &length, sizeof(length)) || (size_t)(end - cursor) < length || stringID >= LOG_MAX_STRINGS)
+			{
+				return false;
+			}
+
+			if (stringID >= strings.size())
+			{
+				strings.resize(stringID + 1);
+			}
+
+			strings[stringID].assign(cursor, length);
+			cursor += length;
+		}
+		break;
+		case LOG_RECORD_MESSAGE:
+		{
+			uint64_t hpcTime = 0;
+			uint formatID = 0;
+			uint filterID = 0;
+			uint callstackID = 0;
+			uint argSize = 0;
+			if (!ReadBytes(cursor, end, &hpcTime, sizeof(hpcTime)) || !ReadBytes(cursor, end, &formatID, sizeof(formatID)) || !ReadBytes(cursor, end, &filterID, sizeof(filterID))
+				|| !ReadBytes(cursor, end, &callstackID, sizeof(callstackID)) || !ReadBytes(cursor, end, &argSize, sizeof(argSize)) || (size_t)(end - cursor) < argSize)
+			{
+				return false;
+			}
+
+			snprintf(timeBuffer, sizeof(timeBuffer), "%f", (double)hpcTime * header.secondsPerTick);
+
+			outText += "\n\n Log Entry: \n\t Time: ";
+			outText += timeBuffer;
+			outText += "\n\t Filter: ";
+			outText += (filterID < strings.size()) ? strings[filterID] : "";
+			outText += "\n\t Message: ";
+			LogFormatArgs(outText, (formatID < strings.size()) ? strings[formatID].c_str() : "", cursor, argSize);
+			cursor += argSize;
+
+			if (callstackID != LOG_NO_CALLSTACK && callstackID < callstacks.size())
+			{
+				outText += "\n\t Callstack: \n\t ";
+				outText += callstacks[callstackID];
+			}
+		}
+		break;
+		case LOG_RECORD_CALLSTACK:
+		{
+			uint callstackID = 0;
+			uint length = 0;
+			if (!ReadBytes(cursor, end, &callstackID, sizeof(callstackID)) || !ReadBytes(cursor, end, &length, sizeof(length)) || (size_t)(end - cursor) < length || callstackID >= LOG_MAX_CALLSTACKS)
+			{
+				return false;
+			}
+
+			if (callstackID >= callstacks.size())
+			{
+				callstacks.resize(callstackID + 1);
+			}
+
+			callstacks[callstackID].assign(cursor, length);
+			cursor += length;
+		}
+		break;
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogDecodeBinaryFile(std::string const& binaryFileName, std::string const& textFileName)
+{
+	//Whatever was decoded before a bad block or record still gets written out
+	std::string fileData;
+	bool isValid = LogReadFile(binaryFileName, fileData);
+	if (fileData.empty())
+	{
+		return false;
+	}
+
+	std::string text;
+	isValid = LogDecodeBinary(fileData.data(), fileData.size(), text) && isValid;
+
+	std::ofstream* textFile = CreateTextFileWriteBuffer(textFileName);
+	if (textFile == nullptr)
+	{
+		return false;
+	}
+
+	textFile->write(text.c_str(), text.length());
+	textFile->close();
+	delete textFile;
+
+	return isValid;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::Begin(LogFileWriter* file)
+{
+	m_file = file;
+	WriteHeader();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::RotateIfNeeded()
+{
+	if (m_file->ShouldRotate())
+	{
+		m_file->Rotate();
+		WriteHeader();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::WriteHeader()
+{
+	m_writtenStrings.assign(LOG_MAX_STRINGS, false);
+	m_writtenCallstacks.assign(LOG_MAX_CALLSTACKS, false);
+
+	LogFileHeader_T header;
+	header.secondsPerTick = GetHPCToSeconds(1);
+	Append(&header, sizeof(header));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::WriteString(uint stringID)
+{
+	if (stringID >= LOG_MAX_STRINGS || m_writtenStrings[stringID])
+	{
+		return;
+	}
+
+	m_writtenStrings[stringID] = true;
+
+	char const* text = LogGetString(stringID);
+	uint length = (uint)strlen(text);
+	uint8_t recordType = LOG_RECORD_STRING;
+
+	Append(&recordType, sizeof(recordType));
+	Append(&stringID, sizeof(stringID));
+	Append(&length, sizeof(length));
+	Append(text, length);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::WriteMessage(uint64_t hpcTime, uint formatID, uint filterID, uint callstackID, char const* args, uint argSize)
+{
+	WriteString(formatID);
+	WriteString(filterID);
+
+	uint8_t recordType = LOG_RECORD_MESSAGE;
+	Append(&recordType, sizeof(recordType));
+	Append(&hpcTime, sizeof(hpcTime));
+	Append(&formatID, sizeof(formatID));
+	Append(&filterID, sizeof(filterID));
+	Append(&callstackID, sizeof(callstackID));
+	Append(&argSize, sizeof(argSize));
+	Append(args, argSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::WriteCallstack(uint callstackID, std::string const& callstackText)
+{
+	if (IsCallstackWritten(callstackID) || callstackID >= LOG_MAX_CALLSTACKS)
+	{
+		return;
+	}
+
+	m_writtenCallstacks[callstackID] = true;
+
+	uint8_t recordType = LOG_RECORD_CALLSTACK;
+	uint length = (uint)callstackText.length();
+
+	Append(&recordType, sizeof(recordType));
+	Append(&callstackID, sizeof(callstackID));
+	Append(&length, sizeof(length));
+	Append(callstackText.c_str(), length);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogBinaryWriter::IsCallstackWritten(uint callstackID) const
+{
+	return callstackID < m_writtenCallstacks.size() && m_writtenCallstacks[callstackID];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogBinaryWriter::Flush()
+{
+	m_file->Flush();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define LOGTEST_MESSAGES 200000
+#define LOGTEST_MAX_PRODUCERS 4
+#define LOGTEST_BUFFER_SIZE (1024 * 1024)
+#define LOGTEST_MAX_THREADS 8
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uint EncodeTestArgs(char* outArgs, uint maxBytes, char const* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	uint argSize = LogEncodeArgs(LogGetFormat(LogInternString(format)), args, outArgs, maxBytes);
+	va_end(args);
+
+	return argSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool ConfirmRoundTrip(char const* format, ...)
+{
+	char args[LOG_MAX_ARG_BYTES];
+
+	va_list encodeArgs;
+	va_start(encodeArgs, format);
+	uint argSize = LogEncodeArgs(LogGetFormat(LogInternString(format)), encodeArgs, args, LOG_MAX_ARG_BYTES);
+	va_end(encodeArgs);
+
+	char expected[1024];
+	va_list printArgs;
+	va_start(printArgs, format);
+	vsnprintf(expected, sizeof(expected), format, printArgs);
+	va_end(printArgs);
+
+	std::string decoded;
+	LogFormatArgs(decoded, format, args, argSize);
+	if (decoded != expected)
+	{
+		DebuggerPrintf("\n Log round trip mismatch: \"%s\" vs \"%s\"", decoded.c_str(), expected);
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogBinary", "Log", 100)
+{
+	//Same text from a different buffer is the same ID
+	char textBuffer[64];
+	strcpy_s(textBuffer, "LogBinaryTest %d");
+	uint formatID = LogInternString("LogBinaryTest %d");
+	CONFIRM(formatID != LOG_INVALID_STRING);
+	CONFIRM(LogInternString(textBuffer) == formatID);
+	CONFIRM(LogGetFormat(formatID).numArgs == 1 && LogGetFormat(formatID).argTypes[0] == LOG_ARG_INT);
+	CONFIRM(strcmp(LogGetString(LOG_MAX_STRINGS + 1), "") == 0);
+
+	uint starFormatID = LogInternString("%*.*f %% %lld %s %p");
+	LogFormat_T const& starFormat = LogGetFormat(starFormatID);
+	CONFIRM(starFormat.numArgs == 6);
+	CONFIRM(starFormat.argTypes[0] == LOG_ARG_INT && starFormat.argTypes[1] == LOG_ARG_INT && starFormat.argTypes[2] == LOG_ARG_DOUBLE);
+	CONFIRM(starFormat.argTypes[3] == LOG_ARG_INT64 && starFormat.argTypes[4] == LOG_ARG_STRING && starFormat.argTypes[5] == LOG_ARG_POINTER);
+
+	//Decoding gives back exactly what printf would have
+	CONFIRM(ConfirmRoundTrip("No arguments at all"));
+	CONFIRM(ConfirmRoundTrip("%d %i %u %x %X %o %c", -42, 7, 3000000000U, 255, 255, 8, 'Q'));
+	CONFIRM(ConfirmRoundTrip("%hd %hhu %ld %lu %lld %llu %zu", (short)-3, (unsigned char)200, -123456L, 123456UL, -1234567890123LL, 9876543210ULL, (size_t)77));
+	CONFIRM(ConfirmRoundTrip("%hd %hu %hhd %hhu %hx %hhX %5hho", 70000, -1, 200, 300, -1, 511, 0x1FF));
+
+	//Messages formatted by the producer are logged under a reserved "%s"
+	LogFormat_T const& formattedFormat = LogGetFormat(LOG_FORMATTED_STRING);
+	CONFIRM(strcmp(formattedFormat.text, "%s") == 0 && formattedFormat.numArgs == 1 && formattedFormat.argTypes[0] == LOG_ARG_STRING);
+	CONFIRM(ConfirmRoundTrip("%f %.3f %e %g %10.2f %-8.1f|", 3.14159, 2.5f, 1e-7, 0.0001, 1234.5678, -1.25));
+	CONFIRM(ConfirmRoundTrip("%*d|%-*d|%.*f|%*.*f", 6, 42, 6, 42, 2, 3.14159, 10, 3, 2.71828));
+	CONFIRM(ConfirmRoundTrip("%s and %10s and %-10s| and %.3s", "first", "right", "left", "truncated"));
+	CONFIRM(ConfirmRoundTrip("100%% done, %s", "percent"));
+	CONFIRM(ConfirmRoundTrip("%p", (void*)0x1234));
+	CONFIRM(ConfirmRoundTrip("%+05d % d %#x %#o", 42, 42, 255, 8));
+
+	//Strings are copied so the caller's buffer can change straight after
+	char args[LOG_MAX_ARG_BYTES];
+	char changingText[32];
+	strcpy_s(changingText, "before");
+	uint argSize = EncodeTestArgs(args, LOG_MAX_ARG_BYTES, "%s", changingText);
+	strcpy_s(changingText, "after");
+	std::string decoded;
+	LogFormatArgs(decoded, "%s", args, argSize);
+	CONFIRM(decoded == "before");
+
+	//Arguments past the limit are cut off and show up as the spec
+	argSize = EncodeTestArgs(args, 12, "%d %d %d %d", 1, 2, 3, 4);
+	CONFIRM(argSize == 12);
+	decoded.clear();
+	LogFormatArgs(decoded, "%d %d %d %d", args, argSize);
+	CONFIRM(decoded == "1 2 3 %d");
+
+	std::string longText(2000, 'x');
+	argSize = EncodeTestArgs(args, LOG_MAX_ARG_BYTES, "%s", longText.c_str());
+	CONFIRM(argSize == LOG_MAX_ARG_BYTES);
+
+	//Callstacks with the same frames share an ID
+	void* traceA[3] = { (void*)0x1000, (void*)0x2000, (void*)0x3000 };
+	void* traceB[3] = { (void*)0x1000, (void*)0x2000, (void*)0x4000 };
+	uint callstackA = LogInternCallstack(traceA, 3);
+	CONFIRM(callstackA != LOG_NO_CALLSTACK);
+	CONFIRM(LogInternCallstack(traceA, 3) == callstackA);
+	CONFIRM(LogInternCallstack(traceA, 2) != callstackA);
+	CONFIRM(LogInternCallstack(traceB, 3) != callstackA);
+	CONFIRM(LogInternCallstack(traceA, 0) == LOG_NO_CALLSTACK);
+	CONFIRM(LogGetCallstack(LOG_NO_CALLSTACK) == nullptr);
+	CONFIRM(LogGetCallstack(callstackA)->m_depth == 3 && LogGetCallstack(callstackA)->m_trace[2] == traceA[2]);
+
+	//Whole file round trip, compressed and rotated after the first message
+	LogFileConfig_T config;
+	config.basePath = "Data/LogBinaryTest";
+	config.compress = true;
+	config.maxFileSize = 1;
+
+	LogFileWriter file;
+	CONFIRM(file.Open(config));
+
+	LogBinaryWriter writer;
+	writer.Begin(&file);
+
+	uint filterID = LogInternString("LogBinaryTest");
+	argSize = EncodeTestArgs(args, LOG_MAX_ARG_BYTES, "LogBinaryTest %d", 7);
+	writer.WriteMessage(GetCurrentTimeHPC(), formatID, filterID, LOG_NO_CALLSTACK, args, argSize);
+	writer.RotateIfNeeded();
+
+	//The callstack is only written out the first time
+	for (int messageIndex = 8; messageIndex < 10; ++messageIndex)
+	{
+		CONFIRM(writer.IsCallstackWritten(callstackA) == (messageIndex != 8));
+		writer.WriteCallstack(callstackA, "Frame A\n\t Frame B\n\t ");
+
+		argSize = EncodeTestArgs(args, LOG_MAX_ARG_BYTES, "LogBinaryTest %d", messageIndex);
+		writer.WriteMessage(GetCurrentTimeHPC(), formatID, filterID, callstackA, args, argSize);
+	}
+	writer.Flush();
+	file.Close();
+
+	std::string texts[2];
+	for (uint partIndex = 0; partIndex < 2; ++partIndex)
+	{
+		std::string fileName = Stringf("Data/LogBinaryTest_%u.bin", partIndex);
+		std::string textFileName = "Data/LogBinaryTest.txt";
+		CONFIRM(LogDecodeBinaryFile(fileName, textFileName));
+
+		char* fileData = nullptr;
+		unsigned long fileSize = CreateFileReadBuffer(textFileName, &fileData);
+		texts[partIndex].assign(fileData, fileSize);
+		delete[] fileData;
+		remove(fileName.c_str());
+		remove(textFileName.c_str());
+
+		CONFIRM(texts[partIndex].find("Log Initialized") == 0);
+	}
+
+	CONFIRM(texts[0].find("\n\t Filter: LogBinaryTest\n\t Message: LogBinaryTest 7") != std::string::npos);
+	CONFIRM(texts[0].find("LogBinaryTest 8") == std::string::npos);
+	CONFIRM(texts[1].find("\n\t Filter: LogBinaryTest\n\t Message: LogBinaryTest 8\n\t Callstack: \n\t Frame A\n\t Frame B") != std::string::npos);
+	CONFIRM(texts[1].find("\n\t Message: LogBinaryTest 9\n\t Callstack: \n\t Frame A\n\t Frame B") != std::string::npos);
+
+	//Garbage isn't a log
+	CONFIRM(!LogDecodeBinary(textBuffer, sizeof(textBuffer), decoded));
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What Logf used to do on the producer, measure the string and then print it into the ring buffer
+static void LegacyTestLogf(MPSCRingBuffer& ringBuffer, char const* filter, char const* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	va_list measureArgs;
+	va_copy(measureArgs, args);
+	size_t messageLength = vsnprintf(nullptr, 0, format, measureArgs) + 1U;
+	va_end(measureArgs);
+
+	size_t filterLength = strlen(filter) + 1U;
+	char* buffer = (char*)ringBuffer.LockWrite(sizeof(uint64_t) + messageLength + filterLength);
+	*(uint64_t*)buffer = GetCurrentTimeHPC();
+	vsnprintf(buffer + sizeof(uint64_t), messageLength, format, args);
+	memcpy(buffer + sizeof(uint64_t) + messageLength, filter, filterLength);
+	va_end(args);
+
+	ringBuffer.UnlockWrite(buffer);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct LogTestEntry_T
+{
+	uint64_t		hpcTime;
+	uint			formatID;
+	uint			filterID;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void BinaryTestLogf(MPSCRingBuffer& ringBuffer, uint filterID, uint formatID, ...)
+{
+	va_list args;
+	va_start(args, formatID);
+	char argBuffer[LOG_MAX_ARG_BYTES];
+	uint argSize = LogEncodeArgs(LogGetFormat(formatID), args, argBuffer, LOG_MAX_ARG_BYTES);
+	va_end(args);
+
+	LogTestEntry_T* entry = (LogTestEntry_T*)ringBuffer.LockWrite(sizeof(LogTestEntry_T) + argSize);
+	entry->hpcTime = GetCurrentTimeHPC();
+	entry->formatID = formatID;
+	entry->filterID = filterID;
+	memcpy(entry + 1, argBuffer, argSize);
+
+	ringBuffer.UnlockWrite(entry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogProducerLatency", "Log", 200)
+{
+	MPSCRingBuffer ringBuffer;
+	ringBuffer.InitializeBuffer(LOGTEST_BUFFER_SIZE);
+
+	char const* format = "Frame %d took %.3f ms on %s (%zu allocations)";
+	uint formatID = LogInternString(format);
+	uint filterID = LogInternString("LogProducerLatency");
+
+	for (uint numProducers = 1; numProducers <= LOGTEST_MAX_PRODUCERS; numProducers *= 2)
+	{
+		for (uint runIndex = 0; runIndex < 2; ++runIndex)
+		{
+			bool isBinary = (runIndex == 1);
+			uint messagesPerProducer = LOGTEST_MESSAGES / numProducers;
+
+			//Drain as fast as possible so producers only ever measure their own cost
+			std::atomic<bool> isDone = false;
+			std::thread consumer([&ringBuffer, &isDone]()
+			{
+				size_t size = 0;
+				while (true)
+				{
+					void* record = ringBuffer.TryLockRead(&size);
+					if (record != nullptr)
+					{
+						ringBuffer.UnlockRead(record);
+					}
+					else if (isDone)
+					{
+						break;
+					}
+				}
+			});
+
+			std::atomic<uint64_t> totalProducerTicks = 0;
+			std::vector<std::thread> producers;
+			for (uint producerIndex = 0; producerIndex < numProducers; ++producerIndex)
+			{
+				producers.emplace_back([&, producerIndex]()
+				{
+					uint64_t startTime = GetCurrentTimeHPC();
+					for (uint messageIndex = 0; messageIndex < messagesPerProducer; ++messageIndex)
+					{
+						if (isBinary)
+						{
+							BinaryTestLogf(ringBuffer, filterID, formatID, (int)messageIndex, 16.667, "MainThread", (size_t)producerIndex);
+						}
+						else
+						{
+							LegacyTestLogf(ringBuffer, "LogProducerLatency", format, (int)messageIndex, 16.667, "MainThread", (size_t)producerIndex);
+						}
+					}
+					totalProducerTicks += GetCurrentTimeHPC() - startTime;
+				});
+			}
+
+			for (std::thread& producer : producers)
+			{
+				producer.join();
+			}
+
+			isDone = true;
+			consumer.join();
+
+			double nsPerMessage = GetHPCToSeconds(totalProducerTicks) * 1000000000.0 / (double)(numProducers * messagesPerProducer);
+			DebuggerPrintf("\n Log producer %s %u threads: %.1f ns per message", isBinary ? "binary" : "vsnprintf", numProducers, nsPerMessage);
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What a ring buffer entry used to look like, with the callstack captured and thrown away on every message
+struct LogInlineCallstackTestEntry_T
+{
+	uint64_t		hpcTime;
+	uint			formatID;
+	uint			filterID;
+	uint			argSize;
+	Callstack		callstack;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct LogCallstackIDTestEntry_T
+{
+	uint64_t		hpcTime;
+	uint			formatID;
+	uint			filterID;
+	uint			callstackID;
+	uint			argSize;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void InlineCallstackTestLogf(MPSCRingBuffer& ringBuffer, uint filterID, uint formatID, ...)
+{
+	va_list args;
+	va_start(args, formatID);
+	char argBuffer[LOG_MAX_ARG_BYTES];
+	uint argSize = LogEncodeArgs(LogGetFormat(formatID), args, argBuffer, LOG_MAX_ARG_BYTES);
+	va_end(args);
+
+	LogInlineCallstackTestEntry_T* entry = (LogInlineCallstackTestEntry_T*)ringBuffer.LockWrite(sizeof(LogInlineCallstackTestEntry_T) + argSize);
+	entry->hpcTime = GetCurrentTimeHPC();
+	entry->formatID = formatID;
+	entry->filterID = filterID;
+	entry->argSize = argSize;
+	entry->callstack = CallstackGet(2);
+	entry->callstack.m_depth = 0;
+	memcpy(entry + 1, argBuffer, argSize);
+
+	ringBuffer.UnlockWrite(entry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void CallstackIDTestLogf(MPSCRingBuffer& ringBuffer, bool captureCallstack, uint filterID, uint formatID, ...)
+{
+	va_list args;
+	va_start(args, formatID);
+	char argBuffer[LOG_MAX_ARG_BYTES];
+	uint argSize = LogEncodeArgs(LogGetFormat(formatID), args, argBuffer, LOG_MAX_ARG_BYTES);
+	va_end(args);
+
+	uint callstackID = LOG_NO_CALLSTACK;
+	if (captureCallstack)
+	{
+		void* trace[MAX_TRACE];
+		unsigned long traceHash = 0;
+		uint depth = CallstackCapture(trace, MAX_TRACE, 1, &traceHash);
+		callstackID = LogInternCallstack(trace, depth);
+	}
+
+	LogCallstackIDTestEntry_T* entry = (LogCallstackIDTestEntry_T*)ringBuffer.LockWrite(sizeof(LogCallstackIDTestEntry_T) + argSize);
+	entry->hpcTime = GetCurrentTimeHPC();
+	entry->formatID = formatID;
+	entry->filterID = filterID;
+	entry->callstackID = callstackID;
+	entry->argSize = argSize;
+	memcpy(entry + 1, argBuffer, argSize);
+
+	ringBuffer.UnlockWrite(entry);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogThroughput", "Log", 200)
+{
+	MPSCRingBuffer ringBuffer;
+	ringBuffer.InitializeBuffer(LOGTEST_BUFFER_SIZE);
+
+	uint formatID = LogInternString("Entity %u moved to (%.2f, %.2f)");
+	uint filterID = LogInternString("LogThroughput");
+
+	char const* modeNames[3] = { "inline callstack", "callstack ID", "callstack ID + capture" };
+	for (uint numThreads = 1; numThreads <= LOGTEST_MAX_THREADS; numThreads *= 2)
+	{
+		for (uint mode = 0; mode < 3; ++mode)
+		{
+			uint messagesPerThread = LOGTEST_MESSAGES / numThreads;
+
+			std::atomic<bool> isDone = false;
+			std::atomic<uint64_t> bytesRead = 0;
+			std::thread consumer([&ringBuffer, &isDone, &bytesRead]()
+			{
+				size_t size = 0;
+				uint64_t consumerBytes = 0;
+				while (true)
+				{
+					void* record = ringBuffer.TryLockRead(&size);
+					if (record != nullptr)
+					{
+						consumerBytes += size;
+						ringBuffer.UnlockRead(record);
+					}
+					else if (isDone)
+					{
+						break;
+					}
+				}
+				bytesRead = consumerBytes;
+			});
+
+			double startTime = GetCurrentTimeSeconds();
+
+			std::vector<std::thread> producers;
+			for (uint threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+			{
+				producers.emplace_back([&, threadIndex]()
+				{
+					for (uint messageIndex = 0; messageIndex < messagesPerThread; ++messageIndex)
+					{
+						if (mode == 0)
+						{
+							InlineCallstackTestLogf(ringBuffer, filterID, formatID, threadIndex, 1.5, 2.5);
+						}
+						else
+						{
+							CallstackIDTestLogf(ringBuffer, mode == 2, filterID, formatID, threadIndex, 1.5, 2.5);
+						}
+					}
+				});
+			}
+
+			for (std::thread& producer : producers)
+			{
+				producer.join();
+			}
+
+			isDone = true;
+			consumer.join();
+
+			double elapsed = GetCurrentTimeSeconds() - startTime;
+			uint totalMessages = numThreads * messagesPerThread;
+			DebuggerPrintf("\n Log %-22s %u threads: %.0f messages/s, %.0f bytes per message", modeNames[mode], numThreads, (double)totalMessages / elapsed, (double)bytesRead / (double)totalMessages);
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/Callstack.hpp"
+#include "Engine/Commons/LogFileWriter.hpp"
+#include <stdarg.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint LOG_MAX_STRINGS = 4096;
+constexpr uint LOG_INVALID_STRING = 0;				// what LogInternString hands out once the table is full
+constexpr uint LOG_FORMATTED_STRING = 1;			// "%s", for messages that had to be formatted by the producer
+constexpr uint LOG_MAX_FORMAT_ARGS = 32;			// includes the extra ints a * width or precision reads
+constexpr uint LOG_MAX_ARG_BYTES = 1024;			// a message's arguments are cut off past this
+constexpr uint LOG_MAX_CALLSTACKS = 1024;
+constexpr uint LOG_NO_CALLSTACK = 0;				// also what LogInternCallstack hands out once the table is full
+
+constexpr uint32_t LOG_FILE_MAGIC = 0x474F4C50;		// "PLOG"
+constexpr uint32_t LOG_FILE_VERSION = 2;
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eLogArgType : uint8_t
+{
+	LOG_ARG_INT = 0,		// anything that promotes to int (and long where long is 32 bits)
+	LOG_ARG_INT64,			// long long, size_t, ptrdiff_t, intmax_t (and long where long is 64 bits)
+	LOG_ARG_DOUBLE,
+	LOG_ARG_LONG_DOUBLE,	// read as long double, stored as a double
+	LOG_ARG_POINTER,
+	LOG_ARG_STRING			// copied, stored as a uint16 length and then the characters with their null terminator
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+enum eLogRecordType : uint8_t
+{
+	LOG_RECORD_STRING = 0,	// uint id, uint length, characters. Written the first time a format or filter is used
+	LOG_RECORD_MESSAGE,		// uint64 hpcTime, uint formatID, uint filterID, uint callstackID, uint argSize, args
+	LOG_RECORD_CALLSTACK	// uint id, uint length, characters. Symbolized, written the first time a callstack is used
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct LogFileHeader_T
+{
+	uint32_t		magic = LOG_FILE_MAGIC;
+	uint32_t		version = LOG_FILE_VERSION;
+	double			secondsPerTick = 0.0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The printf signature of a format string, worked out once when it is interned
+struct LogFormat_T
+{
+	char const*		text = nullptr;
+	uint			numArgs = 0;
+	uint8_t			argTypes[LOG_MAX_FORMAT_ARGS] = {};
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Log messages are stored in binary. Format and filter strings are interned once to a 32-bit ID (by content) and a
+// message is just the IDs plus the raw printf arguments. Strings passed as %s are the only thing copied by value. All the
+// formatting happens later on the log thread, or offline with LogDecodeBinaryFile.
+// Looking up a string that is already interned doesn't lock, only adding a new one does. Strings are never removed and the
+// table only holds LOG_MAX_STRINGS, so formats should be literals. Text built at runtime and anything logged once the table
+// is full gets formatted by the producer and stored as a %s argument of LOG_FORMATTED_STRING instead.
+//------------------------------------------------------------------------------------------------------------------------------
+uint				LogInternString(char const* text);
+char const*			LogGetString(uint stringID);
+LogFormat_T const&	LogGetFormat(uint stringID);
+uint				LogGetNumStrings();
+
+//Callstacks are deduplicated the same way, a message only carries the ID of the callstack it was logged with
+uint				LogInternCallstack(void* const* trace, uint depth);
+Callstack const*	LogGetCallstack(uint callstackID);		// nullptr for LOG_NO_CALLSTACK
+uint				LogGetNumCallstacks();
+
+//Packs the arguments a format reads into outArgs, returns the number of bytes used
+uint				LogEncodeArgs(LogFormat_T const& format, va_list args, char* outArgs, uint maxBytes);
+
+//Runs printf on the format with the arguments that were packed by LogEncodeArgs
+void				LogFormatArgs(std::string& outText, char const* format, char const* args, uint argSize);
+
+//Turns a binary log back into the text layout the log used to write. Files can be compressed, each rotated part decodes on its own
+bool				LogDecodeBinary(char const* data, size_t dataSize, std::string& outText);
+bool				LogDecodeBinaryFile(std::string const& binaryFileName, std::string const& textFileName);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Only used from the log thread. Records go to the file writer's batch, every part it rotates to starts with a header and
+// writes out the strings and callstacks it uses again, so each file decodes on its own
+//------------------------------------------------------------------------------------------------------------------------------
+class LogBinaryWriter
+{
+public:
+	void				Begin(LogFileWriter* file);
+	void				RotateIfNeeded();				// only between records
+
+	void				WriteMessage(uint64_t hpcTime, uint formatID, uint filterID, uint callstackID, char const* args, uint argSize);
+	void				WriteCallstack(uint callstackID, std::string const& callstackText);
+	bool				IsCallstackWritten(uint callstackID) const;
+	void				Flush();
+
+private:
+	void				WriteHeader();
+	void				WriteString(uint stringID);
+
+	void				Append(void const* data, size_t size)		{ m_file->Write(data, size); }
+
+private:
+	LogFileWriter*		m_file = nullptr;
+	std::vector<bool>	m_writtenStrings;
+	std::vector<bool>	m_writtenCallstacks;
+};
\ No newline at end of file
@@ -0,0 +1,746 @@
+#include "Engine/Commons/LogFileWriter.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/MemTracking.hpp"
+#include "Engine/Core/Time.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdio.h>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint LOG_LZ_HASH_BITS = 12;
+constexpr uint LOG_LZ_MIN_MATCH = 4;
+constexpr size_t LOG_LZ_MAX_OFFSET = 65535;
+constexpr size_t LOG_LZ_LAST_LITERALS = 5;					// the format wants the block to end on at least this many literals
+constexpr size_t LOG_LZ_MATCH_LIMIT = 12;					// and the last match to start at least this far from the end
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct LogCompressedHeader_T
+{
+	uint32_t		magic = LOG_COMPRESSED_MAGIC;
+	uint32_t		version = LOG_COMPRESSED_VERSION;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Every batch in a compressed file starts with this, storedSize == rawSize means it didn't compress and is stored as is
+struct LogCompressedBlock_T
+{
+	uint32_t		rawSize;
+	uint32_t		storedSize;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+LogFileWriter::LogFileWriter()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+LogFileWriter::~LogFileWriter()
+{
+	Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogFileWriter::Open(LogFileConfig_T const& config)
+{
+	Close();
+
+	m_config = config;
+	if (m_config.batchSize < LOG_FILE_BATCH_ALIGNMENT)
+	{
+		m_config.batchSize = LOG_FILE_BATCH_ALIGNMENT;
+	}
+
+	//Round the batch up to whole pages and start it on a page boundary
+	m_config.batchSize = (m_config.batchSize + LOG_FILE_BATCH_ALIGNMENT - 1) & ~(LOG_FILE_BATCH_ALIGNMENT - 1);
+	m_batchAllocation = UntrackedAlloc(m_config.batchSize + LOG_FILE_BATCH_ALIGNMENT);
+	m_batch = (char*)(((uintptr_t)m_batchAllocation + LOG_FILE_BATCH_ALIGNMENT - 1) & ~(uintptr_t)(LOG_FILE_BATCH_ALIGNMENT - 1));
+	m_batchUsed = 0;
+
+	if (m_config.compress)
+	{
+		m_compressed.resize(sizeof(LogCompressedBlock_T) + LogGetCompressBound(m_config.batchSize));
+	}
+
+	m_partIndex = 0;
+	m_totalBytesIn = 0;
+	m_totalBytesWritten = 0;
+	m_totalBytesDropped = 0;
+	return OpenPart();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::Close()
+{
+	if (m_stream != nullptr)
+	{
+		Flush();
+		m_stream->close();
+		delete m_stream;
+		m_stream = nullptr;
+	}
+
+	if (m_batchAllocation != nullptr)
+	{
+		m_totalBytesDropped += m_batchUsed;
+		UntrackedFree(m_batchAllocation);
+		m_batchAllocation = nullptr;
+		m_batch = nullptr;
+		m_batchUsed = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogFileWriter::OpenPart()
+{
+	std::string fileName = Stringf("%s_%u.bin", m_config.basePath.c_str(), m_partIndex);
+	m_lastOpenTime = GetCurrentTimeSeconds();
+	m_stream = CreateFileWriteBuffer(fileName);
+	if (m_stream == nullptr || !m_stream->is_open())
+	{
+		delete m_stream;
+		m_stream = nullptr;
+		return false;
+	}
+
+	m_fileSize = 0;
+	m_fileOpenTime = m_lastOpenTime;
+	m_lastWriteTime = m_fileOpenTime;
+
+	if (m_config.compress)
+	{
+		LogCompressedHeader_T header;
+		m_stream->write((char const*)&header, sizeof(header));
+		m_fileSize += sizeof(header);
+		m_totalBytesWritten += sizeof(header);
+	}
+
+	std::scoped_lock<std::mutex> lock(m_fileNameLock);
+	m_fileNames.push_back(fileName);
+
+	//Keep the number of files on disk bounded for long runs
+	while (m_config.maxFiles > 0 && m_fileNames.size() > m_config.maxFiles)
+	{
+		remove(m_fileNames.front().c_str());
+		m_fileNames.pop_front();
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::WriteSlow(char const* data, size_t size)
+{
+	while (size > 0)
+	{
+		size_t room = m_config.batchSize - m_batchUsed;
+		size_t copySize = (size < room) ? size : room;
+
+		memcpy(m_batch + m_batchUsed, data, copySize);
+		m_batchUsed += copySize;
+		data += copySize;
+		size -= copySize;
+
+		if (m_batchUsed == m_config.batchSize)
+		{
+			WriteBatch();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::WriteBatch()
+{
+	if (m_batchUsed == 0)
+	{
+		return;
+	}
+
+	//The file couldn't be opened, empty the batch anyway so writers can keep going
+	if (m_stream == nullptr)
+	{
+		m_totalBytesDropped += m_batchUsed;
+		m_batchUsed = 0;
+		return;
+	}
+
+	size_t writeSize = m_batchUsed;
+	if (m_config.compress)
+	{
+		//Each batch is its own block so nothing has to be kept between them
+		LogCompressedBlock_T* block = (LogCompressedBlock_T*)m_compressed.data();
+		char* blockData = m_compressed.data() + sizeof(LogCompressedBlock_T);
+		size_t compressedSize = LogCompressBlock(m_batch, m_batchUsed, blockData, m_compressed.size() - sizeof(LogCompressedBlock_T));
+		if (compressedSize == 0)
+		{
+			memcpy(blockData, m_batch, m_batchUsed);
+			compressedSize = m_batchUsed;
+		}
+
+		block->rawSize = (uint32_t)m_batchUsed;
+		block->storedSize = (uint32_t)compressedSize;
+		writeSize = sizeof(LogCompressedBlock_T) + compressedSize;
+		m_stream->write(m_compressed.data(), writeSize);
+	}
+	else
+	{
+		m_stream->write(m_batch, m_batchUsed);
+	}
+
+	m_totalBytesIn += m_batchUsed;
+	m_totalBytesWritten += writeSize;
+	m_fileSize += writeSize;
+	m_batchUsed = 0;
+	m_lastWriteTime = GetCurrentTimeSeconds();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::Update()
+{
+	if (m_batchUsed > 0 && GetCurrentTimeSeconds() - m_lastWriteTime >= m_config.flushIntervalSeconds)
+	{
+		WriteBatch();
+		if (m_stream != nullptr)
+		{
+			m_stream->flush();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::Flush()
+{
+	WriteBatch();
+	if (m_stream != nullptr)
+	{
+		m_stream->flush();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogFileWriter::ShouldRotate() const
+{
+	//A part that failed to open gets tried again once in a while, as long as we haven't been closed
+	if (m_stream == nullptr)
+	{
+		return m_batch != nullptr && GetCurrentTimeSeconds() - m_lastOpenTime >= m_config.reopenIntervalSeconds;
+	}
+
+	if (m_config.maxFileSize > 0 && GetFileSize() >= m_config.maxFileSize)
+	{
+		return true;
+	}
+
+	return m_config.maxFileAgeSeconds > 0.0 && GetCurrentTimeSeconds() - m_fileOpenTime >= m_config.maxFileAgeSeconds;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::Rotate()
+{
+	//Try the part that failed to open again, it never made it to disk so it keeps its number
+	if (m_stream == nullptr)
+	{
+		if (ShouldRotate())
+		{
+			OpenPart();
+		}
+
+		return;
+	}
+
+	Flush();
+	m_stream->close();
+	delete m_stream;
+	m_stream = nullptr;
+
+	m_partIndex++;
+	OpenPart();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+std::string LogFileWriter::GetFileName() const
+{
+	std::scoped_lock<std::mutex> lock(m_fileNameLock);
+	return m_fileNames.empty() ? std::string() : m_fileNames.back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t LogGetCompressBound(size_t sourceSize)
+{
+	return sourceSize + sourceSize / 255 + 16;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uint32_t ReadSequence(char const* source)
+{
+	uint32_t sequence;
+	memcpy(&sequence, source, sizeof(sequence));
+	return sequence;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static char* WriteLength(char* out, size_t length)
+{
+	while (length >= 255)
+	{
+		*out++ = (char)255;
+		length -= 255;
+	}
+
+	*out++ = (char)length;
+	return out;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// One LZ4 sequence, the literals and then the match. A matchLength of 0 writes only the literals, which ends the block
+static char* WriteSequence(char* out, char const* literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+	size_t matchCode = (matchLength > 0) ? matchLength - LOG_LZ_MIN_MATCH : 0;
+	uint8_t token = (uint8_t)(((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+	*out++ = (char)token;
+
+	if (literalLength >= 15)
+	{
+		out = WriteLength(out, literalLength - 15);
+	}
+
+	memcpy(out, literals, literalLength);
+	out += literalLength;
+
+	if (matchLength == 0)
+	{
+		return out;
+	}
+
+	*out++ = (char)(offset & 0xFF);
+	*out++ = (char)(offset >> 8);
+
+	if (matchCode >= 15)
+	{
+		out = WriteLength(out, matchCode - 15);
+	}
+
+	return out;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t LogCompressBlock(char const* source, size_t sourceSize, char* dest, size_t destCapacity)
+{
+	if (destCapacity < LogGetCompressBound(sourceSize) || sourceSize > UINT32_MAX)
+	{
+		return 0;
+	}
+
+	//Most recent position each 4 byte sequence was seen at
+	uint32_t hashTable[1 << LOG_LZ_HASH_BITS] = {};
+
+	char* out = dest;
+	size_t anchor = 0;
+	size_t position = 1;
+	size_t matchLimit = (sourceSize > LOG_LZ_MATCH_LIMIT) ? sourceSize - LOG_LZ_MATCH_LIMIT : 0;
+
+	while (position < matchLimit)
+	{
+		uint32_t sequence = ReadSequence(source + position);
+		uint32_t hash = (sequence * 2654435761U) >> (32 - LOG_LZ_HASH_BITS);
+		size_t candidate = hashTable[hash];
+		hashTable[hash] = (uint32_t)position;
+
+		if (position - candidate > LOG_LZ_MAX_OFFSET || ReadSequence(source + candidate) != sequence)
+		{
+			//Step further the longer we go without a match so incompressible data doesn't cost much
+			position += 1 + ((position - anchor) >> 6);
+			continue;
+		}
+
+		size_t matchLength = LOG_LZ_MIN_MATCH;
+		size_t maxMatchLength = sourceSize - LOG_LZ_LAST_LITERALS - position;
+		while (matchLength < maxMatchLength && source[candidate + matchLength] == source[position + matchLength])
+		{
+			++matchLength;
+		}
+
+		out = WriteSequence(out, source + anchor, position - anchor, position - candidate, matchLength);
+		position += matchLength;
+		anchor = position;
+	}
+
+	out = WriteSequence(out, source + anchor, sourceSize - anchor, 0, 0);
+
+	size_t compressedSize = out - dest;
+	return (compressedSize < sourceSize) ? compressedSize : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool ReadLength(uint8_t const*& in, uint8_t const* inEnd, size_t& length)
+{
+	uint8_t extra = 255;
+	while (extra == 255)
+	{
+		if (in >= inEnd)
+		{
+			return false;
+		}
+
+		extra = *in++;
+		length += extra;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogDecompressBlock(char const* source, size_t sourceSize, char* dest, size_t destSize)
+{
+	uint8_t const* in = (uint8_t const*)source;
+	uint8_t const* inEnd = in + sourceSize;
+	char* out = dest;
+	char* outEnd = dest + destSize;
+
+	while (in < inEnd)
+	{
+		uint8_t token = *in++;
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !ReadLength(in, inEnd, literalLength))
+		{
+			return false;
+		}
+
+		if ((size_t)(inEnd - in) < literalLength || (size_t)(outEnd - out) < literalLength)
+		{
+			return false;
+		}
+
+		memcpy(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		//The last sequence is only literals
+		if (in == inEnd)
+		{
+			break;
+		}
+
+		if (inEnd - in < 2)
+		{
+			return false;
+		}
+
+		size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+		in += 2;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadLength(in, inEnd, matchLength))
+		{
+			return false;
+		}
+		matchLength += LOG_LZ_MIN_MATCH;
+
+		if (offset == 0 || offset > (size_t)(out - dest) || (size_t)(outEnd - out) < matchLength)
+		{
+			return false;
+		}
+
+		//Matches can overlap what they are writing, so copy a byte at a time
+		char const* match = out - offset;
+		for (size_t byteIndex = 0; byteIndex < matchLength; ++byteIndex)
+		{
+			out[byteIndex] = match[byteIndex];
+		}
+		out += matchLength;
+	}
+
+	return out == outEnd;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogReadFile(std::string const& fileName, std::string& outData)
+{
+	char* fileData = nullptr;
+	unsigned long fileSize = CreateFileReadBuffer(fileName, &fileData);
+	if (fileData == nullptr)
+	{
+		return false;
+	}
+
+	LogCompressedHeader_T header;
+	if (fileSize < sizeof(header) || memcmp(fileData, &header, sizeof(header)) != 0)
+	{
+		//Not compressed
+		outData.assign(fileData, fileSize);
+		delete[] fileData;
+		return true;
+	}
+
+	bool isValid = true;
+	char const* cursor = fileData + sizeof(header);
+	char const* end = fileData + fileSize;
+	while (cursor < end)
+	{
+		LogCompressedBlock_T block;
+		if ((size_t)(end - cursor) < sizeof(block))
+		{
+			isValid = false;
+			break;
+		}
+
+		memcpy(&block, cursor, sizeof(block));
+		cursor += sizeof(block);
+		if ((size_t)(end - cursor) < block.storedSize)
+		{
+			isValid = false;
+			break;
+		}
+
+		size_t oldSize = outData.size();
+		outData.resize(oldSize + block.rawSize);
+		if (block.storedSize == block.rawSize)
+		{
+			memcpy(&outData[oldSize], cursor, block.rawSize);
+		}
+		else if (!LogDecompressBlock(cursor, block.storedSize, &outData[oldSize], block.rawSize))
+		{
+			outData.resize(oldSize);
+			isValid = false;
+			break;
+		}
+
+		cursor += block.storedSize;
+	}
+
+	delete[] fileData;
+	return isValid;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define LOGFILETEST_BLOCK_SIZE (256 * 1024)
+#define LOGFILETEST_TOTAL_BYTES (64 * 1024 * 1024)
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Looks enough like a binary log to compress like one, repeated record layouts with a few changing fields
+static void FillTestLogData(std::string& outData, size_t size, uint seed)
+{
+	outData.clear();
+	uint64_t time = seed;
+	uint random = seed * 2654435761U + 1;
+	while (outData.size() < size)
+	{
+		random = random * 1664525U + 1013904223U;
+		time += random & 0xFFF;
+
+		uint8_t recordType = 1;
+		uint formatID = 3 + (random >> 28);
+		uint filterID = 1 + ((random >> 24) & 3);
+		uint argSize = 12;
+		int frameIndex = (int)(time >> 10);
+		double frameTime = 16.0 + (double)(random & 0xFF) / 256.0;
+
+		outData.append((char const*)&recordType, sizeof(recordType));
+		outData.append((char const*)&time, sizeof(time));
+		outData.append((char const*)&formatID, sizeof(formatID));
+		outData.append((char const*)&filterID, sizeof(filterID));
+		outData.append((char const*)&argSize, sizeof(argSize));
+		outData.append((char const*)&frameIndex, sizeof(frameIndex));
+		outData.append((char const*)&frameTime, sizeof(frameTime));
+	}
+
+	outData.resize(size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool ConfirmCompressRoundTrip(std::string const& source, bool shouldCompress)
+{
+	std::vector<char> compressed(LogGetCompressBound(source.size()));
+	size_t compressedSize = LogCompressBlock(source.data(), source.size(), compressed.data(), compressed.size());
+	if ((compressedSize > 0) != shouldCompress)
+	{
+		return false;
+	}
+
+	if (compressedSize == 0)
+	{
+		return true;
+	}
+
+	std::string decompressed(source.size(), '\0');
+	if (!LogDecompressBlock(compressed.data(), compressedSize, &decompressed[0], decompressed.size()))
+	{
+		return false;
+	}
+
+	//Too small or corrupt output has to fail rather than run off the end
+	std::string tooSmall(source.size() - 1, '\0');
+	compressed[compressedSize / 2] ^= 0x5A;
+	return decompressed == source && !LogDecompressBlock(compressed.data(), compressedSize, &tooSmall[0], tooSmall.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogFileWriter", "Log", 100)
+{
+	std::string logData;
+	FillTestLogData(logData, LOGFILETEST_BLOCK_SIZE, 7);
+	CONFIRM(ConfirmCompressRoundTrip(logData, true));
+	CONFIRM(ConfirmCompressRoundTrip(std::string(100000, 'a'), true));
+	CONFIRM(ConfirmCompressRoundTrip("tiny", false));
+
+	std::string noise(LOGFILETEST_BLOCK_SIZE, '\0');
+	uint random = 12345;
+	for (char& character : noise)
+	{
+		random = random * 1664525U + 1013904223U;
+		character = (char)(random >> 24);
+	}
+	CONFIRM(ConfirmCompressRoundTrip(noise, false));
+
+	//Files rotate on size and only the newest maxFiles stay on disk, compressed or not
+	for (int compressIndex = 0; compressIndex < 2; ++compressIndex)
+	{
+		LogFileConfig_T config;
+		config.basePath = "Data/LogFileWriterTest";
+		config.batchSize = 16 * 1024;
+		config.maxFileSize = 64 * 1024;
+		config.maxFiles = 3;
+		config.compress = (compressIndex == 1);
+
+		LogFileWriter writer;
+		CONFIRM(writer.Open(config));
+		CONFIRM(writer.GetFileName() == "Data/LogFileWriterTest_0.bin");
+
+		//Rotate between 1000 byte records like the log thread does, so each file holds whole records
+		std::vector<std::string> writtenParts(1);
+		FillTestLogData(logData, 1000 * 1000, 3);
+		for (size_t recordStart = 0; recordStart < logData.size(); recordStart += 1000)
+		{
+			if (writer.ShouldRotate())
+			{
+				writer.Rotate();
+				writtenParts.emplace_back();
+			}
+
+			writer.Write(logData.data() + recordStart, 1000);
+			writtenParts.back().append(logData.data() + recordStart, 1000);
+		}
+
+		uint numParts = (uint)writtenParts.size();
+		CONFIRM(numParts > config.maxFiles);
+		CONFIRM(writer.GetFileName() == Stringf("Data/LogFileWriterTest_%u.bin", numParts - 1));
+		writer.Close();
+
+		if (config.compress)
+		{
+			CONFIRM(writer.GetTotalBytesWritten() < writer.GetTotalBytesIn());
+		}
+		else
+		{
+			CONFIRM(writer.GetTotalBytesWritten() == writer.GetTotalBytesIn());
+		}
+
+		for (uint partIndex = 0; partIndex < numParts; ++partIndex)
+		{
+			std::string fileName = Stringf("Data/LogFileWriterTest_%u.bin", partIndex);
+			std::string readBack;
+			bool wasRead = LogReadFile(fileName, readBack);
+			if (partIndex + config.maxFiles < numParts)
+			{
+				CONFIRM(!wasRead);
+				continue;
+			}
+
+			CONFIRM(wasRead && readBack == writtenParts[partIndex]);
+			CONFIRM(config.compress || readBack.size() <= config.maxFileSize + 1000);
+			remove(fileName.c_str());
+		}
+	}
+
+	//A file that can't be opened drops whole batches instead of stalling the writer
+	LogFileConfig_T badConfig;
+	badConfig.basePath = "Data/LogFileWriterTest_NoSuchFolder/LogFileWriterTest";
+	badConfig.batchSize = 16 * 1024;
+	badConfig.reopenIntervalSeconds = 0.25;
+
+	LogFileWriter badWriter;
+	CONFIRM(!badWriter.Open(badConfig));
+	CONFIRM(!badWriter.IsOpen() && badWriter.GetFileName().empty());
+
+	for (size_t recordStart = 0; recordStart + 1000 <= logData.size(); recordStart += 1000)
+	{
+		badWriter.Write(logData.data() + recordStart, 1000);
+	}
+	CONFIRM(badWriter.GetTotalBytesDropped() == logData.size() - logData.size() % badConfig.batchSize);
+
+	CONFIRM(!badWriter.ShouldRotate());
+	badWriter.Rotate();
+	badWriter.Update();
+	badWriter.Flush();
+	CONFIRM(!badWriter.IsOpen());
+	CONFIRM(badWriter.GetTotalBytesDropped() == logData.size());
+	CONFIRM(badWriter.GetTotalBytesWritten() == 0);
+
+	//Once the folder shows up the part is opened again, but not before the retry interval is up
+	std::filesystem::create_directory("Data/LogFileWriterTest_NoSuchFolder");
+	CONFIRM(!badWriter.ShouldRotate());
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	CONFIRM(badWriter.ShouldRotate());
+
+	badWriter.Rotate();
+	CONFIRM(badWriter.IsOpen() && badWriter.GetFileName() == "Data/LogFileWriterTest_NoSuchFolder/LogFileWriterTest_0.bin");
+	badWriter.Write("recovered", 9);
+	badWriter.Close();
+
+	std::string recovered;
+	CONFIRM(LogReadFile("Data/LogFileWriterTest_NoSuchFolder/LogFileWriterTest_0.bin", recovered) && recovered == "recovered");
+	std::filesystem::remove_all("Data/LogFileWriterTest_NoSuchFolder");
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogFileWriterThroughput", "Log", 200)
+{
+	std::string logData;
+	FillTestLogData(logData, LOGFILETEST_BLOCK_SIZE, 11);
+
+	for (int compressIndex = 0; compressIndex < 2; ++compressIndex)
+	{
+		LogFileConfig_T config;
+		config.basePath = "Data/LogFileWriterThroughput";
+		config.compress = (compressIndex == 1);
+		config.maxFiles = 1;
+
+		LogFileWriter writer;
+		writer.Open(config);
+
+		//Record sized writes, the way the binary log writer hands them over
+		double startTime = GetCurrentTimeSeconds();
+		for (size_t totalBytes = 0; totalBytes < LOGFILETEST_TOTAL_BYTES; totalBytes += logData.size())
+		{
+			for (size_t recordStart = 0; recordStart < logData.size(); recordStart += 37)
+			{
+				size_t recordSize = (logData.size() - recordStart < 37) ? logData.size() - recordStart : 37;
+				writer.Write(logData.data() + recordStart, recordSize);
+			}
+
+			if (writer.ShouldRotate())
+			{
+				writer.Rotate();
+			}
+		}
+
+		std::string fileName = writer.GetFileName();
+		writer.Close();
+		double elapsed = GetCurrentTimeSeconds() - startTime;
+		remove(fileName.c_str());
+
+		DebuggerPrintf("\n Log file writer %s: %.0f MB/s, %.1f%% of the input size on disk", config.compress ? "compressed" : "raw",
+			(double)writer.GetTotalBytesIn() / (elapsed * 1024.0 * 1024.0), 100.0 * (double)writer.GetTotalBytesWritten() / (double)writer.GetTotalBytesIn());
+	}
+
+	return true;
+}
\ No newline at end of file
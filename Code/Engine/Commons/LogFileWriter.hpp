@@ -0,0 +1,111 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include <deque>
+#include <iosfwd>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr size_t LOG_FILE_BATCH_ALIGNMENT = 4096;
+constexpr uint32_t LOG_COMPRESSED_MAGIC = 0x5A4C4C50;		// "PLLZ"
+constexpr uint32_t LOG_COMPRESSED_VERSION = 1;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct LogFileConfig_T
+{
+	std::string		basePath;								// directory and name, "_<part>.bin" is added to each file
+	size_t			batchSize = 256 * 1024;					// bytes collected before they are written in one go
+	double			flushIntervalSeconds = 0.5;				// a partly full batch is written after this long
+	size_t			maxFileSize = 64 * 1024 * 1024;			// rotate once a file gets this big, 0 to never rotate on size
+	double			maxFileAgeSeconds = 0.0;				// rotate once a file is this old, 0 to never rotate on age
+	uint			maxFiles = 16;							// the oldest files are deleted past this, 0 to keep all of them
+	bool			compress = false;						// LZ4 block compress each batch
+	double			reopenIntervalSeconds = 1.0;			// how often a part that failed to open is tried again
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Only used from the log thread. Writes are collected in a page aligned batch and only go to the file when the batch
+// is full, when Update finds it has been sitting for flushIntervalSeconds, or on Flush. With compress on, each batch is
+// written as its own LZ4 block so a file can be read back up to the last complete batch even if the process died.
+// Rotate closes the current file and starts the next part, whoever writes to this decides when a record boundary is a
+// good place to do it by checking ShouldRotate. If a file can't be opened, batches are dropped and counted instead, and
+// ShouldRotate asks for a Rotate every reopenIntervalSeconds so the part is tried again.
+//------------------------------------------------------------------------------------------------------------------------------
+class LogFileWriter
+{
+public:
+	LogFileWriter();
+	~LogFileWriter();
+
+	bool				Open(LogFileConfig_T const& config);
+	void				Close();
+	bool				IsOpen() const					{ return m_stream != nullptr; }
+
+	inline void			Write(void const* data, size_t size);
+	void				Update();						// writes the batch if it has waited long enough
+	void				Flush();						// writes the batch and flushes the file
+
+	bool				ShouldRotate() const;
+	void				Rotate();
+
+	std::string			GetFileName() const;			// safe to call from any thread
+	size_t				GetFileSize() const				{ return m_fileSize + m_batchUsed; }
+	uint64_t			GetTotalBytesIn() const			{ return m_totalBytesIn; }
+	uint64_t			GetTotalBytesWritten() const	{ return m_totalBytesWritten; }
+	uint64_t			GetTotalBytesDropped() const	{ return m_totalBytesDropped; }
+
+private:
+	void				WriteSlow(char const* data, size_t size);
+	void				WriteBatch();
+	bool				OpenPart();
+
+private:
+	LogFileConfig_T		m_config;
+	std::ofstream*		m_stream = nullptr;
+
+	void*				m_batchAllocation = nullptr;
+	char*				m_batch = nullptr;
+	size_t				m_batchUsed = 0;
+	std::vector<char>	m_compressed;
+
+	uint				m_partIndex = 0;
+	size_t				m_fileSize = 0;
+	double				m_fileOpenTime = 0.0;
+	double				m_lastWriteTime = 0.0;
+	double				m_lastOpenTime = 0.0;			// last time OpenPart was tried, whether it worked or not
+
+	uint64_t			m_totalBytesIn = 0;
+	uint64_t			m_totalBytesWritten = 0;
+	uint64_t			m_totalBytesDropped = 0;		// batches that had no file to go to
+
+	std::deque<std::string>		m_fileNames;			// every part still on disk, oldest first
+	mutable std::mutex			m_fileNameLock;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFileWriter::Write(void const* data, size_t size)
+{
+	if (m_batchUsed + size <= m_config.batchSize)
+	{
+		memcpy(m_batch + m_batchUsed, data, size);
+		m_batchUsed += size;
+		return;
+	}
+
+	WriteSlow((char const*)data, size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// LZ4 block format. Compress returns 0 if the block didn't get any smaller, Decompress fails unless it fills destSize exactly
+//------------------------------------------------------------------------------------------------------------------------------
+size_t				LogGetCompressBound(size_t sourceSize);
+size_t				LogCompressBlock(char const* source, size_t sourceSize, char* dest, size_t destCapacity);
+bool				LogDecompressBlock(char const* source, size_t sourceSize, char* dest, size_t destSize);
+
+//Reads a file written by LogFileWriter, decompressing it if needed. Returns false past the last complete block
+bool				LogReadFile(std::string const& fileName, std::string& outData);
\ No newline at end of file
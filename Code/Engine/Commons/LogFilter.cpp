@@ -0,0 +1,227 @@
+#include "Engine/Commons/LogFilter.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+LogFilter::LogFilter()
+{
+	LogFilterBits_T* filterBits = new LogFilterBits_T();
+	m_allBits.push_back(filterBits);
+	m_current.store(filterBits, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+LogFilter::~LogFilter()
+{
+	for (LogFilterBits_T* filterBits : m_allBits)
+	{
+		delete filterBits;
+	}
+
+	m_allBits.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+LogFilterBits_T* LogFilter::CopyCurrent()
+{
+	return new LogFilterBits_T(*m_current.load(std::memory_order_relaxed));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFilter::Publish(LogFilterBits_T* filterBits)
+{
+	m_allBits.push_back(filterBits);
+	m_current.store(filterBits, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFilter::EnableAll()
+{
+	std::scoped_lock<std::mutex> lock(m_updateLock);
+	LogFilterBits_T* filterBits = new LogFilterBits_T();
+	filterBits->isDefaultEnabled = true;
+	Publish(filterBits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFilter::DisableAll()
+{
+	std::scoped_lock<std::mutex> lock(m_updateLock);
+	LogFilterBits_T* filterBits = new LogFilterBits_T();
+	filterBits->isDefaultEnabled = false;
+	Publish(filterBits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFilter::Enable(uint filterID)
+{
+	std::scoped_lock<std::mutex> lock(m_updateLock);
+	LogFilterBits_T* filterBits = CopyCurrent();
+
+	//In white list mode the bit means disabled, in black list mode it means enabled
+	uint64_t mask = 1ULL << (filterID & 63);
+	uint64_t& word = filterBits->bits[(filterID >> 6) % LOG_FILTER_WORDS];
+	word = filterBits->isDefaultEnabled ? (word & ~mask) : (word | mask);
+
+	Publish(filterBits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogFilter::Disable(uint filterID)
+{
+	std::scoped_lock<std::mutex> lock(m_updateLock);
+	LogFilterBits_T* filterBits = CopyCurrent();
+
+	uint64_t mask = 1ULL << (filterID & 63);
+	uint64_t& word = filterBits->bits[(filterID >> 6) % LOG_FILTER_WORDS];
+	word = filterBits->isDefaultEnabled ? (word | mask) : (word & ~mask);
+
+	Publish(filterBits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define FILTERTEST_CHECKS 10000000
+#define FILTERTEST_MAX_THREADS 4
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogFilter", "Log", 100)
+{
+	LogFilter filter;
+	uint gameplay = LogInternString("LogFilterTest_Gameplay");
+	uint physics = LogInternString("LogFilterTest_Physics");
+	uint render = LogInternString("LogFilterTest_Render");
+
+	//White list, everything is on until it is disabled
+	CONFIRM(filter.IsEnabled(gameplay) && filter.IsEnabled(physics));
+	filter.Disable(physics);
+	CONFIRM(filter.IsEnabled(gameplay) && !filter.IsEnabled(physics));
+	filter.Enable(physics);
+	CONFIRM(filter.IsEnabled(physics));
+
+	//Black list, everything is off until it is enabled, filters interned afterwards too
+	filter.DisableAll();
+	CONFIRM(!filter.IsEnabled(gameplay) && !filter.IsEnabled(render));
+	filter.Enable(render);
+	CONFIRM(!filter.IsEnabled(gameplay) && filter.IsEnabled(render));
+	CONFIRM(!filter.IsEnabled(LogInternString("LogFilterTest_InternedLater")));
+	filter.Disable(render);
+	CONFIRM(!filter.IsEnabled(render));
+
+	filter.EnableAll();
+	CONFIRM(filter.IsEnabled(gameplay) && filter.IsEnabled(render) && filter.IsEnabled(physics));
+
+	//Readers never see a torn update while the filter is flipped underneath them
+	std::atomic<bool> isDone = false;
+	std::atomic<bool> sawBadState = false;
+	std::thread reader([&]()
+	{
+		while (!isDone)
+		{
+			if (!filter.IsEnabled(gameplay))
+			{
+				sawBadState = true;
+			}
+		}
+	});
+
+	for (uint flipIndex = 0; flipIndex < 1000; ++flipIndex)
+	{
+		filter.Disable(render);
+		filter.Enable(render);
+	}
+
+	isDone = true;
+	reader.join();
+	CONFIRM(!sawBadState);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The check Logf used to do, a std::set of names behind a mutex with a string built for every lookup
+struct LegacyTestFilter_T
+{
+	std::shared_mutex			filterMutex;
+	std::set<std::string>		filterSet;
+	bool						filterMode = true;
+
+	bool IsEnabled(char const* filter)
+	{
+		std::scoped_lock lock(filterMutex);
+		bool isInSet = filterSet.find(filter) != filterSet.end();
+		return filterMode ? !isInSet : isInSet;
+	}
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("LogFilterCheck", "Log", 200)
+{
+	char const* filterName = "LogFilterCheck_Spam";
+	uint filterID = LogInternString(filterName);
+
+	LegacyTestFilter_T legacyFilter;
+	legacyFilter.filterSet.insert(filterName);
+	for (uint filterIndex = 0; filterIndex < 32; ++filterIndex)
+	{
+		legacyFilter.filterSet.insert(Stringf("LogFilterCheck_%u", filterIndex));
+	}
+
+	LogFilter filter;
+	filter.Disable(filterID);
+
+	//Every check is for a disabled filter, the cost of a log call that is filtered out
+	for (uint numThreads = 1; numThreads <= FILTERTEST_MAX_THREADS; numThreads *= 2)
+	{
+		for (uint runIndex = 0; runIndex < 3; ++runIndex)
+		{
+			uint checksPerThread = FILTERTEST_CHECKS / numThreads;
+			std::atomic<uint> numEnabled = 0;
+
+			double startTime = GetCurrentTimeSeconds();
+			std::vector<std::thread> threads;
+			for (uint threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+			{
+				threads.emplace_back([&]()
+				{
+					uint threadEnabled = 0;
+					for (uint checkIndex = 0; checkIndex < checksPerThread; ++checkIndex)
+					{
+						if (runIndex == 0)
+						{
+							threadEnabled += legacyFilter.IsEnabled(filterName) ? 1 : 0;
+						}
+						else if (runIndex == 1)
+						{
+							threadEnabled += filter.IsEnabled(LogInternString(filterName)) ? 1 : 0;
+						}
+						else
+						{
+							threadEnabled += filter.IsEnabled(filterID) ? 1 : 0;
+						}
+					}
+					numEnabled += threadEnabled;
+				});
+			}
+
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+
+			double elapsed = GetCurrentTimeSeconds() - startTime;
+			char const* runNames[3] = { "std::set + mutex", "intern + bitset", "call site ID + bitset" };
+			DebuggerPrintf("\n Log filter %-22s %u threads: %.2f ns per filtered out check %s", runNames[runIndex], numThreads,
+				elapsed * 1000000000.0 / (double)checksPerThread, numEnabled == 0 ? "" : "(WRONG)");
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
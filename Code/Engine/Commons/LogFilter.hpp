@@ -0,0 +1,58 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/LogBinary.hpp"
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint LOG_FILTER_WORDS = LOG_MAX_STRINGS / 64;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A filter is enabled if it isn't in the bits and the default is enabled, or if it is in the bits and the default is disabled.
+// That is the same white list / black list behavior the log always had, including for filters interned after the change.
+struct LogFilterBits_T
+{
+	bool			isDefaultEnabled = true;
+	uint64_t		bits[LOG_FILTER_WORDS] = {};
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Filters are checked by their interned string ID (see LogInternString) against an immutable bitset, so a check is
+// one atomic load and one word test with no lock. Enable and Disable copy the current bitset, change the copy and then
+// swap it in. Old bitsets are kept until the filter is destroyed since a reader might still be looking at one, which is
+// fine since they are small and filters only change from the dev console.
+//------------------------------------------------------------------------------------------------------------------------------
+class LogFilter
+{
+public:
+	LogFilter();
+	~LogFilter();
+
+	inline bool			IsEnabled(uint filterID) const;
+
+	void				EnableAll();
+	void				DisableAll();
+	void				Enable(uint filterID);
+	void				Disable(uint filterID);
+
+private:
+	//Both need m_updateLock held
+	LogFilterBits_T*	CopyCurrent();
+	void				Publish(LogFilterBits_T* filterBits);
+
+private:
+	std::atomic<LogFilterBits_T const*>		m_current;
+
+	std::mutex								m_updateLock;
+	std::vector<LogFilterBits_T*>			m_allBits;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool LogFilter::IsEnabled(uint filterID) const
+{
+	LogFilterBits_T const* filterBits = m_current.load(std::memory_order_acquire);
+	bool isInBits = ((filterBits->bits[(filterID >> 6) % LOG_FILTER_WORDS] >> (filterID & 63)) & 1) != 0;
+	return isInBits != filterBits->isDefaultEnabled;
+}
\ No newline at end of file
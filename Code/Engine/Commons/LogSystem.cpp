@@ -1,9 +1,11 @@
 #include "Engine/Commons/LogSystem.hpp"
+#include "Engine/Commons/StringUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/WindowContext.hpp"
 #include <fstream>
 #include <stdarg.h>
+#include <string.h>
 
 LogSystem* g_LogSystem = nullptr;
 
@@ -25,52 +27,48 @@ static void LogThread()
 	if (g_LogSystem == nullptr)
 		return;
 
-	if (g_LogSystem->m_fileStream == nullptr)
+	if (!g_LogSystem->m_fileWriter.IsOpen())
 	{
-		// See if a file exists, if not create one
-		g_LogSystem->m_fileStream = CreateFileWriteBuffer(g_LogSystem->m_filename);
-		if (g_LogSystem->m_fileStream == nullptr)
+		// Creates the first part of the log, the writer rotates to new parts from there
+		if (!g_LogSystem->m_fileWriter.Open(g_LogSystem->m_fileConfig))
 		{
 			ERROR_AND_DIE("Could not create log file");
 			return;
 		}
 	}
 
-	//Log that we have initialized
-	std::string initString = "Log Initialized";
-	g_LogSystem->m_fileStream->write(initString.c_str(), initString.length());
+	//The decoder prints "Log Initialized" when it reads the header
+	g_LogSystem->m_binaryWriter.Begin(&g_LogSystem->m_fileWriter);
 
 	// wait for information to write to log while running
 	while (g_LogSystem->IsRunning())
 	{
-		// get data to write
-		// potentially a dead-lock; 
+		// get data to write, waking up often enough to write out a partial batch on time
 		g_LogSystem->WaitForWork();
 
 		size_t outSize;
-		LogObject_T *log = (LogObject_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
+		LogEntry_T *log = (LogEntry_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
 		while (log != nullptr)
 		{
 			g_LogSystem->WriteToLogFromBuffer(*log);
-			g_LogSystem->RunAllHooks(log);
 			g_LogSystem->m_messages.UnlockRead(log);
-			log = (LogObject_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
+			log = (LogEntry_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
 		}
+		g_LogSystem->m_fileWriter.Update();
 
 		//Check for log flush
 		if (g_LogSystem->m_flushRequested)
 		{
-			log = (LogObject_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
+			log = (LogEntry_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
 			while (log != nullptr)
 			{
 				g_LogSystem->WriteToLogFromBuffer(*log);
-				g_LogSystem->RunAllHooks(log);
 				g_LogSystem->m_messages.UnlockRead(log);
-				log = (LogObject_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
+				log = (LogEntry_T*)g_LogSystem->m_messages.TryLockRead(&outSize);
 			}
 
 			// flush the file
-			g_LogSystem->m_fileStream->flush();
+			g_LogSystem->m_binaryWriter.Flush();
 
 			g_LogSystem->m_flushRequested = false;
 		}
@@ -78,46 +76,58 @@ static void LogThread()
 	}
 
 	
-	// flush the file
-	g_LogSystem->m_fileStream->flush();
-	// close the file
-	g_LogSystem->m_fileStream->close();
+	// flush and close the file
+	g_LogSystem->m_fileWriter.Close();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void LogSystem::WriteToLogFromBuffer(const LogObject_T& log)
+void LogSystem::WriteToLogFromBuffer(const LogEntry_T& log)
 {
-	bool result = g_LogSystem->m_fileStream->is_open();
+	bool result = g_LogSystem->m_fileWriter.IsOpen();
 	if (!result)
 	{
 		ERROR_AND_DIE("The log file stream was closed but LogThread is trying to write to file");
 	}
 
-	// write it
-	// buffer is the c_str of the message
-	std::string logWriteString("\n\n Log Entry: ");
-	logWriteString += "\n\t Time: ";
-	logWriteString += std::to_string(GetHPCToSeconds(log.hpcTime));
-	logWriteString += "Filter: ";
-	logWriteString += log.filter;
-	logWriteString += "\n\t Message: ";
-	logWriteString += log.line;
-	if (log.callstack.m_depth != 0)
+	//Rotating only happens between entries so every file holds whole records
+	m_binaryWriter.RotateIfNeeded();
+
+	//The packed arguments follow the entry
+	char const* args = (char const*)(&log + 1);
+
+	//Callstacks are deduplicated, so each one is only symbolized the first time it shows up
+	Callstack const* callstack = LogGetCallstack(log.callstackID);
+	if (callstack != nullptr && !m_binaryWriter.IsCallstackWritten(log.callstackID))
 	{
-		logWriteString += "\n\t Callstack: \n\t ";
-		std::vector<std::string> callStackStrings = GetCallstackToString(log.callstack);
+		std::string callstackString;
+		std::vector<std::string> callStackStrings = GetCallstackToString(*callstack);
 		std::vector<std::string>::iterator stringsItr = callStackStrings.begin();
 		while (stringsItr != callStackStrings.end())
 		{
-			logWriteString += stringsItr->c_str();
-			logWriteString += "\n\t ";
+			callstackString += stringsItr->c_str();
+			callstackString += "\n\t ";
 			++stringsItr;
 		}
+
+		m_binaryWriter.WriteCallstack(log.callstackID, callstackString);
 	}
 
-	g_LogSystem->m_fileStream->write(logWriteString.c_str(), logWriteString.length());
+	m_binaryWriter.WriteMessage(log.hpcTime, log.formatID, log.filterID, log.callstackID, args, log.argSize);
+
+	//Only pay for formatting when someone wants the text
+	if (!m_logHooks.empty())
+	{
+		m_formattedLine.clear();
+		LogFormatArgs(m_formattedLine, LogGetString(log.formatID), args, log.argSize);
+
+		LogObject_T logObject;
+		logObject.hpcTime = log.hpcTime;
+		logObject.filter = LogGetString(log.filterID);
+		logObject.line = m_formattedLine.c_str();
+		logObject.callstack = callstack;
 
-	log.~LogObject_T();
+		RunAllHooks(&logObject);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -128,14 +138,15 @@ void LogSystem::LogSystemInit()
 
 	std::string completeFilePath = m_filename;
 
-	//Get system date and time
+	//Get system date and time, the file writer adds the part number and extension
 	std::string systemDateTime = "ExecutionLog" + GetDateTime();
 	completeFilePath += systemDateTime;
-	completeFilePath += ".bin";
 
 	m_filename = completeFilePath;
+	m_fileConfig.basePath = completeFilePath;
 	m_semaphore.Create(0, 1);
-	m_messages.InitializeBuffer(2048);
+	//Room for producers to keep going while the log thread writes out or compresses a batch
+	m_messages.InitializeBuffer(64 * 1024);
 
 	// last thing I do before returning
 	m_thread = std::thread(LogThread);
@@ -165,83 +176,184 @@ void LogSystem::Logf(char const* filter, char const* format, ...)
 		return;
 
 
-	bool canLog = g_LogSystem->CheckAgainstFilter(filter);
+	uint filterID = LogInternString(filter);
+	bool canLog = CheckAgainstFilter(filterID);
 
 	if (canLog == false)
 	{
 		return;
 	}
 
-	//Do this C Sytled
-	size_t logObjSize = sizeof(LogObject_T);
-	
 	va_list args;
 	va_start(args, format);
-	size_t msgLength = vsnprintf(nullptr, 0, format, args) + 1U;
-	//The 1U is added to account for the null termination character
+	uint formatID = LogInternString(format);
+	if (filterID != LOG_INVALID_STRING && formatID != LOG_INVALID_STRING)
+	{
+		LogV(filterID, formatID, false, args);
+	}
+	else
+	{
+		LogFormattedV(filter, filterID, format, false, args);
+	}
+	va_end(args);
+}
 
-	size_t filterLength = strlen(filter) + 1U;
+//------------------------------------------------------------------------------------------------------------------------------
+void LogSystem::LogCallstackf(char const* filter, char const* format, ...)
+{
+	if (g_LogSystem == nullptr)
+		return;
 
-	size_t totalSize = logObjSize + msgLength + filterLength;
-	void* buffer = g_LogSystem->m_messages.LockWrite(totalSize);
 
-	LogObject_T* log = (LogObject_T*)buffer;
-	log->hpcTime = GetCurrentTimeHPC();
-	log->callstack = CallstackGet(2);
-	log->callstack.m_depth = 0;
-	log->line = (char*)buffer + logObjSize;
-	log->filter = (char*)buffer + logObjSize + msgLength;
+	uint filterID = LogInternString(filter);
+	bool canLog = CheckAgainstFilter(filterID);
+
+	if (canLog == false)
+	{
+		return;
+	}
 
-	vsnprintf(log->line, msgLength, format, args);
-	memcpy(log->filter, filter, filterLength);
+	va_list args;
+	va_start(args, format);
+	uint formatID = LogInternString(format);
+	if (filterID != LOG_INVALID_STRING && formatID != LOG_INVALID_STRING)
+	{
+		LogV(filterID, formatID, true, args);
+	}
+	else
+	{
+		LogFormattedV(filter, filterID, format, true, args);
+	}
 	va_end(args);
+}
 
-	m_messages.UnlockWrite(buffer);
+//------------------------------------------------------------------------------------------------------------------------------
+void LogSystem::LogIDf(uint filterID, uint formatID, ...)
+{
+	if (g_LogSystem == nullptr)
+		return;
 
-	SignalWork();
+	bool canLog = CheckAgainstFilter(filterID);
+
+	if (canLog == false)
+	{
+		return;
+	}
+
+	va_list args;
+	va_start(args, formatID);
+	LogV(filterID, formatID, false, args);
+	va_end(args);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void LogSystem::LogCallstackf(char const* filter, char const* format, ...)
+void LogSystem::LogFormattedf(char const* filter, char const* format, ...)
 {
 	if (g_LogSystem == nullptr)
 		return;
 
-
-	bool canLog = g_LogSystem->CheckAgainstFilter(filter);
+	uint filterID = LogInternString(filter);
+	bool canLog = CheckAgainstFilter(filterID);
 
 	if (canLog == false)
 	{
 		return;
 	}
 
-	//Do this C Sytled
-	size_t logObjSize = sizeof(LogObject_T);
-
 	va_list args;
 	va_start(args, format);
-	size_t msgLength = vsnprintf(nullptr, 0, format, args) + 1U;
-	//The 1U is added to account for the null termination character
+	LogFormattedV(filter, filterID, format, false, args);
+	va_end(args);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void LogFormattedText(LogSystem* logSystem, uint filterID, uint captureCallstack, ...)
+{
+	va_list args;
+	va_start(args, captureCallstack);
+	logSystem->LogV(filterID, LOG_FORMATTED_STRING, captureCallstack != 0, args);
+	va_end(args);
+}
 
-	size_t filterLength = strlen(filter) + 1U;
+//------------------------------------------------------------------------------------------------------------------------------
+void LogSystem::LogFormattedV(char const* filter, uint filterID, char const* format, bool captureCallstack, va_list args)
+{
+	//Anything longer would be cut off when it is packed as an argument anyway
+	char text[LOG_MAX_ARG_BYTES];
+	int prefixLength = 0;
+
+	//A filter that didn't get an ID goes in front of the text so it isn't lost
+	if (filterID == LOG_INVALID_STRING)
+	{
+		prefixLength = snprintf(text, sizeof(text), "[%s] ", filter);
+		prefixLength = (prefixLength < 0) ? 0 : ((prefixLength < (int)sizeof(text)) ? prefixLength : (int)sizeof(text) - 1);
+	}
 
-	size_t totalSize = logObjSize + msgLength + filterLength;
-	void* buffer = g_LogSystem->m_messages.LockWrite(totalSize);
+	vsnprintf(text + prefixLength, sizeof(text) - prefixLength, format, args);
+	LogFormattedText(this, filterID, captureCallstack ? 1U : 0U, text);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogSystem::LogV(uint filterID, uint formatID, bool captureCallstack, va_list args)
+{
+	//Pack the arguments on the stack first so the ring buffer is only held for a memcpy
+	char argBuffer[LOG_MAX_ARG_BYTES];
+	uint argSize = LogEncodeArgs(LogGetFormat(formatID), args, argBuffer, LOG_MAX_ARG_BYTES);
+
+	//Only walk the stack when asked to, skipping LogV and the Logf that called it
+	uint callstackID = LOG_NO_CALLSTACK;
+	if (captureCallstack)
+	{
+		void* trace[MAX_TRACE];
+		unsigned long traceHash = 0;
+		uint depth = CallstackCapture(trace, MAX_TRACE, 2, &traceHash);
+		callstackID = LogInternCallstack(trace, depth);
+	}
+
+	size_t totalSize = sizeof(LogEntry_T) + argSize;
+	LogEntry_T* log = (LogEntry_T*)m_messages.LockWrite(totalSize);
+	if (log == nullptr)
+	{
+		return;
+	}
 
-	LogObject_T* log = (LogObject_T*)buffer;
 	log->hpcTime = GetCurrentTimeHPC();
-	log->callstack = CallstackGet(2);
-	log->line = (char*)buffer + logObjSize;
-	log->filter = (char*)buffer + logObjSize + msgLength;
+	log->formatID = formatID;
+	log->filterID = filterID;
+	log->callstackID = callstackID;
+	log->argSize = argSize;
+	memcpy(log + 1, argBuffer, argSize);
 
-	vsnprintf(log->line, msgLength, format, args);
-	memcpy(log->filter, filter, filterLength);
-	va_end(args);
+	m_messages.UnlockWrite(log);
 
-	g_LogSystem->RunAllHooks(log);
-	m_messages.UnlockWrite(buffer);
+	SignalWorkIfIdle();
+}
 
-	SignalWork();
+//------------------------------------------------------------------------------------------------------------------------------
+void LogSystem::WaitForWork()
+{
+	//Producers only signal while the flag is set, so check for a message that came in before they could see it
+	m_isLogThreadIdle.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_messages.IsEmpty())
+	{
+		//Still wakes up often enough to write out a partial batch on time
+		m_semaphore.AcquireFor(m_fileConfig.flushIntervalSeconds);
+	}
+
+	m_isLogThreadIdle.store(false, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void LogSystem::SignalWorkIfIdle()
+{
+	//The log thread drains everything once it is awake, so only the first message after it went idle has to wake it up
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_isLogThreadIdle.load(std::memory_order_relaxed) && m_isLogThreadIdle.exchange(false))
+	{
+		SignalWork();
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -269,34 +381,7 @@ bool LogSystem::CheckAgainstFilter(const char* filterToCheck)
 	if (g_LogSystem == nullptr)
 		return false;
 
-	std::scoped_lock lock(m_filterMutex);
-	if (m_filterMode == true)
-	{
-		//we are in white list mode so we should not write this log if filter exists in set
-		if (m_filterSet.find(filterToCheck) != m_filterSet.end())
-		{
-			//We found this filter in the set so we shouldn't write
-			return false;
-		}
-		else
-		{
-			//We didn't find it in the set so this filter is writable
-			return true;
-		}
-	}
-	else
-	{
-		//we are in black list mode so we should write this log if filter exists in set
-		if (m_filterSet.find(filterToCheck) != m_filterSet.end())
-		{
-			//We found the filter in the set so we should write this message to log
-			return true;
-		}
-		else
-		{
-			return false;
-		}
-	}
+	return m_filter.IsEnabled(LogInternString(filterToCheck));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -305,9 +390,7 @@ void LogSystem::LogEnableAll()
 	if (g_LogSystem == nullptr)
 		return;
 
-	std::scoped_lock lock(m_filterMutex);
-	m_filterMode = true;
-	m_filterSet.clear();
+	m_filter.EnableAll();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -316,9 +399,7 @@ void LogSystem::LogDisableAll()
 	if (g_LogSystem == nullptr)
 		return;
 
-	std::scoped_lock lock(m_filterMutex);
-	m_filterMode = false;
-	m_filterSet.clear();
+	m_filter.DisableAll();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -327,20 +408,7 @@ void LogSystem::LogEnable(char const* filter)
 	if (g_LogSystem == nullptr)
 		return;
 
-	std::scoped_lock lock(m_filterMutex);
-	if (m_filterMode == false)
-	{
-		//We have blacklisted things so enabling a specific filter makes sense
-		m_filterSet.insert(filter);
-	}
-	else
-	{
-		std::set<std::string>::iterator itr = m_filterSet.find(filter);
-		if (itr != m_filterSet.end())
-		{
-			m_filterSet.erase(itr);
-		}
-	}
+	m_filter.Enable(LogInternString(filter));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -349,20 +417,7 @@ void LogSystem::LogDisable(char const* filter)
 	if (g_LogSystem == nullptr)
 		return;
 
-	std::scoped_lock lock(m_filterMutex);
-	if (m_filterMode == true)
-	{
-		//We have white-listed things so disabling a specific filter makes sense
-		m_filterSet.insert(filter);
-	}
-	else
-	{
-		std::set<std::string>::iterator itr = m_filterSet.find(filter);
-		if (itr != m_filterSet.end())
-		{
-			m_filterSet.erase(itr);
-		}
-	}
+	m_filter.Disable(LogInternString(filter));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
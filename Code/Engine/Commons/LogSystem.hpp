@@ -1,19 +1,32 @@
 #pragma once
 #include "Engine/Commons/Callstack.hpp"
+#include "Engine/Commons/LogBinary.hpp"
+#include "Engine/Commons/LogFilter.hpp"
+#include <atomic>
 #include <thread>
 #include "Engine/Core/Async/MPSCAsyncRingBuffer.hpp"
 #include "Engine/Core/Async/Semaphores.hpp"
-#include <set>
-#include <shared_mutex>
 
 
 //------------------------------------------------------------------------------------------------------------------------------
+// What producers put in m_messages, followed by the arguments packed by LogEncodeArgs
+struct LogEntry_T
+{
+	uint64_t			hpcTime;
+	uint				formatID;
+	uint				filterID;
+	uint				callstackID;		// LOG_NO_CALLSTACK unless the message asked for one
+	uint				argSize;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What hooks get, formatted on the log thread
 struct LogObject_T
 {
 	uint64_t			hpcTime;
-	char*				filter;
-	char*				line;
-	Callstack			callstack;
+	char const*			filter;
+	char const*			line;
+	Callstack const*	callstack;			// nullptr unless the message asked for one
 };
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -29,22 +42,34 @@ public:
 	MPSCRingBuffer		m_messages;
 	Semaphore			m_semaphore;
 
-	std::ofstream*		m_fileStream = nullptr;
+	LogFileConfig_T		m_fileConfig;			// batching, rotation and compression, change before LogSystemInit
+	LogFileWriter		m_fileWriter;
+	LogBinaryWriter		m_binaryWriter;
+	std::string			m_formattedLine;
 
 	bool				m_isRunning = true;
+	std::atomic<bool>	m_isLogThreadIdle = false;		// set while the log thread waits, producers only signal then
 
 	void				LogSystemInit();
 	void				LogSystemShutDown();
-	void				WriteToLogFromBuffer(const LogObject_T& log);
+	void				WriteToLogFromBuffer(const LogEntry_T& log);
 
+	// Messages are stored binary, see LogBinary.hpp. The log thread only formats them when there are hooks,
+	// the .bin file is turned into text with LogDecodeBinaryFile
 	void				Logf(char const* filter, char const* format, ...);
 	void				LogCallstackf(char const* filter, char const* format, ...);
+	void				LogIDf(uint filterID, uint formatID, ...);		// for call sites that intern their strings once
+	void				LogFormattedf(char const* filter, char const* format, ...);	// for formats built at runtime, never interned
+	void				LogV(uint filterID, uint formatID, bool captureCallstack, va_list args);
+	void				LogFormattedV(char const* filter, uint filterID, char const* format, bool captureCallstack, va_list args);
 
 	void				RunAllHooks(const LogObject_T* logObj);
-	void				WaitForWork()			{ m_semaphore.Acquire(); }
+	void				WaitForWork();
 	void				SignalWork()			{ m_semaphore.Release(1); }
+	void				SignalWorkIfIdle();
 
 	bool				CheckAgainstFilter(const char* filterToCheck);
+	bool				CheckAgainstFilter(uint filterID) const		{ return m_filter.IsEnabled(filterID); }
 
 	// Filtering
 	void				LogEnableAll();  // all messages log
@@ -72,7 +97,28 @@ public:
 
 	std::vector<LogHookCallback>	m_logHooks;
 
-	std::shared_mutex		m_filterMutex;
-	std::set<std::string>	m_filterSet;
-	bool					m_filterMode = true;	//If true, white-list(Enabled) all and ignore filters in the set, if false blacklist(Disable) all and only allow elements in the set
-};
\ No newline at end of file
+	LogFilter				m_filter;
+};
+
+extern LogSystem* g_LogSystem;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Interns the filter and format once per call site, so a message that is filtered out only costs a bitset check
+//------------------------------------------------------------------------------------------------------------------------------
+#define LOGF( filter, format, ... )																						\
+	do																													\
+	{																													\
+		static uint const __logFilterID = LogInternString(filter);														\
+		static uint const __logFormatID = LogInternString(format);														\
+		if (g_LogSystem != nullptr && g_LogSystem->CheckAgainstFilter(__logFilterID))									\
+		{																												\
+			if (__logFilterID != LOG_INVALID_STRING && __logFormatID != LOG_INVALID_STRING)								\
+			{																											\
+				g_LogSystem->LogIDf(__logFilterID, __logFormatID, ##__VA_ARGS__);										\
+			}																											\
+			else																										\
+			{																											\
+				g_LogSystem->Logf(filter, format, ##__VA_ARGS__);														\
+			}																											\
+		}																												\
+	} while (0)
\ No newline at end of file
@@ -1,10 +1,11 @@
 #include "Engine/Commons/Profiler/Profiler.hpp"
 //------------------------------------------------------------------------------------------------------------------------------
-#include "Engine/Allocators/BlockAllocator.hpp"
-#include "Engine/Allocators/InternalAllocator.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/Profiler/ProfilerEventBuffer.hpp"
 #include "Engine/Commons/Profiler/ProfilerReport.hpp"
+#include "Engine/Commons/Profiler/ProfilerTraceExport.hpp"
 #include "Engine/Core/MemTracking.hpp"
+#include "Engine/Core/NamedProperties.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Renderer/ImGUISystem.hpp"
 #include "Engine/Core/WindowContext.hpp"
@@ -17,31 +18,72 @@
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#include <algorithm>
+#include <sstream>
 
 Profiler* gProfiler = nullptr;
 
 //------------------------------------------------------------------------------------------------------------------------------
-//Used by Profiler to store nodes with respect to each thread
-static thread_local ProfilerSample_T*	tActiveNode = nullptr;
-thread_local int tProfilerDepth = 0;
+//Each thread's event buffer, only valid while tEventBufferProfilerId matches the profiler that created it
+static thread_local ProfilerEventBuffer*	tEventBuffer = nullptr;
+static thread_local uint64_t				tEventBufferProfilerId = 0;
+static std::atomic<uint64_t>				gNextProfilerId = 1;
 
 #if defined(PROFILING_ENABLED)
 //------------------------------------------------------------------------------------------------------------------------------
-Profiler::Profiler()
+// Only constructed on threads that registered an event buffer, hands the buffer back as the thread exits
+struct ThreadEventBufferRetirer_T
 {
+	~ThreadEventBufferRetirer_T();
+
+	bool	m_isRegistered = false;
+};
 
+static thread_local ThreadEventBufferRetirer_T tEventBufferRetirer;
+
+//------------------------------------------------------------------------------------------------------------------------------
+ThreadEventBufferRetirer_T::~ThreadEventBufferRetirer_T()
+{
+	//Only if the profiler that gave us the buffer is still the live one, otherwise it already deleted the buffer
+	if (m_isRegistered && tEventBuffer != nullptr && gProfiler != nullptr && gProfiler->m_profilerId == tEventBufferProfilerId)
+	{
+		gProfiler->RetireThreadEventBuffer(tEventBuffer);
+	}
+
+	tEventBuffer = nullptr;
+	tEventBufferProfilerId = 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------
+Profiler::Profiler()
+{
+	m_profilerId = gNextProfilerId++;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 Profiler::~Profiler()
 {
+	ProfilerStopCapture();
 
+	std::scoped_lock<std::mutex> lock(m_eventBuffersLock);
+	for (ProfilerEventBuffer* buffer : m_eventBuffers)
+	{
+		delete buffer;
+	}
+	m_eventBuffers.clear();
+
+	for (ProfilerEventBuffer* buffer : m_retiredEventBuffers)
+	{
+		delete buffer;
+	}
+	m_retiredEventBuffers.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 bool Profiler::ProfilerInitialize()
 {
 	g_eventSystem->SubscribeEventCallBackFn("ProfilerReport", Command_ProfilerReport);
+	g_eventSystem->SubscribeEventCallBackFn("ProfilerExport", Command_ProfilerExport);
+	g_eventSystem->SubscribeEventCallBackFn("ProfilerHitch", Command_ProfilerHitch);
 
 	Profiler* profiler = CreateInstance();
 	profiler->ProfilerAllocation(profiler->m_AllowedSize);
@@ -79,90 +121,99 @@ void Profiler::ProfilerResume()
 //------------------------------------------------------------------------------------------------------------------------------
 void Profiler::ProfilerTogglePause()
 {
-	if (m_isPaused)
-	{
-		m_isPaused = false;
-	}
-	else
+	bool isPaused = m_isPaused.load();
+	while (!m_isPaused.compare_exchange_weak(isPaused, !isPaused))
 	{
-		m_isPaused = true;
 	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Profiler::ProfilerPush(const char* label)
 {
-	ProfilerSample_T* newNode = AllocateNode();
+	ProfilerPush(ProfilerInternLabel(label));
+}
 
-	newNode->m_parent = tActiveNode;
-	newNode->m_lastChild = nullptr;
-	newNode->m_prevSibling = nullptr;
+//------------------------------------------------------------------------------------------------------------------------------
+void Profiler::ProfilerPush(uint labelID)
+{
+	//A tree started while paused is skipped whole, scopes inside an open tree are still recorded
+	GetThreadEventBuffer()->PushBegin(labelID, m_isPaused);
+}
 
-	newNode->m_threadID = std::this_thread::get_id();
+//------------------------------------------------------------------------------------------------------------------------------
+void Profiler::ProfilerPop()
+{
+	GetThreadEventBuffer()->PushEnd();
+}
 
-	// setup now
-	newNode->m_startTime = GetCurrentTimeHPC();
-	strcpy_s(newNode->m_label, label);
+//------------------------------------------------------------------------------------------------------------------------------
+void Profiler::ProfilerUpdate()
+{
+	if (gProfiler == nullptr)
+		return;
 
-	if (tActiveNode != nullptr) 
-	{
-		tActiveNode->AddChild(newNode);
-	}
-	else
+	//Show the profiler window if we have report enabled
+	if (m_showTimeline)
 	{
-		if (!m_isPaused && tProfilerDepth == 0)
-		{
-			tActiveNode = newNode;
-		}
+		ShowProfilerTimeline();
 	}
 
-	// this is now my active node
-	tActiveNode = newNode;
-
-	++tProfilerDepth;
+	ProfilerCollect();
+	EraseOldTrees();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Profiler::ProfilerPop()
+void Profiler::ProfilerCollect()
 {
-	ASSERT_RECOVERABLE((tProfilerDepth > 0), "The Profiler depth is lesser than or equal to 0");
-	--tProfilerDepth;
+	std::vector<ProfilerTree_T*> finishedTrees;
 
-	if (tActiveNode == nullptr) 
 	{
-		return;
+		std::scoped_lock<std::mutex> lock(m_eventBuffersLock);
+		for (ProfilerEventBuffer* buffer : m_eventBuffers)
+		{
+			buffer->CollectTrees(finishedTrees);
+		}
+
+		//Their threads are gone so nothing more can be written, take what is left and let them go
+		for (ProfilerEventBuffer* buffer : m_retiredEventBuffers)
+		{
+			buffer->CollectTrees(finishedTrees);
+			delete buffer;
+		}
+		m_retiredEventBuffers.clear();
 	}
 
-	// finalize
-	tActiveNode->m_endTime = GetCurrentTimeHPC();
-	tActiveNode->m_allocCount = (int)tTotalAllocations - tActiveNode->m_allocCount;
-	tActiveNode->m_allocationSizeInBytes = tTotalBytesAllocated - tActiveNode->m_allocationSizeInBytes;
-	tActiveNode->m_freeCount = (int)tTotalFrees - tActiveNode->m_freeCount;
-	tActiveNode->m_freeSizeInBytes = tTotalBytesFreed - tActiveNode->m_freeSizeInBytes;
+	//Keep the history in the order frames finished across all threads
+	std::sort(finishedTrees.begin(), finishedTrees.end(), [](ProfilerTree_T* a, ProfilerTree_T* b) { return a->GetEndTime() < b->GetEndTime(); });
 
-	//Setup where we are now after poping the active node
-	ProfilerSample_T* oldActive = tActiveNode;
-	tActiveNode = tActiveNode->m_parent;
-	if (tActiveNode == nullptr) 
+	if (m_captureWriter != nullptr)
 	{
-		std::scoped_lock<std::shared_mutex> lock(m_HistoryLock);
-		m_History.push_back(oldActive);
+		for (ProfilerTree_T* tree : finishedTrees)
+		{
+			m_captureWriter->WriteTree(tree);
+		}
+
+		if (GetCurrentTimeSeconds() >= m_captureEndTime)
+		{
+			ProfilerStopCapture();
+		}
 	}
-}
 
-//------------------------------------------------------------------------------------------------------------------------------
-void Profiler::ProfilerUpdate()
-{
-	if (gProfiler == nullptr)
-		return;
+	size_t finishedSize = 0;
+	for (ProfilerTree_T* tree : finishedTrees)
+	{
+		m_aggregate.AddTree(tree);
+		finishedSize += tree->GetByteSize();
+	}
 
-	//Show the profiler window if we have report enabled
-	if (m_showTimeline)
+	if (finishedTrees.size() > 0)
 	{
-		ShowProfilerTimeline();
+		std::scoped_lock<std::shared_mutex> lock(m_HistoryLock);
+		m_History.insert(m_History.end(), finishedTrees.begin(), finishedTrees.end());
+		m_HistorySize += finishedSize;
 	}
 
-	EraseOldTrees();
+	DumpPendingHitches();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -208,12 +259,13 @@ void Profiler::ShowProfilerTimeline()
 //------------------------------------------------------------------------------------------------------------------------------
 void Profiler::PopulateGraphData(float* floatArray, float* allocArray, int& timeArraySize, int& allocArraySize, float& maxTime, float& maxAlloc)
 {
-	std::vector<ProfilerSample_T*>::iterator itr = m_History.begin();
+	std::vector<ProfilerTree_T*>::iterator itr = m_History.begin();
 
 	while (itr != m_History.end())
 	{
-		*floatArray = (float)(GetHPCToSeconds((*itr)->m_endTime) - GetHPCToSeconds((*itr)->m_startTime));
-		*allocArray = (float)(*itr)->m_allocCount - (float)(*itr)->m_freeCount;
+		ProfilerSample_T const& root = (*itr)->GetRoot();
+		*floatArray = (float)GetHPCToSeconds(root.m_duration);
+		*allocArray = (float)root.m_allocCount - (float)root.m_freeCount;
 
 		if (maxTime < *floatArray)
 		{
@@ -269,6 +321,10 @@ void Profiler::MakeTimelineWindow()
 		{
 			reporter->DrawFlatViewAsImGUIWidget((uint)m_reportFrameNum);
 		}
+		else if (reporter->GetMode() == AGGREGATE_VIEW)
+		{
+			reporter->DrawAggregateViewAsImGUIWidget();
+		}
 		else
 		{
 			reporter->DrawTreeViewAsImGUIWidget((uint)m_reportFrameNum);
@@ -327,12 +383,15 @@ void Profiler::EraseOldTrees()
 	while (index < m_History.size())
 	{
 		double currentTime = GetHPCToSeconds(GetCurrentTimeHPC());
-		double sampleTime = GetHPCToSeconds(m_History[index]->m_endTime);
+		double sampleTime = GetHPCToSeconds(m_History[index]->GetEndTime());
 
-		if (sampleTime < currentTime - m_maxHistoryTime)
+		//Past the memory budget the oldest trees go even if they are still inside the history time
+		if (sampleTime < currentTime - m_maxHistoryTime || m_HistorySize > m_AllowedSize)
 		{
-			ProfilerSample_T* sample = m_History[index];
-			ProfilerReleaseTree(sample);
+			ProfilerTree_T* tree = m_History[index];
+			m_HistorySize -= tree->GetByteSize();
+			m_aggregate.RemoveTree(tree);
+			ProfilerReleaseTree(tree);
 			m_History.erase(m_History.begin() + index);
 			index--;
 		}
@@ -344,23 +403,34 @@ void Profiler::EraseOldTrees()
 //------------------------------------------------------------------------------------------------------------------------------
 void Profiler::ProfilerAllocation(size_t byteSize /*= 0*/)
 {
-	BlockAllocator* blockAllocator = gBlockAllocator->GetInstance();
-	void* buffer = UntrackedAlloc(byteSize);
-	blockAllocator->Initialize(buffer, byteSize, sizeof(ProfilerSample_T), alignof(ProfilerSample_T));
+	//Trees are allocated as they finish, this only sets how much of them the history can hold
+	if (byteSize > 0)
+	{
+		m_AllowedSize = byteSize;
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Profiler::ProfilerFree()
 {
-	BlockAllocator* blockAllocator = gBlockAllocator->GetInstance();
-	blockAllocator->Deinitialize();
+	std::scoped_lock<std::shared_mutex> historyLock(m_HistoryLock);
+
+	for (ProfilerTree_T* tree : m_History)
+	{
+		m_aggregate.RemoveTree(tree);
+		ProfilerReleaseTree(tree);
+	}
+
+	m_History.clear();
+	m_HistorySize = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void Profiler::ProfilerBeginFrame(const char* label /*= "Frame"*/)
 {
-	ASSERT_RECOVERABLE(tActiveNode == nullptr, "The active node was nullptr in ProfilerBeginFrame");
+	ASSERT_RECOVERABLE(GetThreadEventBuffer()->GetDepth() == 0, "There were open scopes in ProfilerBeginFrame");
 
+	m_frameStartTime = GetCurrentTimeHPC();
 	ProfilerPush(label);
 }
 
@@ -369,7 +439,26 @@ void Profiler::ProfilerEndFrame()
 {
 	ProfilerPop();
 
-	ASSERT_RECOVERABLE(tActiveNode == nullptr, "The active node was nullptr in ProfilerEndFrame")
+	ASSERT_RECOVERABLE(GetThreadEventBuffer()->GetDepth() == 0, "There were open scopes in ProfilerEndFrame")
+
+	//The frame's tree wraps this time, so the hitch knows which tree is the hitch once it is collected
+	bool isHitch = m_hitchDetector.AddFrame(m_frameStartTime, GetCurrentTimeHPC(), std::this_thread::get_id());
+
+	//Frames started while paused were never recorded, nothing to dump
+	if (!isHitch || m_isPaused)
+	{
+		return;
+	}
+
+	{
+		std::scoped_lock<std::mutex> lock(m_pendingHitchesLock);
+		m_pendingHitches.push_back(m_hitchDetector.GetLastHitch());
+	}
+
+	if (m_pauseOnHitch)
+	{
+		ProfilerPause();
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -386,13 +475,118 @@ bool Profiler::IsProfilerOpen()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-ProfilerSample_T* Profiler::ProfilerAcquirePreviousTree(std::thread::id id, uint history /*= 0*/)
+bool Profiler::ProfilerExportHistory(std::string const& fileName)
+{
+	ProfilerTraceWriter writer;
+	if (!writer.Open(fileName))
+	{
+		return false;
+	}
+
+	std::shared_lock<std::shared_mutex> historyLock(m_HistoryLock);
+	for (ProfilerTree_T* tree : m_History)
+	{
+		writer.WriteTree(tree);
+	}
+
+	writer.Close();
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Profiler::ProfilerExportHitch(ProfilerHitch_T const& hitch, std::string const& fileName)
+{
+	//Hold on to the trees so EraseOldTrees can't free them while we write
+	std::vector<ProfilerTree_T*> trees;
+	ProfilerTree_T* hitchTree = nullptr;
+	{
+		std::shared_lock<std::shared_mutex> historyLock(m_HistoryLock);
+		for (ProfilerTree_T* tree : m_History)
+		{
+			if (tree->GetEndTime() < hitch.m_windowStartTime || tree->m_startTime > hitch.m_endTime)
+			{
+				continue;
+			}
+
+			++tree->m_refCount;
+			trees.push_back(tree);
+
+			if (tree->m_threadID == hitch.m_threadID && tree->m_startTime >= hitch.m_startTime && tree->GetEndTime() <= hitch.m_endTime)
+			{
+				hitchTree = tree;
+			}
+		}
+	}
+
+	ProfilerTraceWriter writer;
+	bool isWritten = (hitchTree != nullptr && writer.Open(fileName));
+	if (isWritten)
+	{
+		for (ProfilerTree_T* tree : trees)
+		{
+			writer.WriteTree(tree);
+		}
+
+		//The hitch record goes on the hitch thread's track with the frame's memory deltas
+		std::ostringstream threadIDStream;
+		threadIDStream << hitch.m_threadID;
+
+		ProfilerSample_T const& frame = hitchTree->GetRoot();
+		std::string args = Stringf("\"frame\":%llu,\"thread\":\"%s\",\"frameMs\":%.3f,\"meanMs\":%.3f,\"stdDevMs\":%.3f,\"budgetMs\":%.3f,\"overBudget\":%s,\"overSigma\":%s,"
+			"\"allocCount\":%u,\"allocBytes\":%u,\"freeCount\":%u,\"freeBytes\":%u",
+			hitch.m_frameIndex, threadIDStream.str().c_str(), hitch.m_frameSeconds * 1000.0, hitch.m_meanSeconds * 1000.0, hitch.m_stdDevSeconds * 1000.0,
+			m_hitchDetector.GetBudget() * 1000.0, hitch.m_isOverBudget ? "true" : "false", hitch.m_isOverSigma ? "true" : "false",
+			frame.m_allocCount, frame.m_allocationSizeInBytes, frame.m_freeCount, frame.m_freeSizeInBytes);
+		writer.WriteInstantEvent("Hitch", hitchTree->m_startTime, hitch.m_threadID, args);
+		writer.Close();
+	}
+
+	for (ProfilerTree_T* tree : trees)
+	{
+		ProfilerReleaseTree(tree);
+	}
+
+	return isWritten;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool Profiler::ProfilerStartCapture(std::string const& fileName, double seconds)
+{
+	ProfilerStopCapture();
+
+	m_captureWriter = new ProfilerTraceWriter();
+	if (!m_captureWriter->Open(fileName))
+	{
+		delete m_captureWriter;
+		m_captureWriter = nullptr;
+		return false;
+	}
+
+	m_captureEndTime = GetCurrentTimeSeconds() + seconds;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Profiler::ProfilerStopCapture()
+{
+	if (m_captureWriter == nullptr)
+	{
+		return;
+	}
+
+	m_captureWriter->Close();
+	delete m_captureWriter;
+	m_captureWriter = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfilerTree_T* Profiler::ProfilerAcquirePreviousTree(std::thread::id id, uint history /*= 0*/)
 {
 	std::scoped_lock<std::shared_mutex> historyLock(m_HistoryLock);
 	//Go back in the vector by "history" frames and acquire frame tree with threadID = id
 	uint indexForThread = 0;
 
-	std::vector<ProfilerSample_T*>::iterator itr = m_History.end();
+	std::vector<ProfilerTree_T*>::iterator itr = m_History.end();
 	itr--;
 
 	while (indexForThread != history || itr != m_History.begin())
@@ -407,6 +601,7 @@ ProfilerSample_T* Profiler::ProfilerAcquirePreviousTree(std::thread::id id, uint
 
 	if (indexForThread == history)
 	{
+		++m_History[indexForThread]->m_refCount;
 		return m_History[indexForThread];
 	}
 	else
@@ -417,13 +612,14 @@ ProfilerSample_T* Profiler::ProfilerAcquirePreviousTree(std::thread::id id, uint
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-ProfilerSample_T* Profiler::ProfilerAcquirePreviousTreeForCallingThread(uint history /*= 0*/)
+ProfilerTree_T* Profiler::ProfilerAcquirePreviousTreeForCallingThread(uint history /*= 0*/)
 {
 	std::scoped_lock<std::shared_mutex> historyLock(m_HistoryLock);
 
-	if (history > 0)
+	if (history > 0 && history < m_History.size())
 	{
-		//Frame exists
+		//Frame exists, keep it alive until the caller releases it even if it leaves the history
+		++m_History[history]->m_refCount;
 		return m_History[history];
 	}
 	else
@@ -435,14 +631,11 @@ ProfilerSample_T* Profiler::ProfilerAcquirePreviousTreeForCallingThread(uint his
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Profiler::ProfilerReleaseTree(ProfilerSample_T* node)
+void Profiler::ProfilerReleaseTree(ProfilerTree_T* tree)
 {
-	//Atomic decrement operation provided by windows for thread safe decrement
-	uint newCount = ::InterlockedDecrement(&node->m_refCount);
-
-	if (newCount == 0)
+	if (--tree->m_refCount == 0)
 	{
-		FreeTree(node);
+		ProfilerTree_T::Destroy(tree);
 	}
 }
 
@@ -479,73 +672,74 @@ STATIC Profiler* Profiler::GetInstance()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Profiler::FreeTree(ProfilerSample_T* root)
+ProfilerEventBuffer* Profiler::GetThreadEventBuffer()
 {
-	//Free all children and then free the root
-	ProfilerSample_T* node = nullptr;
-	ProfilerSample_T* next = nullptr;
-
-	node = root;
-	while (node != nullptr)
+	if (tEventBufferProfilerId == m_profilerId)
 	{
-		if (node->m_lastChild != nullptr)
-		{
-			next = node->m_lastChild;
-			//FreeNode(next);
-			node->m_lastChild = nullptr;
-		}
-		else
-		{
-			if (node->m_prevSibling != nullptr)
-			{
-				next = node->m_prevSibling;
-				FreeNode(node);
-			}
-			else
-			{
-				next = node->m_parent;
-				FreeNode(node);
-			}
-		}
-		node = next;
+		return tEventBuffer;
 	}
+
+	return RegisterThreadEventBuffer();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-ProfilerSample_T* Profiler::AllocateNode()
+ProfilerEventBuffer* Profiler::RegisterThreadEventBuffer()
 {
-	BlockAllocator* instance = gBlockAllocator->GetInstance();
-	ProfilerSample_T* node = (ProfilerSample_T*)instance->Allocate(sizeof(ProfilerSample_T));
+	ProfilerEventBuffer* buffer = new ProfilerEventBuffer();
 
-	if (node != nullptr)
 	{
-		node->m_allocationSizeInBytes = tTotalBytesAllocated;
-		node->m_allocCount = (int)tTotalAllocations;
-		
-		node->m_freeCount = (int)tTotalFrees;
-		node->m_freeSizeInBytes = tTotalBytesFreed;
-
-		node->m_refCount = 1;
+		std::scoped_lock<std::mutex> lock(m_eventBuffersLock);
+		m_eventBuffers.push_back(buffer);
 	}
 
-	ASSERT_RECOVERABLE(node != nullptr, "Ran out of memory blocks on gBlockAllocator");
+	tEventBuffer = buffer;
+	tEventBufferProfilerId = m_profilerId;
+	tEventBufferRetirer.m_isRegistered = true;
+	return buffer;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void Profiler::RetireThreadEventBuffer(ProfilerEventBuffer* buffer)
+{
+	std::scoped_lock<std::mutex> lock(m_eventBuffersLock);
 
-	return node;
+	std::vector<ProfilerEventBuffer*>::iterator bufferIterator = std::find(m_eventBuffers.begin(), m_eventBuffers.end(), buffer);
+	if (bufferIterator != m_eventBuffers.end())
+	{
+		m_eventBuffers.erase(bufferIterator);
+		m_retiredEventBuffers.push_back(buffer);
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void Profiler::FreeNode(ProfilerSample_T* node)
+void Profiler::DumpPendingHitches()
 {
-	node->m_allocationSizeInBytes = tTotalBytesAllocated - node->m_allocationSizeInBytes;
-	node->m_allocCount = (int)tTotalAllocations - node->m_allocCount;
+	std::vector<ProfilerHitch_T> hitches;
+	{
+		std::scoped_lock<std::mutex> lock(m_pendingHitchesLock);
+		hitches.swap(m_pendingHitches);
+	}
+
+	for (ProfilerHitch_T const& hitch : hitches)
+	{
+		if (m_numHitchDumps >= m_maxHitchDumps)
+		{
+			continue;
+		}
 
-	node->m_freeCount = (int)tTotalFrees - node->m_freeCount;
-	node->m_freeSizeInBytes = tTotalBytesFreed - node->m_freeSizeInBytes;
+		std::string fileName = Stringf("ProfilerHitch_%llu.json", hitch.m_frameIndex);
+		if (!ProfilerExportHitch(hitch, fileName))
+		{
+			g_devConsole->PrintString(DevConsole::CONSOLE_ERROR, Stringf("Could not write the hitch in frame %llu to %s", hitch.m_frameIndex, fileName.c_str()));
+			continue;
+		}
 
-	BlockAllocator* instance = gBlockAllocator->GetInstance();
-	instance->Free(node);
+		++m_numHitchDumps;
+		g_devConsole->PrintString(DevConsole::CONSOLE_INFO, Stringf("Frame %llu took %.3f ms (mean %.3f ms), written to %s", hitch.m_frameIndex, hitch.m_frameSeconds * 1000.0, hitch.m_meanSeconds * 1000.0, fileName.c_str()));
+	}
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
 void Profiler::RepopulateReportData()
 {
 	//repopulate variables for imGUI
@@ -579,6 +773,59 @@ STATIC bool Profiler::Command_ProfilerReport(EventArgs& args)
 	return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Profiler::Command_ProfilerExport(EventArgs& args)
+{
+	std::string fileName = "Profile.json";
+	fileName = args.GetValue("File", fileName);
+	float seconds = args.GetValue("Seconds", 0.f);
+
+	//No time means write out what is in the history now
+	if (seconds <= 0.f)
+	{
+		if (!gProfiler->ProfilerExportHistory(fileName))
+		{
+			g_devConsole->PrintString(DevConsole::CONSOLE_ERROR, Stringf("Could not open %s for the profiler export", fileName.c_str()));
+			return false;
+		}
+
+		g_devConsole->PrintString(DevConsole::CONSOLE_INFO, Stringf("Profiler history written to %s", fileName.c_str()));
+		return true;
+	}
+
+	if (!gProfiler->ProfilerStartCapture(fileName, (double)seconds))
+	{
+		g_devConsole->PrintString(DevConsole::CONSOLE_ERROR, Stringf("Could not open %s for the profiler capture", fileName.c_str()));
+		return false;
+	}
+
+	g_devConsole->PrintString(DevConsole::CONSOLE_INFO, Stringf("Capturing profiler trees to %s for %.1f seconds", fileName.c_str(), seconds));
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool Profiler::Command_ProfilerHitch(EventArgs& args)
+{
+	//Anything not passed keeps its current value, so the command on its own just prints the summary
+	ProfilerHitchDetector& detector = gProfiler->m_hitchDetector;
+	float budgetMilliseconds = args.GetValue("Budget", (float)(detector.GetBudget() * 1000.0));
+	float sigma = args.GetValue("Sigma", (float)detector.GetSigmaThreshold());
+	int framesBefore = args.GetValue("Frames", (int)detector.GetFramesBefore());
+	int maxDumps = args.GetValue("MaxDumps", (int)gProfiler->m_maxHitchDumps);
+	gProfiler->m_pauseOnHitch = args.GetValue("Pause", gProfiler->m_pauseOnHitch);
+
+	detector.SetBudget((double)budgetMilliseconds / 1000.0);
+	detector.SetSigmaThreshold((double)sigma);
+	detector.SetFramesBefore((framesBefore > 0) ? (uint)framesBefore : 0);
+	gProfiler->m_maxHitchDumps = (maxDumps > 0) ? (uint)maxDumps : 0;
+
+	g_devConsole->PrintString(DevConsole::CONSOLE_INFO, Stringf("> Frame time %.3f ms mean, %.3f ms std dev over the last %u frames, %llu hitches in %llu frames (%u written)",
+		detector.GetMeanSeconds() * 1000.0, detector.GetStdDevSeconds() * 1000.0, detector.GetNumWindowFrames(), detector.GetNumHitches(), detector.GetNumFrames(), gProfiler->m_numHitchDumps));
+	g_devConsole->PrintString(DevConsole::CONSOLE_ECHO_COLOR, Stringf("   Budget %.3f ms, Sigma %.1f, Frames %u, MaxDumps %u, Pause %s",
+		detector.GetBudget() * 1000.0, detector.GetSigmaThreshold(), detector.GetFramesBefore(), gProfiler->m_maxHitchDumps, gProfiler->m_pauseOnHitch ? "true" : "false"));
+	return true;
+}
+
 #else
 bool			Profiler::ProfilerInitialize() { return false; };
 void			Profiler::ProfilerShutdown() {};
@@ -589,9 +836,11 @@ void			Profiler::ProfilerPause() {};
 void			Profiler::ProfilerResume() {};
 
 void			Profiler::ProfilerPush(const char* label) { UNUSED(label); };
+void			Profiler::ProfilerPush(uint labelID) { UNUSED(labelID); };
 void			Profiler::ProfilerPop() {};
 
 void			Profiler::ProfilerUpdate() {};
+void			Profiler::ProfilerCollect() {};
 				
 void			Profiler::ProfilerAllocation(size_t byteSize) { UNUSED(byteSize); };
 void			Profiler::ProfilerFree() {};
@@ -605,25 +854,30 @@ Profiler*		Profiler::GetInstance() { return nullptr; }
 
 bool			Profiler::IsProfilerOpen() { return false; }
 
+bool			Profiler::ProfilerExportHistory(std::string const& fileName) { UNUSED(fileName); return false; }
+bool			Profiler::ProfilerExportHitch(ProfilerHitch_T const& hitch, std::string const& fileName) { UNUSED(hitch); UNUSED(fileName); return false; }
+bool			Profiler::ProfilerStartCapture(std::string const& fileName, double seconds) { UNUSED(fileName); UNUSED(seconds); return false; }
+void			Profiler::ProfilerStopCapture() {}
+
 // We can only really 'view' a complete tree
 // these functions return the most recently finished tree
 // use a shared_mutex for accessing trees from the system (as it will try to destroy old ones constantly)
 // `history` is how many frames back we should try to get
-ProfilerSample_T*			ProfilerAcquirePreviousTree(std::thread::id id, uint history = 0) 
+ProfilerTree_T*				ProfilerAcquirePreviousTree(std::thread::id id, uint history = 0) 
 {
 	UNUSED(id);
 	UNUSED(history);
 	return nullptr; 
 }
 
-ProfilerSample_T*			ProfilerAcquirePreviousTreeForCallingThread(uint history = 0) 
+ProfilerTree_T*				ProfilerAcquirePreviousTreeForCallingThread(uint history = 0) 
 {
 	UNUSED(history);
 	return nullptr; 
 }
 
-void						ProfilerReleaseTree(ProfilerSample_T* node) 
+void						ProfilerReleaseTree(ProfilerTree_T* tree) 
 {
-	UNUSED(node);
+	UNUSED(tree);
 }
 #endif
\ No newline at end of file
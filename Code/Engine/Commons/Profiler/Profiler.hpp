@@ -1,9 +1,18 @@
 #pragma once
 //------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/Profiler/ProfilerAggregate.hpp"
+#include "Engine/Commons/Profiler/ProfilerHitchDetector.hpp"
+#include "Engine/Commons/Profiler/ProfilerLabels.hpp"
 #include "Engine/Commons/Profiler/ProfilerSample.hpp"
 #include "Engine/Core/EventSystems.hpp"
+#include <mutex>
+#include <shared_mutex>
 #include <thread>
 
+class ProfilerEventBuffer;
+class ProfilerTraceWriter;
+struct ThreadEventBufferRetirer_T;
+
 //------------------------------------------------------------------------------------------------------------------------------
 class Profiler
 {
@@ -22,10 +31,14 @@ public:
 	void			ProfilerResume();
 	void			ProfilerTogglePause();
 
+	// Push and Pop only write to the calling thread's event buffer, the trees are built by ProfilerCollect
+	// Pushing a label ID skips the label lookup, PROFILE_SCOPE interns its label once per call site
 	void			ProfilerPush(const char* label);
+	void			ProfilerPush(uint labelID);
 	void			ProfilerPop();
 
 	void			ProfilerUpdate();
+	void			ProfilerCollect();
 
 	void			ShowProfilerTimeline();
 	void			PopulateGraphData(float* floatArray, float* allocArray, int& timeArraySize, int& allocArraySize, float& maxTime, float& maxAlloc);
@@ -36,18 +49,35 @@ public:
 	void			ProfilerAllocation(size_t byteSize = 0);
 	void			ProfilerFree();
 
+	// The time between these two feeds the hitch detector, call both from the same thread every frame
 	void			ProfilerBeginFrame(const char* label = "Frame");
 	void			ProfilerEndFrame();
 
 	bool			IsProfilerOpen();
 
+	// Chrome Trace Event JSON, open with chrome://tracing or ui.perfetto.dev
+	// Export writes the history we have right now, a capture keeps writing every tree that finishes for the given time
+	bool			ProfilerExportHistory(std::string const& fileName);
+	bool			ProfilerStartCapture(std::string const& fileName, double seconds);
+	void			ProfilerStopCapture();
+	bool			IsCapturing() const						{ return m_captureWriter != nullptr; }
+
+	// Per label path stats over every tree in the history window, kept up to date as trees come and go
+	ProfilerAggregator&		GetAggregate()						{ return m_aggregate; }
+
+	// A hitch frame is written out with the frames before it as soon as its tree has been collected
+	// The dump is every tree on every thread from the start of the earliest frame to the end of the hitch
+	ProfilerHitchDetector&	GetHitchDetector()					{ return m_hitchDetector; }
+	bool			ProfilerExportHitch(ProfilerHitch_T const& hitch, std::string const& fileName);
+
 	// We can only really 'view' a complete tree
 	// these functions return the most recently finished tree
 	// use a shared_mutex for accessing trees from the system (as it will try to destroy old ones constantly)
 	// `history` is how many frames back we should try to get
-	ProfilerSample_T*			ProfilerAcquirePreviousTree(std::thread::id id, uint history = 0);
-	ProfilerSample_T*			ProfilerAcquirePreviousTreeForCallingThread(uint history = 0);
-	void						ProfilerReleaseTree(ProfilerSample_T* node);
+	// every acquired tree has to be handed back with ProfilerReleaseTree
+	ProfilerTree_T*				ProfilerAcquirePreviousTree(std::thread::id id, uint history = 0);
+	ProfilerTree_T*				ProfilerAcquirePreviousTreeForCallingThread(uint history = 0);
+	void						ProfilerReleaseTree(ProfilerTree_T* tree);
 
 	//------------------------------------------------------------------------------------------------------------------------------
 	// Static Methods
@@ -60,24 +90,50 @@ public:
 	static	bool				Command_PauseProfiler(EventArgs& args);
 	static	bool				Command_ResumeProfiler(EventArgs& args);
 	static	bool				Command_ProfilerReport(EventArgs& args);
+	static	bool				Command_ProfilerExport(EventArgs& args);
+	static	bool				Command_ProfilerHitch(EventArgs& args);
 
 private:
 
-	ProfilerSample_T*			AllocateNode();
-	void						FreeTree(ProfilerSample_T* root);
-	void						FreeNode(ProfilerSample_T* node);
+	ProfilerEventBuffer*		GetThreadEventBuffer();
+	ProfilerEventBuffer*		RegisterThreadEventBuffer();
+	void						RetireThreadEventBuffer(ProfilerEventBuffer* buffer);	// called as the owning thread exits
+
+	friend struct ThreadEventBufferRetirer_T;
 	void						RepopulateReportData();
+	void						DumpPendingHitches();
 
 
 	double			m_maxHistoryTime = 3;
-	bool			m_isPaused = false;
+	std::atomic<bool>	m_isPaused = false;
 
 	bool			m_showTimeline = false;
 
-	std::vector<ProfilerSample_T*>			m_History;
+	std::vector<ProfilerTree_T*>			m_History;
 	std::shared_mutex						m_HistoryLock;
 
-	size_t									m_AllowedSize = 104857600;	//1024 KibiBytes or 1 MebiByte
+	size_t									m_AllowedSize = 104857600;	//100 MebiBytes of trees, the oldest go first past this
+	size_t									m_HistorySize = 0;
+
+	//One event buffer per live thread that has pushed. When a thread exits its buffer is retired, collected one last time
+	//and deleted by the next ProfilerCollect so short lived threads don't leave buffers behind
+	std::vector<ProfilerEventBuffer*>		m_eventBuffers;
+	std::vector<ProfilerEventBuffer*>		m_retiredEventBuffers;
+	std::mutex								m_eventBuffersLock;
+	uint64_t								m_profilerId = 0;
+
+	ProfilerTraceWriter*					m_captureWriter = nullptr;
+	double									m_captureEndTime = 0;
+
+	ProfilerAggregator						m_aggregate;
+
+	ProfilerHitchDetector					m_hitchDetector;
+	uint64_t								m_frameStartTime = 0;
+	std::vector<ProfilerHitch_T>			m_pendingHitches;			// detected in ProfilerEndFrame, dumped in ProfilerCollect
+	std::mutex								m_pendingHitchesLock;
+	bool									m_pauseOnHitch = false;
+	uint									m_maxHitchDumps = 10;		// so a bad stretch doesn't fill the disk
+	uint									m_numHitchDumps = 0;
 
 	//------------------------------------------------------------------------------------------------------------------------------
 	//ImGUI values
@@ -108,6 +164,11 @@ public:
 		gProfiler->ProfilerPush(label);
 	}
 
+	ProfilerLogObject(uint labelID)
+	{
+		gProfiler->ProfilerPush(labelID);
+	}
+
 	~ProfilerLogObject()
 	{
 		gProfiler->ProfilerPop();
@@ -118,5 +179,6 @@ public:
 #define COMBINE1(X,Y) X##Y  // helper macro
 #define COMBINE(X,Y) COMBINE1(X,Y)
 
-#define PROFILE_SCOPE( tag )			ProfilerLogObject COMBINE(__scopeLog, __LINE__) ## (tag)
+// The label is interned the first time the scope runs, so tag has to be the same string every time
+#define PROFILE_SCOPE( tag )			static uint const COMBINE(__scopeLabel, __LINE__) = ProfilerInternLabel(tag); ProfilerLogObject COMBINE(__scopeLog, __LINE__) ## (COMBINE(__scopeLabel, __LINE__))
 #define PROFILE_FUNCTION()				PROFILE_SCOPE(__FUNCTION__);
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include "Engine/Commons/Profiler/ProfilerAggregate.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/Profiler/ProfilerLabels.hpp"
+#include "Engine/Commons/Profiler/ProfilerSample.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint64_t PROFILER_PATH_HASH_SEED = 14695981039346656037ULL;
+constexpr uint64_t PROFILER_PATH_HASH_PRIME = 1099511628211ULL;
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint ProfilerHistogram_T::GetBucketIndex(uint64_t value)
+{
+	if (value < PROFILER_HISTOGRAM_SUB_BUCKETS)
+	{
+		return (uint)value;
+	}
+
+	//Highest set bit picks the doubling, the 3 bits under it pick the sub bucket
+	uint highestBit = 0;
+	for (uint shift = 32; shift > 0; shift >>= 1)
+	{
+		if ((value >> (highestBit + shift)) != 0)
+		{
+			highestBit += shift;
+		}
+	}
+
+	uint subBucket = (uint)(value >> (highestBit - 3)) & (PROFILER_HISTOGRAM_SUB_BUCKETS - 1);
+	return (highestBit - 2) * PROFILER_HISTOGRAM_SUB_BUCKETS + subBucket;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t ProfilerHistogram_T::GetBucketMin(uint bucketIndex)
+{
+	if (bucketIndex < PROFILER_HISTOGRAM_SUB_BUCKETS)
+	{
+		return bucketIndex;
+	}
+
+	uint highestBit = bucketIndex / PROFILER_HISTOGRAM_SUB_BUCKETS + 2;
+	uint64_t subBucket = bucketIndex % PROFILER_HISTOGRAM_SUB_BUCKETS;
+	return (PROFILER_HISTOGRAM_SUB_BUCKETS + subBucket) << (highestBit - 3);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t ProfilerHistogram_T::GetBucketMax(uint bucketIndex)
+{
+	if (bucketIndex < PROFILER_HISTOGRAM_SUB_BUCKETS)
+	{
+		return bucketIndex + 1;
+	}
+
+	uint highestBit = bucketIndex / PROFILER_HISTOGRAM_SUB_BUCKETS + 2;
+	return GetBucketMin(bucketIndex) + (1ULL << (highestBit - 3));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerHistogram_T::Add(uint64_t value)
+{
+	++m_buckets[GetBucketIndex(value)];
+	++m_count;
+	m_max = (value > m_max) ? value : m_max;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerHistogram_T::Remove(uint64_t value)
+{
+	uint bucketIndex = GetBucketIndex(value);
+	ASSERT_RECOVERABLE(m_buckets[bucketIndex] > 0, "Removing a profiler sample that was never added");
+	if (m_buckets[bucketIndex] == 0)
+	{
+		return;
+	}
+
+	--m_buckets[bucketIndex];
+	--m_count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t ProfilerHistogram_T::GetPercentile(double percentile) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t)(percentile * (double)m_count + 0.5);
+	rank = (rank < 1) ? 1 : rank;
+
+	uint64_t seenCount = 0;
+	for (uint bucketIndex = 0; bucketIndex < PROFILER_HISTOGRAM_BUCKETS; ++bucketIndex)
+	{
+		seenCount += m_buckets[bucketIndex];
+		if (seenCount >= rank)
+		{
+			//Middle of the bucket, never past the largest value we know of
+			uint64_t midpoint = (GetBucketMin(bucketIndex) + GetBucketMax(bucketIndex) - 1) / 2;
+			return (midpoint < GetMax()) ? midpoint : GetMax();
+		}
+	}
+
+	return GetMax();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t ProfilerHistogram_T::GetMax() const
+{
+	for (uint bucketIndex = PROFILER_HISTOGRAM_BUCKETS; bucketIndex > 0; --bucketIndex)
+	{
+		if (m_buckets[bucketIndex - 1] == 0)
+		{
+			continue;
+		}
+
+		//The exact max only counts while it's in the highest bucket still in use, otherwise it already left the window
+		if (GetBucketIndex(m_max) == bucketIndex - 1)
+		{
+			return m_max;
+		}
+
+		return GetBucketMax(bucketIndex - 1) - 1;
+	}
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerAggregator::AddTree(ProfilerTree_T const* tree)
+{
+	std::scoped_lock<std::mutex> lock(m_lock);
+
+	AccumulateSample(tree->GetSamples(), 0, PROFILER_PATH_HASH_SEED, nullptr, 0, true);
+	++m_numTrees;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerAggregator::RemoveTree(ProfilerTree_T const* tree)
+{
+	std::scoped_lock<std::mutex> lock(m_lock);
+
+	AccumulateSample(tree->GetSamples(), 0, PROFILER_PATH_HASH_SEED, nullptr, 0, false);
+	--m_numTrees;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerAggregator::GetStats(std::vector<ProfilerAggregateStats_T>& outStats) const
+{
+	std::scoped_lock<std::mutex> lock(m_lock);
+
+	outStats.clear();
+	outStats.reserve(m_paths.size());
+
+	for (std::pair<uint64_t const, ProfilerAggregatePath_T> const& pathEntry : m_paths)
+	{
+		ProfilerAggregatePath_T const& path = pathEntry.second;
+		double numCalls = (double)path.m_numCalls;
+
+		ProfilerAggregateStats_T stats;
+		stats.m_path = path.m_path;
+		stats.m_depth = path.m_depth;
+		stats.m_numCalls = path.m_numCalls;
+
+		stats.m_meanTotalTime = GetHPCToSeconds(path.m_totalTimeSum) / numCalls;
+		stats.m_p50TotalTime = GetHPCToSeconds(path.m_totalTime.GetPercentile(0.5));
+		stats.m_p95TotalTime = GetHPCToSeconds(path.m_totalTime.GetPercentile(0.95));
+		stats.m_p99TotalTime = GetHPCToSeconds(path.m_totalTime.GetPercentile(0.99));
+		stats.m_maxTotalTime = GetHPCToSeconds(path.m_totalTime.GetMax());
+
+		stats.m_meanSelfTime = GetHPCToSeconds(path.m_selfTimeSum) / numCalls;
+		stats.m_p50SelfTime = GetHPCToSeconds(path.m_selfTime.GetPercentile(0.5));
+		stats.m_p95SelfTime = GetHPCToSeconds(path.m_selfTime.GetPercentile(0.95));
+		stats.m_p99SelfTime = GetHPCToSeconds(path.m_selfTime.GetPercentile(0.99));
+		stats.m_maxSelfTime = GetHPCToSeconds(path.m_selfTime.GetMax());
+
+		stats.m_meanAllocCount = (double)path.m_allocCountSum / numCalls;
+		stats.m_meanAllocationSize = (double)path.m_allocationSizeSum / numCalls;
+		stats.m_totalAllocationSize = path.m_allocationSizeSum;
+
+		outStats.push_back(stats);
+	}
+
+	std::sort(outStats.begin(), outStats.end(), [](ProfilerAggregateStats_T const& a, ProfilerAggregateStats_T const& b) { return a.m_path < b.m_path; });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint64_t ProfilerAggregator::GetNumTrees() const
+{
+	std::scoped_lock<std::mutex> lock(m_lock);
+	return m_numTrees;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerAggregator::AccumulateSample(ProfilerSample_T const* samples, uint sampleIndex, uint64_t parentPathHash, std::string const* parentPath, uint depth, bool isAdding)
+{
+	ProfilerSample_T const& sample = samples[sampleIndex];
+	uint childrenEnd = sampleIndex + sample.m_subtreeSize;
+
+	//FNV-1a over the label ID bytes, carried on from the parent's path so equal labels under different parents stay apart
+	uint64_t pathHash = parentPathHash;
+	for (uint byteIndex = 0; byteIndex < sizeof(sample.m_labelID); ++byteIndex)
+	{
+		pathHash = (pathHash ^ (uint64_t)((sample.m_labelID >> (byteIndex * 8)) & 0xFF)) * PROFILER_PATH_HASH_PRIME;
+	}
+
+	uint64_t totalTime = sample.m_duration;
+	uint64_t childrenTime = 0;
+	for (uint childIndex = sampleIndex + 1; childIndex < childrenEnd; childIndex += samples[childIndex].m_subtreeSize)
+	{
+		childrenTime += samples[childIndex].m_duration;
+	}
+	uint64_t selfTime = (totalTime > childrenTime) ? totalTime - childrenTime : 0;
+
+	std::unordered_map<uint64_t, ProfilerAggregatePath_T>::iterator pathItr = m_paths.find(pathHash);
+	if (isAdding)
+	{
+		if (pathItr == m_paths.end())
+		{
+			pathItr = m_paths.emplace(pathHash, ProfilerAggregatePath_T()).first;
+			char const* label = ProfilerGetLabel(sample.m_labelID);
+			pathItr->second.m_path = (parentPath != nullptr) ? *parentPath + "/" + label : label;
+			pathItr->second.m_depth = depth;
+		}
+
+		ProfilerAggregatePath_T& path = pathItr->second;
+		++path.m_numCalls;
+		path.m_totalTimeSum += totalTime;
+		path.m_selfTimeSum += selfTime;
+		path.m_allocCountSum += sample.m_allocCount;
+		path.m_allocationSizeSum += sample.m_allocationSizeInBytes;
+		path.m_totalTime.Add(totalTime);
+		path.m_selfTime.Add(selfTime);
+
+		for (uint childIndex = sampleIndex + 1; childIndex < childrenEnd; childIndex += samples[childIndex].m_subtreeSize)
+		{
+			AccumulateSample(samples, childIndex, pathHash, &path.m_path, depth + 1, true);
+		}
+	}
+	else
+	{
+		ASSERT_RECOVERABLE(pathItr != m_paths.end(), "Removing a profiler tree that was never added");
+		if (pathItr == m_paths.end())
+		{
+			return;
+		}
+
+		ProfilerAggregatePath_T& path = pathItr->second;
+		--path.m_numCalls;
+		path.m_totalTimeSum -= totalTime;
+		path.m_selfTimeSum -= selfTime;
+		path.m_allocCountSum -= sample.m_allocCount;
+		path.m_allocationSizeSum -= sample.m_allocationSizeInBytes;
+		path.m_totalTime.Remove(totalTime);
+		path.m_selfTime.Remove(selfTime);
+
+		for (uint childIndex = sampleIndex + 1; childIndex < childrenEnd; childIndex += samples[childIndex].m_subtreeSize)
+		{
+			AccumulateSample(samples, childIndex, pathHash, nullptr, depth + 1, false);
+		}
+
+		//Children are done with our path, safe to drop it now
+		if (path.m_numCalls == 0)
+		{
+			m_paths.erase(pathItr);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define AGGREGATETEST_FRAMES 1'000
+#define AGGREGATETEST_HITCH_EVERY 200
+
+//------------------------------------------------------------------------------------------------------------------------------
+static ProfilerAggregateStats_T const* FindAggregatePath(std::vector<ProfilerAggregateStats_T> const& stats, char const* path)
+{
+	for (ProfilerAggregateStats_T const& pathStats : stats)
+	{
+		if (pathStats.m_path == path)
+		{
+			return &pathStats;
+		}
+	}
+
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ProfilerHistogram", "Profiler", 100)
+{
+	//Every value has to land in a bucket that contains it
+	for (uint64_t value = 0; value < 100'000; value += 7)
+	{
+		uint bucketIndex = ProfilerHistogram_T::GetBucketIndex(value);
+		CONFIRM(ProfilerHistogram_T::GetBucketMin(bucketIndex) <= value && value < ProfilerHistogram_T::GetBucketMax(bucketIndex));
+	}
+	CONFIRM(ProfilerHistogram_T::GetBucketIndex(UINT64_MAX) == PROFILER_HISTOGRAM_BUCKETS - 1);
+
+	//1..1000 evenly, percentiles within the bucket resolution
+	ProfilerHistogram_T histogram;
+	for (uint64_t value = 1; value <= 1000; ++value)
+	{
+		histogram.Add(value);
+	}
+
+	CONFIRM(histogram.GetMax() == 1000);
+	CONFIRM(histogram.GetPercentile(0.5) > 470 && histogram.GetPercentile(0.5) < 530);
+	CONFIRM(histogram.GetPercentile(0.99) > 930 && histogram.GetPercentile(0.99) <= 1000);
+
+	//Taking the top half back out moves the max and percentiles down with it
+	for (uint64_t value = 501; value <= 1000; ++value)
+	{
+		histogram.Remove(value);
+	}
+
+	//The exact max left with them, so it falls back to the top of the highest bucket still in use (480 to 511)
+	CONFIRM(histogram.m_count == 500);
+	CONFIRM(histogram.GetMax() >= 480 && histogram.GetMax() < 512);
+	CONFIRM(histogram.GetPercentile(0.5) > 235 && histogram.GetPercentile(0.5) < 265);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Frame -> Update -> Physics, where Physics takes 10x as long once every AGGREGATETEST_HITCH_EVERY frames
+UNITTEST("ProfilerAggregate", "Profiler", 100)
+{
+	std::vector<ProfilerTree_T*> trees;
+	ProfilerAggregator aggregator;
+
+	for (uint frameIndex = 0; frameIndex < AGGREGATETEST_FRAMES; ++frameIndex)
+	{
+		ProfilerSample_T samples[3];
+		ProfilerSample_T& frame = samples[0];
+		ProfilerSample_T& update = samples[1];
+		ProfilerSample_T& physics = samples[2];
+		frame.m_labelID = ProfilerInternLabel("Frame");
+		update.m_labelID = ProfilerInternLabel("Update");
+		physics.m_labelID = ProfilerInternLabel("Physics");
+		frame.m_subtreeSize = 3;
+		update.m_subtreeSize = 2;
+
+		physics.m_startOffset = 100;
+		physics.m_duration = ((frameIndex % AGGREGATETEST_HITCH_EVERY) == 0) ? 10'000 : 1'000;
+		physics.m_allocCount = 2;
+		physics.m_allocationSizeInBytes = 128;
+
+		update.m_startOffset = 50;
+		update.m_duration = physics.m_duration + 100;
+		frame.m_duration = update.m_duration + 550;	// 50 before Update and 500 after it is Frame self time
+
+		trees.push_back(ProfilerTree_T::Create(samples, 3, 0, std::this_thread::get_id()));
+		aggregator.AddTree(trees.back());
+	}
+
+	std::vector<ProfilerAggregateStats_T> stats;
+	aggregator.GetStats(stats);
+	CONFIRM(aggregator.GetNumTrees() == AGGREGATETEST_FRAMES && stats.size() == 3);
+	CONFIRM(stats[0].m_path == "Frame" && stats[1].m_path == "Frame/Update" && stats[2].m_path == "Frame/Update/Physics");
+
+	//The hitch is 1 in 200 frames, invisible in the median but not in the p99 or max
+	double secondsPerTick = GetHPCToSeconds(1'000'000) / 1'000'000.0;
+	ProfilerAggregateStats_T const* physics = FindAggregatePath(stats, "Frame/Update/Physics");
+	CONFIRM(physics->m_numCalls == AGGREGATETEST_FRAMES && physics->m_depth == 2);
+	CONFIRM(physics->m_p50TotalTime < 1'100 * secondsPerTick && physics->m_p95TotalTime < 1'100 * secondsPerTick);
+	CONFIRM(physics->m_p99TotalTime < 1'100 * secondsPerTick);
+	CONFIRM(physics->m_maxTotalTime > 9'999 * secondsPerTick && physics->m_maxTotalTime < 10'001 * secondsPerTick);
+	CONFIRM(physics->m_meanAllocCount == 2.0 && physics->m_totalAllocationSize == 128 * AGGREGATETEST_FRAMES);
+
+	//Self time is what is left over after the children
+	ProfilerAggregateStats_T const* frame = FindAggregatePath(stats, "Frame");
+	CONFIRM(frame->m_maxSelfTime > 549 * secondsPerTick && frame->m_maxSelfTime < 551 * secondsPerTick);
+
+	//Sliding the frames with the hitches out of the window takes them out of the stats
+	for (uint frameIndex = 0; frameIndex < AGGREGATETEST_FRAMES; ++frameIndex)
+	{
+		if ((frameIndex % AGGREGATETEST_HITCH_EVERY) == 0)
+		{
+			aggregator.RemoveTree(trees[frameIndex]);
+		}
+	}
+
+	aggregator.GetStats(stats);
+	physics = FindAggregatePath(stats, "Frame/Update/Physics");
+	CONFIRM(physics->m_numCalls == AGGREGATETEST_FRAMES - AGGREGATETEST_FRAMES / AGGREGATETEST_HITCH_EVERY);
+	CONFIRM(physics->m_maxTotalTime < 1'100 * secondsPerTick);
+
+	//Everything gone leaves nothing behind
+	for (uint frameIndex = 0; frameIndex < AGGREGATETEST_FRAMES; ++frameIndex)
+	{
+		if ((frameIndex % AGGREGATETEST_HITCH_EVERY) != 0)
+		{
+			aggregator.RemoveTree(trees[frameIndex]);
+		}
+	}
+
+	aggregator.GetStats(stats);
+	CONFIRM(stats.size() == 0 && aggregator.GetNumTrees() == 0);
+
+	for (ProfilerTree_T* tree : trees)
+	{
+		ProfilerTree_T::Destroy(tree);
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ProfilerSample_T;
+struct ProfilerTree_T;
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Log spaced buckets, 8 per doubling keeps every percentile within ~6% of the real value
+constexpr uint PROFILER_HISTOGRAM_SUB_BUCKETS = 8;
+constexpr uint PROFILER_HISTOGRAM_BUCKETS = PROFILER_HISTOGRAM_SUB_BUCKETS * 62;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Histogram of HPC durations that samples can be added to and taken back out of
+struct ProfilerHistogram_T
+{
+	uint						m_buckets[PROFILER_HISTOGRAM_BUCKETS] = {};
+	uint64_t					m_count = 0;
+	uint64_t					m_max = 0;				// largest value added, trusted while its bucket is still the highest used
+
+	void						Add(uint64_t value);
+	void						Remove(uint64_t value);
+
+	uint64_t					GetPercentile(double percentile) const;	// percentile in [0, 1]
+	uint64_t					GetMax() const;
+
+	static uint					GetBucketIndex(uint64_t value);
+	static uint64_t				GetBucketMin(uint bucketIndex);
+	static uint64_t				GetBucketMax(uint bucketIndex);		// exclusive
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Running totals for one label path (Frame/Update/Physics) over every tree in the window
+struct ProfilerAggregatePath_T
+{
+	std::string					m_path;
+	uint						m_depth = 0;
+
+	uint64_t					m_numCalls = 0;
+	uint64_t					m_totalTimeSum = 0;
+	uint64_t					m_selfTimeSum = 0;
+	uint64_t					m_allocCountSum = 0;
+	uint64_t					m_allocationSizeSum = 0;
+
+	ProfilerHistogram_T			m_totalTime;
+	ProfilerHistogram_T			m_selfTime;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What the report shows for one path, times in seconds and per call
+struct ProfilerAggregateStats_T
+{
+	std::string					m_path;
+	uint						m_depth = 0;
+	uint64_t					m_numCalls = 0;
+
+	double						m_meanTotalTime = 0.0;
+	double						m_p50TotalTime = 0.0;
+	double						m_p95TotalTime = 0.0;
+	double						m_p99TotalTime = 0.0;
+	double						m_maxTotalTime = 0.0;
+
+	double						m_meanSelfTime = 0.0;
+	double						m_p50SelfTime = 0.0;
+	double						m_p95SelfTime = 0.0;
+	double						m_p99SelfTime = 0.0;
+	double						m_maxSelfTime = 0.0;
+
+	double						m_meanAllocCount = 0.0;
+	double						m_meanAllocationSize = 0.0;
+	uint64_t					m_totalAllocationSize = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Per path statistics over many frames so a hitch every few hundred frames shows up in the p99 and max instead of
+// disappearing in an average. Trees are walked once when they are added and once when they leave the history window,
+// reports are read straight from the running totals.
+//------------------------------------------------------------------------------------------------------------------------------
+class ProfilerAggregator
+{
+public:
+	void						AddTree(ProfilerTree_T const* tree);
+	void						RemoveTree(ProfilerTree_T const* tree);
+
+	// Sorted by path so children follow their parents
+	void						GetStats(std::vector<ProfilerAggregateStats_T>& outStats) const;
+	uint64_t					GetNumTrees() const;
+
+private:
+	void						AccumulateSample(ProfilerSample_T const* samples, uint sampleIndex, uint64_t parentPathHash, std::string const* parentPath, uint depth, bool isAdding);
+
+private:
+	std::unordered_map<uint64_t, ProfilerAggregatePath_T>	m_paths;	// keyed by a hash of the label ID path
+	uint64_t					m_numTrees = 0;
+
+	mutable std::mutex			m_lock;
+};
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "Engine/Commons/Profiler/ProfilerEventBuffer.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/Profiler/ProfilerLabels.hpp"
+#include "Engine/Commons/Profiler/ProfilerSample.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include <string.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfilerEventBuffer::ProfilerEventBuffer()
+{
+	m_events = new ProfilerEvent_T[PROFILER_EVENT_BUFFER_CAPACITY];
+	m_threadID = std::this_thread::get_id();
+
+	m_writeIndex.store(0, std::memory_order_relaxed);
+	m_readIndex.store(0, std::memory_order_relaxed);
+	m_numSkippedScopes.store(0, std::memory_order_relaxed);
+
+	//Enough for most frames so the collector doesn't grow these while it's running
+	m_openSamples.reserve(1024);
+	m_openBegins.reserve(64);
+	m_openSampleIndices.reserve(64);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfilerEventBuffer::~ProfilerEventBuffer()
+{
+	delete[] m_events;
+	m_events = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerEventBuffer::CollectTrees(std::vector<ProfilerTree_T*>& outTrees)
+{
+	uint64_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+	uint64_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+	while (readIndex < writeIndex)
+	{
+		ProfilerEvent_T const& event = m_events[readIndex & PROFILER_EVENT_BUFFER_MASK];
+		++readIndex;
+
+		if (event.m_labelID != PROFILER_END_EVENT)
+		{
+			//Samples go in the order their scopes opened, which is pre-order
+			uint64_t treeStartTime = (m_openBegins.size() > 0) ? m_openBegins[0].m_time : event.m_time;
+
+			ProfilerSample_T sample;
+			sample.m_labelID = event.m_labelID;
+			sample.m_startOffset = ProfilerSaturate(event.m_time - treeStartTime);
+
+			m_openSampleIndices.push_back((uint)m_openSamples.size());
+			m_openSamples.push_back(sample);
+			m_openBegins.push_back(event);
+			continue;
+		}
+
+		//Running totals at both ends give what happened inside the scope
+		ProfilerEvent_T const& begin = m_openBegins.back();
+		uint sampleIndex = m_openSampleIndices.back();
+		uint64_t beginTime = begin.m_time;
+
+		ProfilerSample_T& sample = m_openSamples[sampleIndex];
+		sample.m_subtreeSize = (uint)m_openSamples.size() - sampleIndex;
+		sample.m_duration = ProfilerSaturate(event.m_time - begin.m_time);
+		sample.m_allocCount = event.m_allocCount - begin.m_allocCount;
+		sample.m_allocationSizeInBytes = ProfilerSaturate(event.m_allocationSizeInBytes - begin.m_allocationSizeInBytes);
+		sample.m_freeCount = event.m_freeCount - begin.m_freeCount;
+		sample.m_freeSizeInBytes = ProfilerSaturate(event.m_freeSizeInBytes - begin.m_freeSizeInBytes);
+
+		m_openBegins.pop_back();
+		m_openSampleIndices.pop_back();
+
+		if (m_openBegins.size() == 0)
+		{
+			outTrees.push_back(ProfilerTree_T::Create(m_openSamples.data(), (uint)m_openSamples.size(), beginTime, m_threadID));
+			m_openSamples.clear();
+		}
+	}
+
+	//Hand the slots back to the owner
+	m_readIndex.store(readIndex, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define PROFILERTEST_FRAMES 2'000
+#define PROFILERTEST_THREADS 4
+#define PROFILERTEST_SCOPES_PER_FRAME 2'000
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Frame -> (Update -> Physics, Render), with allocations in Physics so the counters have something to show
+static void ProduceTestFrames(ProfilerEventBuffer* buffer, std::atomic<bool>* done)
+{
+	uint frameLabel = ProfilerInternLabel("Frame");
+	uint updateLabel = ProfilerInternLabel("Update");
+	uint physicsLabel = ProfilerInternLabel("Physics");
+	uint renderLabel = ProfilerInternLabel("Render");
+	uint pausedLabel = ProfilerInternLabel("Paused");
+
+	for (uint frameIndex = 0; frameIndex < PROFILERTEST_FRAMES; ++frameIndex)
+	{
+		buffer->PushBegin(frameLabel);
+		buffer->PushBegin(updateLabel);
+		buffer->PushBegin(physicsLabel);
+
+		tTotalAllocations += 2;
+		tTotalBytesAllocated += 64;
+
+		buffer->PushEnd();
+		buffer->PushEnd();
+		buffer->PushBegin(renderLabel);
+		buffer->PushEnd();
+		buffer->PushEnd();
+
+		//Paused scopes and everything under them are never written
+		buffer->PushBegin(pausedLabel, true);
+		buffer->PushBegin(pausedLabel);
+		buffer->PushEnd();
+		buffer->PushEnd();
+	}
+
+	*done = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ProfilerEventBuffer", "Profiler", 100)
+{
+	//Collect while the owner keeps writing
+	//Buffers belong to the thread that constructs them
+	std::atomic<ProfilerEventBuffer*> buffer = nullptr;
+	std::atomic<bool> done = false;
+	std::vector<ProfilerTree_T*> trees;
+
+	std::thread producer([&]()
+	{
+		ProfilerEventBuffer ownedBuffer;
+		buffer = &ownedBuffer;
+		ProduceTestFrames(&ownedBuffer, &done);
+
+		while (done)
+		{
+			std::this_thread::yield();
+		}
+	});
+
+	while (buffer == nullptr || !done)
+	{
+		if (buffer != nullptr)
+		{
+			buffer.load()->CollectTrees(trees);
+		}
+		std::this_thread::yield();
+	}
+
+	buffer.load()->CollectTrees(trees);
+	std::thread::id producerThreadID = producer.get_id();
+	bool isOwnedByProducer = (buffer.load()->GetThreadID() == producerThreadID);
+	uint64_t numSkippedScopes = buffer.load()->GetNumSkippedScopes();
+
+	//Let the producer destroy its buffer
+	done = false;
+	producer.join();
+
+	CONFIRM(isOwnedByProducer);
+	CONFIRM(numSkippedScopes == 0);
+
+	CONFIRM(trees.size() == PROFILERTEST_FRAMES);
+	for (ProfilerTree_T* tree : trees)
+	{
+		CONFIRM(tree->m_numSamples == 4 && tree->m_threadID == producerThreadID);
+
+		//Pre-order, Physics is inside Update and Render comes after Update's subtree
+		ProfilerSample_T const* samples = tree->GetSamples();
+		ProfilerSample_T const& frame = samples[0];
+		ProfilerSample_T const& update = samples[1];
+		ProfilerSample_T const& physics = samples[2];
+		ProfilerSample_T const& render = samples[1 + update.m_subtreeSize];
+		CONFIRM(strcmp(ProfilerGetLabel(frame.m_labelID), "Frame") == 0 && frame.m_subtreeSize == 4 && frame.m_startOffset == 0);
+		CONFIRM(strcmp(ProfilerGetLabel(update.m_labelID), "Update") == 0 && update.m_subtreeSize == 2);
+		CONFIRM(strcmp(ProfilerGetLabel(physics.m_labelID), "Physics") == 0 && physics.m_subtreeSize == 1);
+		CONFIRM(strcmp(ProfilerGetLabel(render.m_labelID), "Render") == 0 && render.m_subtreeSize == 1);
+		CONFIRM(update.m_startOffset + update.m_duration <= render.m_startOffset && render.m_startOffset + render.m_duration <= frame.m_duration);
+		CONFIRM(frame.m_allocCount == 2 && frame.m_allocationSizeInBytes == 64 && physics.m_allocCount == 2 && render.m_allocCount == 0);
+
+		ProfilerTree_T::Destroy(tree);
+	}
+	trees.clear();
+
+	//Nobody collecting, scopes that don't fit are skipped whole and what made it in is still well formed
+	uint outerLabel = ProfilerInternLabel("Outer");
+	ProfilerEventBuffer fullBuffer;
+	for (uint scopeIndex = 0; scopeIndex < PROFILER_EVENT_BUFFER_CAPACITY; ++scopeIndex)
+	{
+		fullBuffer.PushBegin(outerLabel);
+		fullBuffer.PushBegin(ProfilerInternLabel("Inner"));
+		fullBuffer.PushBegin(ProfilerInternLabel("Innermost"));
+		fullBuffer.PushEnd();
+		fullBuffer.PushEnd();
+		fullBuffer.PushEnd();
+	}
+	CONFIRM(fullBuffer.GetNumSkippedScopes() > 0);
+
+	fullBuffer.CollectTrees(trees);
+	CONFIRM(trees.size() > 0);
+	for (ProfilerTree_T* tree : trees)
+	{
+		CONFIRM(tree->GetRoot().m_labelID == outerLabel && tree->GetRoot().m_subtreeSize == tree->m_numSamples);
+		CONFIRM(tree->GetEndTime() >= tree->m_startTime);
+		ProfilerTree_T::Destroy(tree);
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfilerBenchmarkFrames_T
+{
+	std::atomic<ProfilerEventBuffer*>	buffers[PROFILERTEST_THREADS] = {};
+	double								threadSeconds[PROFILERTEST_THREADS] = {};
+
+	std::atomic<uint>					numFramesWritten = 0;		// summed over every thread
+	std::atomic<uint>					numFramesCollected = 0;
+	std::atomic<bool>					isDone = false;
+	bool								internEveryScope = false;	// what ProfilerPush(char const*) pays
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Only the scopes are timed, each thread then waits for the collector like it would for the next frame
+static void ProduceBenchmarkScopes(ProfilerBenchmarkFrames_T* frames, uint threadIndex)
+{
+	ProfilerEventBuffer ownedBuffer;
+	ProfilerEventBuffer* buffer = &ownedBuffer;
+	frames->buffers[threadIndex] = buffer;
+	double seconds = 0.0;
+
+	//What PROFILE_SCOPE does, one lookup per call site
+	static uint const frameLabel = ProfilerInternLabel("Frame");
+	static uint const updateLabel = ProfilerInternLabel("Update");
+	static uint const renderLabel = ProfilerInternLabel("Render");
+	static uint const drawCallLabel = ProfilerInternLabel("DrawCall");
+
+	for (uint frameIndex = 0; frameIndex < PROFILERTEST_FRAMES; ++frameIndex)
+	{
+		double startTime = GetCurrentTimeSeconds();
+		if (frames->internEveryScope)
+		{
+			for (uint scopeIndex = 0; scopeIndex < PROFILERTEST_SCOPES_PER_FRAME; scopeIndex += 4)
+			{
+				buffer->PushBegin(ProfilerInternLabel("Frame"));
+				buffer->PushBegin(ProfilerInternLabel("Update"));
+				buffer->PushEnd();
+				buffer->PushBegin(ProfilerInternLabel("Render"));
+				buffer->PushBegin(ProfilerInternLabel("DrawCall"));
+				buffer->PushEnd();
+				buffer->PushEnd();
+				buffer->PushEnd();
+			}
+		}
+		else
+		{
+			for (uint scopeIndex = 0; scopeIndex < PROFILERTEST_SCOPES_PER_FRAME; scopeIndex += 4)
+			{
+				buffer->PushBegin(frameLabel);
+				buffer->PushBegin(updateLabel);
+				buffer->PushEnd();
+				buffer->PushBegin(renderLabel);
+				buffer->PushBegin(drawCallLabel);
+				buffer->PushEnd();
+				buffer->PushEnd();
+				buffer->PushEnd();
+			}
+		}
+		seconds += GetCurrentTimeSeconds() - startTime;
+
+		++frames->numFramesWritten;
+		while (frames->numFramesCollected <= frameIndex)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	frames->threadSeconds[threadIndex] = seconds;
+
+	//Keep the buffer alive until the collector is done with it
+	while (!frames->isDone)
+	{
+		std::this_thread::yield();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Cost of one push and pop pair on the owning thread with a collect every frame, target is under ~20 ns
+// The last run looks the label up on every push like ProfilerPush(char const*) does instead of once per call site
+UNITTEST("ProfilerScopeOverhead", "Profiler", 200)
+{
+	//Every scope reads the timer twice, which is most of the cost on some machines
+	uint64_t timerSum = 0;
+	double timerStartTime = GetCurrentTimeSeconds();
+	for (uint scopeIndex = 0; scopeIndex < PROFILERTEST_FRAMES * PROFILERTEST_SCOPES_PER_FRAME; ++scopeIndex)
+	{
+		timerSum += GetCurrentTimeHPC();
+		timerSum += GetCurrentTimeHPC();
+	}
+	double timerNanoseconds = (GetCurrentTimeSeconds() - timerStartTime) * 1'000'000'000.0 / (double)(PROFILERTEST_FRAMES * PROFILERTEST_SCOPES_PER_FRAME);
+	CONFIRM(timerSum != 0);
+
+	for (uint runIndex = 0; (1U << runIndex) <= PROFILERTEST_THREADS * 2; ++runIndex)
+	{
+		ProfilerBenchmarkFrames_T frames;
+		frames.internEveryScope = ((1U << runIndex) > PROFILERTEST_THREADS);
+		uint threadCount = frames.internEveryScope ? 1 : (1U << runIndex);
+
+		std::vector<std::thread> threads;
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			threads.emplace_back(ProduceBenchmarkScopes, &frames, threadIndex);
+		}
+
+		//Trees are thrown away as soon as they are built
+		std::vector<ProfilerTree_T*> trees;
+		size_t treeBytes = 0;
+		uint64_t numSamples = 0;
+		for (uint frameIndex = 0; frameIndex < PROFILERTEST_FRAMES; ++frameIndex)
+		{
+			while (frames.numFramesWritten < threadCount * (frameIndex + 1))
+			{
+				std::this_thread::yield();
+			}
+
+			for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+			{
+				frames.buffers[threadIndex].load()->CollectTrees(trees);
+			}
+
+			for (ProfilerTree_T* tree : trees)
+			{
+				treeBytes += tree->GetByteSize();
+				numSamples += tree->m_numSamples;
+				ProfilerTree_T::Destroy(tree);
+			}
+			trees.clear();
+
+			++frames.numFramesCollected;
+		}
+
+		uint64_t numSkippedScopes = 0;
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			numSkippedScopes += frames.buffers[threadIndex].load()->GetNumSkippedScopes();
+		}
+
+		frames.isDone = true;
+		double slowestSeconds = 0.0;
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			threads[threadIndex].join();
+			slowestSeconds = (frames.threadSeconds[threadIndex] > slowestSeconds) ? frames.threadSeconds[threadIndex] : slowestSeconds;
+		}
+		CONFIRM(numSkippedScopes == 0);
+
+		double nanosecondsPerScope = slowestSeconds * 1'000'000'000.0 / (double)(PROFILERTEST_FRAMES * PROFILERTEST_SCOPES_PER_FRAME);
+		DebuggerPrintf("\n %u threads%s: %.2f ns per profiled scope (%.2f ns of it is reading the timer twice), %.1f bytes per sample", threadCount, frames.internEveryScope ? " interning every push" : "",
+			nanosecondsPerScope, timerNanoseconds, (double)treeBytes / (double)numSamples);
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+struct ProfilerSample_T;
+struct ProfilerTree_T;
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint PROFILER_EVENT_BUFFER_CAPACITY = 16384;		// Events each thread can have in flight between two collects
+constexpr uint PROFILER_EVENT_BUFFER_MASK = PROFILER_EVENT_BUFFER_CAPACITY - 1;
+constexpr uint PROFILER_END_EVENT = UINT32_MAX;							// label ID of an end event
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A begin event has the scope's label ID, an end event has PROFILER_END_EVENT. The memory counters are the thread's running totals
+struct ProfilerEvent_T
+{
+	uint64_t					m_time = 0;
+
+	size_t						m_allocationSizeInBytes = 0;
+	size_t						m_freeSizeInBytes = 0;
+	uint						m_allocCount = 0;
+	uint						m_freeCount = 0;
+
+	uint						m_labelID = PROFILER_END_EVENT;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Single producer single consumer ring of profiler events. The owning thread writes begin and end events without
+// locking or allocating, the collector reads them back later and builds the ProfilerTree_T trees. A begin is only written
+// when there is room left for it and the ends of every open scope, so a scope that doesn't fit is skipped together with
+// everything inside it and an open tree is never left without its ends.
+// Labels are interned IDs (see ProfilerLabels.hpp), so nothing is copied per scope on either side.
+//------------------------------------------------------------------------------------------------------------------------------
+class ProfilerEventBuffer
+{
+public:
+	ProfilerEventBuffer();
+	~ProfilerEventBuffer();
+
+	//Owner thread only. With skipNewTrees set, scopes opened at depth 0 are not recorded
+	inline void					PushBegin(uint labelID, bool skipNewTrees = false);
+	inline void					PushEnd();
+
+	//Collector only. Every tree that was closed since the last collect is appended to outTrees
+	void						CollectTrees(std::vector<ProfilerTree_T*>& outTrees);
+
+	uint						GetDepth() const			{ return m_depth + m_skipDepth; }	// owner thread only, scopes still open
+	std::thread::id				GetThreadID() const			{ return m_threadID; }
+	uint64_t					GetNumSkippedScopes() const	{ return m_numSkippedScopes.load(std::memory_order_relaxed); }	// scopes that didn't fit
+
+private:
+	inline bool					WriteEvent(uint labelID, uint reservedEvents);
+
+private:
+	ProfilerEvent_T*			m_events = nullptr;
+	std::thread::id				m_threadID;
+
+	//Owner side
+	alignas(64) std::atomic<uint64_t>	m_writeIndex;
+	uint64_t					m_cachedReadIndex = 0;
+	uint						m_depth = 0;					// recorded scopes still open
+	uint						m_skipDepth = 0;				// scopes open since we started skipping
+	std::atomic<uint64_t>		m_numSkippedScopes;
+
+	//Collector side
+	alignas(64) std::atomic<uint64_t>	m_readIndex;
+	std::vector<ProfilerSample_T>	m_openSamples;			// pre-order samples of the tree being collected
+	std::vector<ProfilerEvent_T>	m_openBegins;			// begin event of every open scope, innermost last
+	std::vector<uint>			m_openSampleIndices;		// m_openSamples index of every open scope, innermost last
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool ProfilerEventBuffer::WriteEvent(uint labelID, uint reservedEvents)
+{
+	uint64_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+
+	if (writeIndex + reservedEvents - m_cachedReadIndex > PROFILER_EVENT_BUFFER_CAPACITY)
+	{
+		//Only go to the shared read index when the cached one says we are full
+		m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+		if (writeIndex + reservedEvents - m_cachedReadIndex > PROFILER_EVENT_BUFFER_CAPACITY)
+		{
+			return false;
+		}
+	}
+
+	ProfilerEvent_T& event = m_events[writeIndex & PROFILER_EVENT_BUFFER_MASK];
+	event.m_time = GetCurrentTimeHPC();
+	event.m_labelID = labelID;
+	event.m_allocationSizeInBytes = tTotalBytesAllocated;
+	event.m_freeSizeInBytes = tTotalBytesFreed;
+	event.m_allocCount = (uint)tTotalAllocations;
+	event.m_freeCount = (uint)tTotalFrees;
+
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerEventBuffer::PushBegin(uint labelID, bool skipNewTrees /*= false*/)
+{
+	if (m_skipDepth > 0)
+	{
+		++m_skipDepth;
+		return;
+	}
+
+	if (skipNewTrees && m_depth == 0)
+	{
+		m_skipDepth = 1;
+		return;
+	}
+
+	//Room for this begin, its end and the ends of everything already open
+	if (!WriteEvent(labelID, m_depth + 2))
+	{
+		m_skipDepth = 1;
+		m_numSkippedScopes.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	++m_depth;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerEventBuffer::PushEnd()
+{
+	if (m_skipDepth > 0)
+	{
+		--m_skipDepth;
+		return;
+	}
+
+	ASSERT_RECOVERABLE(m_depth > 0, "Profiler pop without a matching push");
+	if (m_depth == 0)
+	{
+		return;
+	}
+
+	//Space for this was reserved by the begin
+	WriteEvent(PROFILER_END_EVENT, 1);
+	--m_depth;
+}
\ No newline at end of file
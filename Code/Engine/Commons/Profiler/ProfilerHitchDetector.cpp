@@ -0,0 +1,157 @@
+#include "Engine/Commons/Profiler/ProfilerHitchDetector.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <math.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool ProfilerHitchDetector::AddFrame(uint64_t startTime, uint64_t endTime, std::thread::id threadID)
+{
+	double frameSeconds = GetHPCToSeconds(endTime - startTime);
+
+	//Test against the frames before this one so the hitch doesn't raise its own bar
+	double meanSeconds = GetMeanSeconds();
+	double stdDevSeconds = GetStdDevSeconds();
+	double sigmaSeconds = m_sigmaThreshold * stdDevSeconds;
+	sigmaSeconds = (sigmaSeconds > PROFILER_HITCH_MIN_SECONDS) ? sigmaSeconds : PROFILER_HITCH_MIN_SECONDS;
+
+	bool isOverBudget = (m_budgetSeconds > 0.0 && frameSeconds > m_budgetSeconds);
+	bool isOverSigma = (m_sigmaThreshold > 0.0 && m_numWindowFrames >= PROFILER_HITCH_MIN_FRAMES && frameSeconds > meanSeconds + sigmaSeconds);
+
+	uint framesBefore = (m_framesBefore < m_numWindowFrames) ? m_framesBefore : m_numWindowFrames;
+	uint64_t windowStartTime = (framesBefore > 0) ? GetFrame(framesBefore - 1).m_startTime : startTime;
+
+	//Oldest frame drops out of the window when we take its slot
+	ProfilerFrameTime_T& frame = m_frames[m_numFrames % PROFILER_HITCH_WINDOW_FRAMES];
+	if (m_numWindowFrames == PROFILER_HITCH_WINDOW_FRAMES)
+	{
+		double oldSeconds = GetHPCToSeconds(frame.m_endTime - frame.m_startTime);
+		m_sum -= oldSeconds;
+		m_sumOfSquares -= oldSeconds * oldSeconds;
+	}
+	else
+	{
+		++m_numWindowFrames;
+	}
+
+	frame.m_frameIndex = m_numFrames;
+	frame.m_startTime = startTime;
+	frame.m_endTime = endTime;
+	m_sum += frameSeconds;
+	m_sumOfSquares += frameSeconds * frameSeconds;
+	++m_numFrames;
+
+	if (!isOverBudget && !isOverSigma)
+	{
+		return false;
+	}
+
+	m_lastHitch.m_frameIndex = frame.m_frameIndex;
+	m_lastHitch.m_startTime = startTime;
+	m_lastHitch.m_endTime = endTime;
+	m_lastHitch.m_windowStartTime = windowStartTime;
+	m_lastHitch.m_threadID = threadID;
+	m_lastHitch.m_frameSeconds = frameSeconds;
+	m_lastHitch.m_meanSeconds = meanSeconds;
+	m_lastHitch.m_stdDevSeconds = stdDevSeconds;
+	m_lastHitch.m_isOverBudget = isOverBudget;
+	m_lastHitch.m_isOverSigma = isOverSigma;
+
+	++m_numHitches;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerHitchDetector::SetFramesBefore(uint numFrames)
+{
+	m_framesBefore = (numFrames < PROFILER_HITCH_WINDOW_FRAMES) ? numFrames : PROFILER_HITCH_WINDOW_FRAMES - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double ProfilerHitchDetector::GetMeanSeconds() const
+{
+	if (m_numWindowFrames == 0)
+	{
+		return 0.0;
+	}
+
+	return m_sum / (double)m_numWindowFrames;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double ProfilerHitchDetector::GetStdDevSeconds() const
+{
+	if (m_numWindowFrames < 2)
+	{
+		return 0.0;
+	}
+
+	double meanSeconds = GetMeanSeconds();
+	double variance = m_sumOfSquares / (double)m_numWindowFrames - meanSeconds * meanSeconds;
+
+	//Running sums can dip just under 0 when every frame takes the same time
+	return (variance > 0.0) ? sqrt(variance) : 0.0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfilerFrameTime_T const& ProfilerHitchDetector::GetFrame(uint framesBack) const
+{
+	ASSERT_RECOVERABLE(framesBack < m_numWindowFrames, "Asking for a frame that is no longer in the hitch window");
+	return m_frames[(m_numFrames - 1 - framesBack) % PROFILER_HITCH_WINDOW_FRAMES];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define HITCHTEST_FRAMES 500
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ProfilerHitchDetector", "Profiler", 100)
+{
+	//10 ms frames with up to 0.4 ms of jitter
+	uint64_t ticksPerMillisecond = (uint64_t)(0.001 / GetHPCToSeconds(1));
+	std::thread::id threadID = std::this_thread::get_id();
+
+	ProfilerHitchDetector detector;
+	detector.SetFramesBefore(5);
+
+	uint64_t frameTime = 0;
+	for (uint frameIndex = 0; frameIndex < HITCHTEST_FRAMES; ++frameIndex)
+	{
+		uint64_t frameTicks = ticksPerMillisecond * 10 + (frameIndex % 5) * ticksPerMillisecond / 10;
+		CONFIRM(!detector.AddFrame(frameTime, frameTime + frameTicks, threadID));
+		frameTime += frameTicks;
+	}
+
+	CONFIRM(detector.GetNumFrames() == HITCHTEST_FRAMES && detector.GetNumWindowFrames() == PROFILER_HITCH_WINDOW_FRAMES);
+	CONFIRM(detector.GetMeanSeconds() > 0.0101 && detector.GetMeanSeconds() < 0.0103);
+	CONFIRM(detector.GetStdDevSeconds() > 0.0001 && detector.GetStdDevSeconds() < 0.0002);
+
+	//A 30 ms frame is far past 4 sigma, and the 5 frames before it come along
+	uint64_t fifthFrameBackStart = detector.GetFrame(4).m_startTime;
+	CONFIRM(detector.AddFrame(frameTime, frameTime + ticksPerMillisecond * 30, threadID));
+
+	ProfilerHitch_T const& hitch = detector.GetLastHitch();
+	CONFIRM(hitch.m_frameIndex == HITCHTEST_FRAMES && hitch.m_isOverSigma && !hitch.m_isOverBudget && hitch.m_threadID == threadID);
+	CONFIRM(hitch.m_windowStartTime == fifthFrameBackStart && hitch.m_startTime == frameTime);
+	CONFIRM(hitch.m_frameSeconds > 0.0299 && hitch.m_meanSeconds < 0.0103);
+	frameTime += ticksPerMillisecond * 30;
+
+	//12 ms isn't a sigma hitch with the 30 ms frame in the window, it is over a 11 ms budget
+	CONFIRM(!detector.AddFrame(frameTime, frameTime + ticksPerMillisecond * 12, threadID));
+	frameTime += ticksPerMillisecond * 12;
+
+	detector.SetBudget(0.011);
+	CONFIRM(detector.AddFrame(frameTime, frameTime + ticksPerMillisecond * 12, threadID));
+	CONFIRM(detector.GetLastHitch().m_isOverBudget && !detector.GetLastHitch().m_isOverSigma);
+	frameTime += ticksPerMillisecond * 12;
+
+	//Both tests off
+	detector.SetBudget(0.0);
+	detector.SetSigmaThreshold(0.0);
+	CONFIRM(!detector.AddFrame(frameTime, frameTime + ticksPerMillisecond * 100, threadID));
+	CONFIRM(detector.GetNumHitches() == 2);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <thread>
+
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint PROFILER_HITCH_WINDOW_FRAMES = 240;			// frames the rolling mean and deviation are taken over
+constexpr uint PROFILER_HITCH_MIN_FRAMES = 30;				// no sigma test until the window has this many frames
+constexpr double PROFILER_HITCH_MIN_SECONDS = 0.001;		// a sigma hitch also has to be this far over the mean
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfilerFrameTime_T
+{
+	uint64_t					m_frameIndex = 0;
+	uint64_t					m_startTime = 0;			// HPC
+	uint64_t					m_endTime = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Everything we know about a hitch when the frame ends, the trees are only dumped once they have been collected
+struct ProfilerHitch_T
+{
+	uint64_t					m_frameIndex = 0;
+	uint64_t					m_startTime = 0;			// HPC, the hitch frame
+	uint64_t					m_endTime = 0;
+	uint64_t					m_windowStartTime = 0;		// HPC start of the earliest preceding frame to dump with it
+	std::thread::id				m_threadID;					// thread that called ProfilerBeginFrame and ProfilerEndFrame
+
+	double						m_frameSeconds = 0.0;
+	double						m_meanSeconds = 0.0;		// over the window, not counting the hitch
+	double						m_stdDevSeconds = 0.0;
+	bool						m_isOverBudget = false;
+	bool						m_isOverSigma = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Rolling summary of the last PROFILER_HITCH_WINDOW_FRAMES frame times, fed by ProfilerEndFrame. A frame is a hitch
+// when it takes longer than the budget or more than m_sigmaThreshold standard deviations over the rolling mean, either
+// test is off when set to 0. Only the thread that begins and ends frames should call AddFrame.
+//------------------------------------------------------------------------------------------------------------------------------
+class ProfilerHitchDetector
+{
+public:
+	// Returns true if the frame is a hitch, GetLastHitch has the details
+	bool						AddFrame(uint64_t startTime, uint64_t endTime, std::thread::id threadID);
+
+	void						SetBudget(double seconds)			{ m_budgetSeconds = seconds; }
+	void						SetSigmaThreshold(double sigma)		{ m_sigmaThreshold = sigma; }
+	void						SetFramesBefore(uint numFrames);
+	double						GetBudget() const					{ return m_budgetSeconds; }
+	double						GetSigmaThreshold() const			{ return m_sigmaThreshold; }
+	uint						GetFramesBefore() const				{ return m_framesBefore; }
+
+	double						GetMeanSeconds() const;
+	double						GetStdDevSeconds() const;
+	uint						GetNumWindowFrames() const			{ return m_numWindowFrames; }
+	uint64_t					GetNumFrames() const				{ return m_numFrames; }
+	uint64_t					GetNumHitches() const				{ return m_numHitches; }
+
+	ProfilerFrameTime_T const&	GetFrame(uint framesBack) const;	// 0 is the last frame added, has to be in the window
+	ProfilerHitch_T const&		GetLastHitch() const				{ return m_lastHitch; }
+
+private:
+	ProfilerFrameTime_T			m_frames[PROFILER_HITCH_WINDOW_FRAMES];
+	uint						m_numWindowFrames = 0;
+	uint64_t					m_numFrames = 0;
+
+	//Over the frames in the window, in seconds
+	double						m_sum = 0.0;
+	double						m_sumOfSquares = 0.0;
+
+	double						m_budgetSeconds = 0.0;
+	double						m_sigmaThreshold = 4.0;
+	uint						m_framesBefore = 5;
+
+	uint64_t					m_numHitches = 0;
+	ProfilerHitch_T				m_lastHitch;
+};
\ No newline at end of file
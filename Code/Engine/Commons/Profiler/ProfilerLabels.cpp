@@ -0,0 +1,183 @@
+#include "Engine/Commons/Profiler/ProfilerLabels.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/MemTracking.hpp"
+#include <atomic>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint PROFILER_LABEL_SLOTS = PROFILER_MAX_LABELS * 2;		// keep the table at most half full so probes stay short
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ProfilerLabelSlot_T
+{
+	std::atomic<uint64_t>		hash;			// 0 while empty, written last so a reader that sees it also sees the ID
+	std::atomic<uint>			labelID;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static ProfilerLabelSlot_T		gProfilerLabelSlots[PROFILER_LABEL_SLOTS] = {};
+static char const*				gProfilerLabels[PROFILER_MAX_LABELS] = { "Unknown" };
+static std::atomic<uint>		gNumProfilerLabels = 1;
+static std::mutex				gProfilerLabelLock;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t HashProfilerLabel(char const* label)
+{
+	//FNV-1a, never 0 so 0 can mean an empty slot
+	uint64_t hash = 14695981039346656037ULL;
+	for (char const* character = label; *character != '\0'; ++character)
+	{
+		hash = (hash ^ (uint64_t)(unsigned char)*character) * 1099511628211ULL;
+	}
+
+	return hash | 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Returns the ID if the label is interned, otherwise the slot it would go in
+static uint FindProfilerLabel(char const* label, uint64_t hash, uint* outEmptySlot)
+{
+	uint slotIndex = (uint)hash & (PROFILER_LABEL_SLOTS - 1);
+
+	while (true)
+	{
+		ProfilerLabelSlot_T& slot = gProfilerLabelSlots[slotIndex];
+		uint64_t slotHash = slot.hash.load(std::memory_order_acquire);
+
+		if (slotHash == 0)
+		{
+			*outEmptySlot = slotIndex;
+			return PROFILER_UNKNOWN_LABEL;
+		}
+
+		if (slotHash == hash)
+		{
+			uint labelID = slot.labelID.load(std::memory_order_relaxed);
+			if (strcmp(gProfilerLabels[labelID], label) == 0)
+			{
+				return labelID;
+			}
+		}
+
+		slotIndex = (slotIndex + 1) & (PROFILER_LABEL_SLOTS - 1);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ProfilerInternLabel(char const* label)
+{
+	uint64_t hash = HashProfilerLabel(label);
+	uint emptySlot = 0;
+
+	uint labelID = FindProfilerLabel(label, hash, &emptySlot);
+	if (labelID != PROFILER_UNKNOWN_LABEL)
+	{
+		return labelID;
+	}
+
+	//Not there yet, look again under the lock in case another thread just added it
+	std::scoped_lock<std::mutex> lock(gProfilerLabelLock);
+	labelID = FindProfilerLabel(label, hash, &emptySlot);
+	if (labelID != PROFILER_UNKNOWN_LABEL)
+	{
+		return labelID;
+	}
+
+	uint numLabels = gNumProfilerLabels.load(std::memory_order_relaxed);
+	ASSERT_RECOVERABLE(numLabels < PROFILER_MAX_LABELS, "Ran out of profiler labels, raise PROFILER_MAX_LABELS");
+	if (numLabels >= PROFILER_MAX_LABELS)
+	{
+		return PROFILER_UNKNOWN_LABEL;
+	}
+
+	//Labels live as long as the process, keep them out of the tracked allocations
+	size_t labelSize = strlen(label) + 1;
+	char* labelCopy = (char*)UntrackedAlloc(labelSize);
+	memcpy(labelCopy, label, labelSize);
+
+	labelID = numLabels;
+	gProfilerLabels[labelID] = labelCopy;
+	gNumProfilerLabels.store(numLabels + 1, std::memory_order_release);
+
+	ProfilerLabelSlot_T& slot = gProfilerLabelSlots[emptySlot];
+	slot.labelID.store(labelID, std::memory_order_relaxed);
+	slot.hash.store(hash, std::memory_order_release);
+
+	return labelID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+char const* ProfilerGetLabel(uint labelID)
+{
+	if (labelID >= gNumProfilerLabels.load(std::memory_order_acquire))
+	{
+		return gProfilerLabels[PROFILER_UNKNOWN_LABEL];
+	}
+
+	return gProfilerLabels[labelID];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ProfilerGetNumLabels()
+{
+	return gNumProfilerLabels.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define LABELTEST_THREADS 4
+#define LABELTEST_LABELS 256
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ProfilerLabels", "Profiler", 100)
+{
+	//Same text from a different buffer is the same label
+	char labelBuffer[64];
+	strcpy_s(labelBuffer, "ProfilerLabelsTest");
+	uint labelID = ProfilerInternLabel("ProfilerLabelsTest");
+	CONFIRM(labelID != PROFILER_UNKNOWN_LABEL);
+	CONFIRM(ProfilerInternLabel(labelBuffer) == labelID);
+
+	strcpy_s(labelBuffer, "Overwritten");
+	CONFIRM(strcmp(ProfilerGetLabel(labelID), "ProfilerLabelsTest") == 0);
+	CONFIRM(strcmp(ProfilerGetLabel(PROFILER_MAX_LABELS + 1), "Unknown") == 0);
+
+	//Threads racing to intern the same labels all agree on the IDs
+	std::vector<uint> threadLabelIDs[LABELTEST_THREADS];
+	std::vector<std::thread> threads;
+	for (uint threadIndex = 0; threadIndex < LABELTEST_THREADS; ++threadIndex)
+	{
+		threads.emplace_back([&threadLabelIDs, threadIndex]()
+		{
+			for (uint labelIndex = 0; labelIndex < LABELTEST_LABELS; ++labelIndex)
+			{
+				threadLabelIDs[threadIndex].push_back(ProfilerInternLabel(Stringf("ProfilerLabelsTest_%u", labelIndex).c_str()));
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (uint labelIndex = 0; labelIndex < LABELTEST_LABELS; ++labelIndex)
+	{
+		uint expectedID = threadLabelIDs[0][labelIndex];
+		CONFIRM(expectedID != PROFILER_UNKNOWN_LABEL);
+		CONFIRM(Stringf("ProfilerLabelsTest_%u", labelIndex) == ProfilerGetLabel(expectedID));
+
+		for (uint threadIndex = 1; threadIndex < LABELTEST_THREADS; ++threadIndex)
+		{
+			CONFIRM(threadLabelIDs[threadIndex][labelIndex] == expectedID);
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint PROFILER_MAX_LABELS = 4096;
+constexpr uint PROFILER_UNKNOWN_LABEL = 0;			// what ProfilerInternLabel hands out once the table is full
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Profiler labels are interned once to a 32-bit ID and samples only ever store the ID. The same text always gives
+// back the same ID, from any thread. Looking up a label that is already interned doesn't lock, only adding a new one does.
+// The text is copied, so the label passed in doesn't have to outlive the call. Labels are never removed.
+// PROFILE_SCOPE interns once per call site, so only ProfilerPush(char const*) pays for the lookup on every call.
+//------------------------------------------------------------------------------------------------------------------------------
+uint				ProfilerInternLabel(char const* label);
+char const*			ProfilerGetLabel(uint labelID);
+uint				ProfilerGetNumLabels();
\ No newline at end of file
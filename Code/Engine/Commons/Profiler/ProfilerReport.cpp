@@ -2,12 +2,15 @@
 //------------------------------------------------------------------------------------------------------------------------------
 #include "Engine/Commons/EngineCommon.hpp"
 #include "Engine/Commons/Profiler/Profiler.hpp"
+#include "Engine/Commons/Profiler/ProfilerLabels.hpp"
+#include "Engine/Commons/Profiler/ProfilerSample.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/NamedProperties.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/WindowContext.hpp"
 #include "Engine/Renderer/ImGUISystem.hpp"
 #include "ThirdParty/imGUI/imgui_internal.h"
-#include <string.h>
 #include <algorithm>
 
 ProfilerReport* gProfileReporter = nullptr;
@@ -29,19 +32,26 @@ ProfilerReportNode* ProfilerReport::GetFrameInHistory(uint history /*= 1*/)
 {
 	Profiler* profiler = gProfiler->GetInstance();
 
-	ProfilerSample_T* sample = profiler->ProfilerAcquirePreviousTreeForCallingThread(history);
+	ProfilerTree_T* tree = profiler->ProfilerAcquirePreviousTreeForCallingThread(history);
+	if (tree == nullptr)
+	{
+		return m_root;
+	}
 
 	if (m_activeMode == FLAT_VIEW)
 	{
 		//We want flat view
-		GenerateFlatFromFrame(sample);
+		GenerateFlatFromFrame(tree);
 	}
 	else
 	{
 		//Traverse the tree and create duplicate tree for Reporting
-		GenerateTreeFromFrame(sample);
+		GenerateTreeFromFrame(tree);
 	}
 
+	//The report nodes have everything they need, the tree can go
+	profiler->ProfilerReleaseTree(tree);
+
 	//Return the root as it now has the frame tree
 	return m_root;
 }
@@ -57,10 +67,11 @@ void ProfilerReport::InitializeReporter()
 {
 	g_eventSystem->SubscribeEventCallBackFn("ProfilerReportFrame", Command_ProfilerReportFrame);
 	g_eventSystem->SubscribeEventCallBackFn("ProfilerToggleMode", Command_ProfilerToggleMode);
+	g_eventSystem->SubscribeEventCallBackFn("ProfilerAggregate", Command_ProfilerAggregate);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void ProfilerReport::GenerateTreeFromFrame(ProfilerSample_T* root)
+void ProfilerReport::GenerateTreeFromFrame(ProfilerTree_T const* tree)
 {
 	if (m_root != nullptr)
 	{
@@ -68,7 +79,7 @@ void ProfilerReport::GenerateTreeFromFrame(ProfilerSample_T* root)
 		m_root = nullptr;
 	}
 
-	m_root = new ProfilerReportNode(root);
+	m_root = new ProfilerReportNode(tree);
 
 	if (m_sortSelfTime != 0)
 	{
@@ -81,9 +92,9 @@ void ProfilerReport::GenerateTreeFromFrame(ProfilerSample_T* root)
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void ProfilerReport::GenerateFlatFromFrame(ProfilerSample_T* root)
+void ProfilerReport::GenerateFlatFromFrame(ProfilerTree_T const* tree)
 {
-	GenerateTreeFromFrame(root);
+	GenerateTreeFromFrame(tree);
 	m_flatViewVector.clear();
 
 	//m_flatViewVector.push_back(m_root);
@@ -183,7 +194,7 @@ void ProfilerReport::DrawTreeViewAsImGUIWidget(uint history)
 	}
 	
 
-	if (m_activeMode == FLAT_VIEW)
+	if (m_activeMode != TREE_VIEW)
 	{
 		ImGui::End();
 		return;
@@ -284,7 +295,7 @@ void ProfilerReport::DrawFlatViewAsImGUIWidget(uint history)
 		DrawFlatViewAsImGUIWidget(m_lastHistoryFrame);
 	}
 
-	if (m_activeMode == TREE_VIEW)
+	if (m_activeMode != FLAT_VIEW)
 	{
 		ImGui::End();
 		return;
@@ -313,6 +324,95 @@ void ProfilerReport::DrawFlatViewAsImGUIWidget(uint history)
 	ImGui::End();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerReport::DrawAggregateViewAsImGUIWidget()
+{
+	GenerateAggregateReport();
+
+	//create and populate the imGUI widget
+	ImGui::Begin("Aggregate View Window");
+	ImGui::SetWindowPos(ImVec2(50, 350));
+	ImGui::SetWindowSize(ImVec2(1650, 450));
+
+	m_clicked = 0;
+	if (ImGui::Button("Toggle Mode"))
+		m_clicked++;
+	if (m_clicked & 1)
+	{
+		ImGui::SameLine();
+		ImGui::Text("Toggled Profiler Mode");
+		EventArgs args;
+		gProfileReporter->Command_ProfilerToggleMode(args);
+	}
+
+	ImGui::SameLine();
+	if (ImGui::Button("Sort by total Time"))
+		m_sortTotalTime++;
+
+	ImGui::SameLine();
+	if (ImGui::Button("Sort by self Time"))
+		m_sortSelfTime++;
+
+	//Unsorted keeps the paths in tree order, sorting is by the p99 so the hitches float to the top
+	if (m_sortTotalTime & 1)
+	{
+		std::sort(m_aggregateStats.begin(), m_aggregateStats.end(), [](ProfilerAggregateStats_T const& a, ProfilerAggregateStats_T const& b) { return a.m_p99TotalTime > b.m_p99TotalTime; });
+	}
+	else if (m_sortSelfTime & 1)
+	{
+		std::sort(m_aggregateStats.begin(), m_aggregateStats.end(), [](ProfilerAggregateStats_T const& a, ProfilerAggregateStats_T const& b) { return a.m_p99SelfTime > b.m_p99SelfTime; });
+	}
+
+	if (m_activeMode != AGGREGATE_VIEW)
+	{
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("%llu frames in the history window", gProfiler->GetInstance()->GetAggregate().GetNumTrees());
+	ImGui::Spacing();
+
+	ImGui::Columns(11, "aggregatecolumns");
+	ImGui::Separator();
+	ImGui::Text("Path"); ImGui::NextColumn();
+	ImGui::Text("Calls"); ImGui::NextColumn();
+	ImGui::Text("Mean Total"); ImGui::NextColumn();
+	ImGui::Text("p50 Total"); ImGui::NextColumn();
+	ImGui::Text("p95 Total"); ImGui::NextColumn();
+	ImGui::Text("p99 Total"); ImGui::NextColumn();
+	ImGui::Text("Max Total"); ImGui::NextColumn();
+	ImGui::Text("Mean Self"); ImGui::NextColumn();
+	ImGui::Text("p99 Self"); ImGui::NextColumn();
+	ImGui::Text("Max Self"); ImGui::NextColumn();
+	ImGui::Text("Alloc Bytes per Call"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (ProfilerAggregateStats_T const& stats : m_aggregateStats)
+	{
+		ImGui::Text("%*s%s", stats.m_depth * 2, "", stats.m_path.c_str()); ImGui::NextColumn();
+		ImGui::Text("%llu", stats.m_numCalls); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_meanTotalTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_p50TotalTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_p95TotalTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_p99TotalTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_maxTotalTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_meanSelfTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_p99SelfTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.3f ms", stats.m_maxSelfTime * 1000.0); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.m_meanAllocationSize); ImGui::NextColumn();
+	}
+
+	ImGui::EndColumns();
+	ImGui::End();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+std::vector<ProfilerAggregateStats_T> const& ProfilerReport::GenerateAggregateReport()
+{
+	gProfiler->GetInstance()->GetAggregate().GetStats(m_aggregateStats);
+	return m_aggregateStats;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void ProfilerReport::SetReportMode(ProfilerReportMode mode)
 {
@@ -336,6 +436,30 @@ STATIC bool ProfilerReport::Command_ProfilerReportFrame(EventArgs& args)
 	return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool ProfilerReport::Command_ProfilerAggregate(EventArgs& args)
+{
+	int count = args.GetValue("Count", 20);
+
+	ProfilerReport* reporter = ProfilerReport::GetInstance();
+	std::vector<ProfilerAggregateStats_T> stats = reporter->GenerateAggregateReport();
+
+	//Worst p99 first, that's where the hitches are
+	std::sort(stats.begin(), stats.end(), [](ProfilerAggregateStats_T const& a, ProfilerAggregateStats_T const& b) { return a.m_p99TotalTime > b.m_p99TotalTime; });
+
+	g_devConsole->PrintString(DevConsole::CONSOLE_INFO, Stringf("> Profiler aggregate over %llu frames (calls, mean, p50, p95, p99, max total ms | mean, p99, max self ms | alloc bytes per call)", gProfiler->GetInstance()->GetAggregate().GetNumTrees()));
+	for (int statIndex = 0; statIndex < count && statIndex < (int)stats.size(); ++statIndex)
+	{
+		ProfilerAggregateStats_T const& pathStats = stats[statIndex];
+		std::string printString = Stringf("   %-40s %7llu %8.3f %8.3f %8.3f %8.3f %8.3f | %8.3f %8.3f %8.3f | %10.1f", pathStats.m_path.c_str(), pathStats.m_numCalls,
+			pathStats.m_meanTotalTime * 1000.0, pathStats.m_p50TotalTime * 1000.0, pathStats.m_p95TotalTime * 1000.0, pathStats.m_p99TotalTime * 1000.0, pathStats.m_maxTotalTime * 1000.0,
+			pathStats.m_meanSelfTime * 1000.0, pathStats.m_p99SelfTime * 1000.0, pathStats.m_maxSelfTime * 1000.0, pathStats.m_meanAllocationSize);
+		g_devConsole->PrintString(DevConsole::CONSOLE_ECHO_COLOR, printString);
+	}
+
+	return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 bool ComparatorTotalTimeSort(ProfilerReportNode* elementA, ProfilerReportNode* elementB)
 {
@@ -398,7 +522,7 @@ void ProfilerReport::AddToFlatViewVector(ProfilerReportNode& rootNode)
 	bool foundElement = false;
 	while (itr != m_flatViewVector.end())
 	{
-		if (strcmp((*itr)->m_label, rootNode.m_label) == 0)
+		if ((*itr)->m_labelID == rootNode.m_labelID)
 		{
 			//We found another one of these function calls
 			(*itr)->m_numCalls++;
@@ -435,7 +559,7 @@ void ProfilerReport::PopulateTreeForImGUI(ProfilerReportNode* root)
 		//ImGui::Text(childIterator->m_label); 
 
 		ImGui::SetNextTreeNodeOpen(true);
-		ImGui::TreeNode(node->m_label);
+		ImGui::TreeNode(node->GetLabel());
 
 		ImGui::NextColumn();
 		ImGui::Text(std::to_string(node->m_numCalls).c_str()); ImGui::NextColumn();
@@ -491,7 +615,7 @@ void ProfilerReport::PopulateFlatForImGUI()
 		//ImGui::Text(childIterator->m_label); 
 
 		ImGui::SetNextTreeNodeOpen(true);
-		ImGui::TreeNode((*nodeItr)->m_label);
+		ImGui::TreeNode((*nodeItr)->GetLabel());
 
 		ImGui::NextColumn();
 		ImGui::Text(std::to_string((*nodeItr)->m_numCalls).c_str()); ImGui::NextColumn();
@@ -520,6 +644,10 @@ bool ProfilerReport::Command_ProfilerToggleMode(EventArgs& args)
 	{
 		gProfileReporter->m_activeMode = FLAT_VIEW;
 	}
+	else if (gProfileReporter->m_activeMode == FLAT_VIEW)
+	{
+		gProfileReporter->m_activeMode = AGGREGATE_VIEW;
+	}
 	else
 	{
 		gProfileReporter->m_activeMode = TREE_VIEW;
@@ -529,39 +657,41 @@ bool ProfilerReport::Command_ProfilerToggleMode(EventArgs& args)
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-ProfilerReportNode::ProfilerReportNode(ProfilerSample_T* node, ProfilerReportNode* parent)
+ProfilerReportNode::ProfilerReportNode(ProfilerTree_T const* tree, uint sampleIndex /*= 0*/, ProfilerReportNode* parent /*= nullptr*/)
 {
+	ProfilerSample_T const* samples = tree->GetSamples();
+	ProfilerSample_T const& sample = samples[sampleIndex];
+
 	//Setup all data on the ReportNode
 	m_parent = parent;
-	if (m_parent == nullptr)
-	{
-		gProfileReporter->SetRoot(this);
-	}
 
-	m_allocationCount = node->m_allocCount;
-	m_allocationSize = node->m_allocationSizeInBytes;
+	m_allocationCount = (int)sample.m_allocCount;
+	m_allocationSize = sample.m_allocationSizeInBytes;
 
-	m_freeCount = node->m_freeCount;
-	m_freedSize = node->m_freeSizeInBytes;
+	m_freeCount = (int)sample.m_freeCount;
+	m_freedSize = sample.m_freeSizeInBytes;
 
 	m_numCalls = 1;
 
-	strcpy_s(m_label, node->m_label);
+	m_labelID = sample.m_labelID;
 
-	m_totalTimeHPC = node->m_endTime - node->m_startTime;
+	m_totalTimeHPC = sample.m_duration;
 	m_totalTime = GetHPCToSeconds(m_totalTimeHPC);
 	m_avgTime = m_totalTime;
 	m_maxTime = m_totalTime;
 
-	//Grab all children
-	if (node->m_lastChild != nullptr)
+	//Grab all children, reserved up front so a child never moves once it has built its own children
+	uint childrenEnd = sampleIndex + sample.m_subtreeSize;
+	uint numChildren = 0;
+	for (uint childIndex = sampleIndex + 1; childIndex < childrenEnd; childIndex += samples[childIndex].m_subtreeSize)
 	{
-		GetChildrenFromSampleRoot(node->m_lastChild, this);
+		++numChildren;
 	}
 
-	if (node->m_prevSibling != nullptr)
+	m_children.reserve(numChildren);
+	for (uint childIndex = sampleIndex + 1; childIndex < childrenEnd; childIndex += samples[childIndex].m_subtreeSize)
 	{
-		GetChildrenFromSampleRoot(node->m_prevSibling, this->m_parent);
+		m_children.emplace_back(tree, childIndex, this);
 	}
 
 	GetSelfTime();
@@ -572,7 +702,7 @@ ProfilerReportNode::ProfilerReportNode(ProfilerSample_T* node, ProfilerReportNod
 	}
 	else
 	{
-		m_totalPercent = (float)gProfileReporter->GetRoot()->m_totalTime / (float)m_totalTime;
+		m_totalPercent = (float)GetHPCToSeconds(tree->GetRoot().m_duration) / (float)m_totalTime;
 		m_totalPercent = 100.f / m_totalPercent;
 	}
 
@@ -588,18 +718,9 @@ ProfilerReportNode::ProfilerReportNode(ProfilerSample_T* node, ProfilerReportNod
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-ProfilerReportNode::~ProfilerReportNode()
+char const* ProfilerReportNode::GetLabel() const
 {
-
-}
-
-//------------------------------------------------------------------------------------------------------------------------------
-void ProfilerReportNode::GetChildrenFromSampleRoot(ProfilerSample_T* root, ProfilerReportNode* parent)
-{
-	if (root != nullptr)
-	{
-		parent->m_children.push_back(ProfilerReportNode(root, parent));
-	}
+	return ProfilerGetLabel(m_labelID);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -620,13 +741,11 @@ void ProfilerReportNode::SortByTotalTime()
 		}
 	}
 
-	for (ProfilerReportNode child : m_children)
+	for (ProfilerReportNode& child : m_children)
 	{
-		(&child)->SortByTotalTime();
+		child.SortByTotalTime();
 	}
 
-	gProfileReporter->SetRoot(this);
-
 	gProfileReporter->m_sortTotalTime = 0;
 }
 
@@ -648,13 +767,11 @@ void ProfilerReportNode::SortBySelfTime()
 		}
 	}
 
-	for (ProfilerReportNode child : m_children)
+	for (ProfilerReportNode& child : m_children)
 	{
-		(&child)->SortBySelfTime();
+		child.SortBySelfTime();
 	}
 
-	gProfileReporter->SetRoot(this);
-
 	gProfileReporter->m_sortSelfTime = 0;
 }
 
@@ -665,7 +782,7 @@ void ProfilerReportNode::GetSelfTime()
 
 	double childrenTime = 0;
 
-	for (ProfilerReportNode child : m_children)
+	for (ProfilerReportNode const& child : m_children)
 	{
 		childrenTime += child.m_totalTime;
 	}
@@ -676,7 +793,7 @@ void ProfilerReportNode::GetSelfTime()
 //------------------------------------------------------------------------------------------------------------------------------
 bool ProfilerReportNode::operator==(const ProfilerReportNode& compare) const
 {
-	if (strcmp(m_label, compare.m_label))
+	if (m_labelID == compare.m_labelID)
 	{
 		//We are equal if we have the same label
 		return true;
@@ -686,3 +803,57 @@ bool ProfilerReportNode::operator==(const ProfilerReportNode& compare) const
 		return false;
 	}
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define REPORTTEST_DEPTH 13
+#define REPORTTEST_CHILDREN 2
+#define REPORTTEST_BUILDS 20
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Pre-order like the collector makes them, every sample takes 1 tick of self time. Returns the sample's duration
+static uint BuildReportTestSamples(std::vector<ProfilerSample_T>& samples, uint depth, uint startOffset)
+{
+	uint sampleIndex = (uint)samples.size();
+	samples.emplace_back();
+	samples[sampleIndex].m_labelID = ProfilerInternLabel(Stringf("ReportTestDepth%u", depth).c_str());
+	samples[sampleIndex].m_startOffset = startOffset;
+
+	uint duration = 1;
+	if (depth + 1 < REPORTTEST_DEPTH)
+	{
+		for (uint childIndex = 0; childIndex < REPORTTEST_CHILDREN; ++childIndex)
+		{
+			duration += BuildReportTestSamples(samples, depth + 1, startOffset + duration);
+		}
+	}
+
+	samples[sampleIndex].m_duration = duration;
+	samples[sampleIndex].m_subtreeSize = (uint)samples.size() - sampleIndex;
+	return duration;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Time to turn one deep frame (8191 samples, 13 levels) into report nodes
+UNITTEST("ProfilerReportBuild", "Profiler", 200)
+{
+	std::vector<ProfilerSample_T> samples;
+	BuildReportTestSamples(samples, 0, 0);
+	ProfilerTree_T* tree = ProfilerTree_T::Create(samples.data(), (uint)samples.size(), 0, std::this_thread::get_id());
+
+	double startTime = GetCurrentTimeSeconds();
+	for (uint buildIndex = 0; buildIndex < REPORTTEST_BUILDS; ++buildIndex)
+	{
+		ProfilerReportNode root(tree);
+
+		CONFIRM(root.m_children.size() == REPORTTEST_CHILDREN && root.m_totalTimeHPC == samples.size());
+		CONFIRM(root.m_selfTime > 0.0 && root.m_children[1].m_children[0].m_labelID == samples[2].m_labelID);
+	}
+	double milliseconds = (GetCurrentTimeSeconds() - startTime) * 1000.0 / (double)REPORTTEST_BUILDS;
+
+	DebuggerPrintf("\n Report for %u samples built in %.3f ms, %zu bytes of samples (%zu per sample)", tree->m_numSamples, milliseconds, tree->GetByteSize(), sizeof(ProfilerSample_T));
+
+	ProfilerTree_T::Destroy(tree);
+	return true;
+}
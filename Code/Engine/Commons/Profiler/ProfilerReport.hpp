@@ -1,25 +1,25 @@
 #pragma once
+#include "Engine/Commons/Profiler/ProfilerAggregate.hpp"
 #include "Engine/Core/EventSystems.hpp"
 #include <string>
 #include <vector>
 
 typedef unsigned int uint;
-struct ProfilerSample_T;
+struct ProfilerTree_T;
 
 enum ProfilerReportMode
 {
 	TREE_VIEW,
-	FLAT_VIEW
+	FLAT_VIEW,
+	AGGREGATE_VIEW
 };
 
 //------------------------------------------------------------------------------------------------------------------------------
 class ProfilerReportNode
 {
 public:
-	ProfilerReportNode(ProfilerSample_T* node, ProfilerReportNode* parent = nullptr);
-	~ProfilerReportNode();
-
-	void					GetChildrenFromSampleRoot(ProfilerSample_T* root, ProfilerReportNode* parent);
+	//Builds the node for the sample at sampleIndex and everything under it
+	ProfilerReportNode(ProfilerTree_T const* tree, uint sampleIndex = 0, ProfilerReportNode* parent = nullptr);
 
 	void					SortByTotalTime();
 	void					SortBySelfTime();
@@ -39,7 +39,8 @@ public:
 	float					m_totalPercent = 0.0f;
 	float					m_selfPercent = 0.0f;
 
-	char					m_label[64];
+	uint					m_labelID = 0;
+	char const*				GetLabel() const;
 
 	//Optional:
 	uint64_t				m_totalTimeHPC = 0U;
@@ -77,6 +78,10 @@ public:
 
 	void					DrawTreeViewAsImGUIWidget(uint history);
 	void					DrawFlatViewAsImGUIWidget(uint history);
+	void					DrawAggregateViewAsImGUIWidget();
+
+	//Stats for every label path over the whole history window instead of a single frame
+	std::vector<ProfilerAggregateStats_T> const&	GenerateAggregateReport();
 
 	void					SetReportMode(ProfilerReportMode mode);
 	ProfilerReportMode		GetMode() { return m_activeMode; }
@@ -89,8 +94,8 @@ public:
 private:
 	void					InitializeReporter();
 
-	void					GenerateTreeFromFrame(ProfilerSample_T* root);
-	void					GenerateFlatFromFrame(ProfilerSample_T* root);
+	void					GenerateTreeFromFrame(ProfilerTree_T const* tree);
+	void					GenerateFlatFromFrame(ProfilerTree_T const* tree);
 	void					AddToFlatViewVector(ProfilerReportNode& rootNode);
 
 	void					PopulateTreeForImGUI(ProfilerReportNode* root);
@@ -98,6 +103,7 @@ private:
 
 	static bool				Command_ProfilerToggleMode(EventArgs& args);
 	static bool				Command_ProfilerReportFrame(EventArgs& args);
+	static bool				Command_ProfilerAggregate(EventArgs& args);
 
 	ProfilerReportNode*		m_root = nullptr;
 
@@ -108,5 +114,6 @@ private:
 	int						m_clicked = 0;
 
 	std::vector<ProfilerReportNode*>	m_flatViewVector;
+	std::vector<ProfilerAggregateStats_T>	m_aggregateStats;
 	void GenerateFlatViewVector(ProfilerReportNode* m_root);
 };
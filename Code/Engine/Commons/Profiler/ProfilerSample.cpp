@@ -1,12 +1,28 @@
 #include "Engine/Commons/Profiler/ProfilerSample.hpp"
 //------------------------------------------------------------------------------------------------------------------------------
-#include "Engine/Allocators/BlockAllocator.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Core/MemTracking.hpp"
+#include <new>
+#include <string.h>
 
 //------------------------------------------------------------------------------------------------------------------------------
-void ProfilerSample_T::AddChild(ProfilerSample_T* child)
+STATIC ProfilerTree_T* ProfilerTree_T::Create(ProfilerSample_T const* samples, uint numSamples, uint64_t startTime, std::thread::id threadID)
 {
-	child->m_parent = this;
-	child->m_prevSibling = m_lastChild;
-	m_lastChild = child;
+	//The profiler's own memory stays out of the allocation counters it is reporting
+	void* buffer = UntrackedAlloc(sizeof(ProfilerTree_T) + numSamples * sizeof(ProfilerSample_T));
+
+	ProfilerTree_T* tree = new (buffer) ProfilerTree_T();
+	tree->m_startTime = startTime;
+	tree->m_threadID = threadID;
+	tree->m_numSamples = numSamples;
+	memcpy(tree->GetSamples(), samples, numSamples * sizeof(ProfilerSample_T));
+
+	return tree;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void ProfilerTree_T::Destroy(ProfilerTree_T* tree)
+{
+	tree->~ProfilerTree_T();
+	UntrackedFree(tree);
 }
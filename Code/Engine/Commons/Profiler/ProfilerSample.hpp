@@ -1,37 +1,53 @@
 #pragma once
 //------------------------------------------------------------------------------------------------------------------------------
+#include <atomic>
+#include <stdint.h>
 #include <thread>
-#include <vector>
-#include <shared_mutex>
 //------------------------------------------------------------------------------------------------------------------------------
 typedef unsigned int uint;
 
 //------------------------------------------------------------------------------------------------------------------------------
+// One profiled scope, 32 bytes. Times are HPC ticks relative to the tree's start and everything saturates at UINT_MAX
+// Samples are stored in pre-order: a sample's children follow it and its next sibling is at index + m_subtreeSize
 struct ProfilerSample_T
 {
-	//Parent Node
-	ProfilerSample_T*			m_parent = nullptr;
+	uint						m_labelID = 0;				// see ProfilerGetLabel
+	uint						m_subtreeSize = 1;			// this sample and everything under it
 
-	//Node's children
-	ProfilerSample_T*			m_lastChild = nullptr;
-	ProfilerSample_T*			m_prevSibling = nullptr;
+	//Timing
+	uint						m_startOffset = 0;
+	uint						m_duration = 0;
 
-	char						m_label[64];
+	// memory
+	// alloc_count, byte_count
+	uint						m_allocCount = 0;
+	uint						m_allocationSizeInBytes = 0;
 
-	//Timing
-	uint64_t					m_startTime = 0;
-	uint64_t					m_endTime = 0;
+	uint						m_freeCount = 0;
+	uint						m_freeSizeInBytes = 0;
+};
 
+//------------------------------------------------------------------------------------------------------------------------------
+// A finished tree is one allocation: this header followed by m_numSamples samples, the root first
+struct ProfilerTree_T
+{
+	uint64_t					m_startTime = 0;
 	std::thread::id				m_threadID;
-	uint						m_refCount = 0;
+	std::atomic<uint>			m_refCount = 1;
+	uint						m_numSamples = 0;
 
-	// memory
-	// alloc_count, byte_count
-	int							m_allocCount = 0;
-	size_t						m_allocationSizeInBytes = 0;
+	ProfilerSample_T*			GetSamples()				{ return (ProfilerSample_T*)(this + 1); }
+	ProfilerSample_T const*		GetSamples() const			{ return (ProfilerSample_T const*)(this + 1); }
+	ProfilerSample_T const&		GetRoot() const				{ return GetSamples()[0]; }
+	uint64_t					GetEndTime() const			{ return m_startTime + GetRoot().m_startOffset + GetRoot().m_duration; }
+	size_t						GetByteSize() const			{ return sizeof(ProfilerTree_T) + m_numSamples * sizeof(ProfilerSample_T); }
 
-	int							m_freeCount = 0;
-	size_t						m_freeSizeInBytes = 0;
+	static ProfilerTree_T*		Create(ProfilerSample_T const* samples, uint numSamples, uint64_t startTime, std::thread::id threadID);
+	static void					Destroy(ProfilerTree_T* tree);
+};
 
-	void						AddChild(ProfilerSample_T* child);
-};
\ No newline at end of file
+//------------------------------------------------------------------------------------------------------------------------------
+inline uint ProfilerSaturate(uint64_t value)
+{
+	return (value > UINT32_MAX) ? UINT32_MAX : (uint)value;
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "Engine/Commons/Profiler/ProfilerTraceExport.hpp"
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/Profiler/ProfilerLabels.hpp"
+#include "Engine/Commons/Profiler/ProfilerSample.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <sstream>
+#include <stdio.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfilerTraceWriter::ProfilerTraceWriter()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+ProfilerTraceWriter::~ProfilerTraceWriter()
+{
+	Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool ProfilerTraceWriter::Open(std::string const& fileName)
+{
+	Close();
+
+	m_fileStream = CreateTextFileWriteBuffer(fileName);
+	if (!m_fileStream->is_open())
+	{
+		delete m_fileStream;
+		m_fileStream = nullptr;
+		return false;
+	}
+
+	m_threadIDs.clear();
+	m_baseTime = 0;
+	m_numEventsWritten = 0;
+
+	*m_fileStream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerTraceWriter::WriteTree(ProfilerTree_T const* tree)
+{
+	if (m_fileStream == nullptr || tree == nullptr)
+	{
+		return;
+	}
+
+	if (m_baseTime == 0)
+	{
+		m_baseTime = tree->m_startTime;
+	}
+
+	//Pre-order already, so the events come out the way the scopes opened
+	uint threadIndex = GetThreadIndex(tree->m_threadID);
+	ProfilerSample_T const* samples = tree->GetSamples();
+	for (uint sampleIndex = 0; sampleIndex < tree->m_numSamples; ++sampleIndex)
+	{
+		WriteSample(samples[sampleIndex], tree->m_startTime, threadIndex);
+	}
+
+	FlushText();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerTraceWriter::WriteInstantEvent(char const* name, uint64_t time, std::thread::id threadID, std::string const& args)
+{
+	if (m_fileStream == nullptr)
+	{
+		return;
+	}
+
+	if (m_baseTime == 0)
+	{
+		m_baseTime = time;
+	}
+
+	//Thread scoped so it shows up as a marker on that thread's track
+	double eventTime = GetTraceTime(time);
+	m_text += (m_numEventsWritten > 0) ? ",\n" : "";
+	m_text += Stringf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{%s}}", name, GetThreadIndex(threadID), eventTime, args.c_str());
+	++m_numEventsWritten;
+
+	FlushText();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerTraceWriter::Close()
+{
+	if (m_fileStream == nullptr)
+	{
+		return;
+	}
+
+	//Name the thread tracks last, we only know every thread once we are done
+	for (uint threadIndex = 0; threadIndex < (uint)m_threadIDs.size(); ++threadIndex)
+	{
+		std::ostringstream threadIDStream;
+		threadIDStream << m_threadIDs[threadIndex];
+
+		m_text += (m_numEventsWritten > 0) ? ",\n" : "";
+		m_text += Stringf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u (%s)\"}}", threadIndex, threadIndex, threadIDStream.str().c_str());
+		++m_numEventsWritten;
+	}
+
+	m_text += "\n]}\n";
+	FlushText();
+
+	m_fileStream->close();
+	delete m_fileStream;
+	m_fileStream = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerTraceWriter::WriteSample(ProfilerSample_T const& sample, uint64_t treeStartTime, uint threadIndex)
+{
+	//Chrome wants microseconds
+	double startTime = GetTraceTime(treeStartTime + sample.m_startOffset);
+	double duration = GetHPCToSeconds(sample.m_duration) * 1'000'000.0;
+
+	//Labels are code identifiers, just keep anything that would break the JSON string out of them
+	char label[64];
+	uint labelLength = 0;
+	for (char const* character = ProfilerGetLabel(sample.m_labelID); *character != '\0' && labelLength < sizeof(label) - 1; ++character)
+	{
+		if (*character != '"' && *character != '\\' && (unsigned char)*character >= ' ')
+		{
+			label[labelLength++] = *character;
+		}
+	}
+	label[labelLength] = '\0';
+
+	m_text += (m_numEventsWritten > 0) ? ",\n" : "";
+	m_text += Stringf("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"allocCount\":%u,\"allocBytes\":%u,\"freeCount\":%u,\"freeBytes\":%u}}",
+		label, threadIndex, startTime, duration, sample.m_allocCount, sample.m_allocationSizeInBytes, sample.m_freeCount, sample.m_freeSizeInBytes);
+	++m_numEventsWritten;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ProfilerTraceWriter::GetThreadIndex(std::thread::id threadID)
+{
+	for (uint threadIndex = 0; threadIndex < (uint)m_threadIDs.size(); ++threadIndex)
+	{
+		if (m_threadIDs[threadIndex] == threadID)
+		{
+			return threadIndex;
+		}
+	}
+
+	m_threadIDs.push_back(threadID);
+	return (uint)m_threadIDs.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+double ProfilerTraceWriter::GetTraceTime(uint64_t time) const
+{
+	//Trees come in the order they finished, a later one can still have started before the first
+	if (time < m_baseTime)
+	{
+		return -GetHPCToSeconds(m_baseTime - time) * 1'000'000.0;
+	}
+
+	return GetHPCToSeconds(time - m_baseTime) * 1'000'000.0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ProfilerTraceWriter::FlushText()
+{
+	m_fileStream->write(m_text.data(), m_text.size());
+	m_text.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+static int CountOccurrences(std::string const& text, char const* token)
+{
+	int count = 0;
+	for (size_t position = text.find(token); position != std::string::npos; position = text.find(token, position + 1))
+	{
+		++count;
+	}
+
+	return count;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ProfilerTraceExport", "Profiler", 100)
+{
+	//Two frames on one thread and one on another, the second thread's has a label that needs cleaning up
+	std::thread::id otherThreadID;
+	std::thread otherThread([&]() { otherThreadID = std::this_thread::get_id(); });
+	otherThread.join();
+
+	ProfilerSample_T samples[2];
+	samples[0].m_labelID = ProfilerInternLabel("Frame");
+	samples[0].m_subtreeSize = 2;
+	samples[0].m_duration = 160;
+	samples[1].m_labelID = ProfilerInternLabel("Update");
+	samples[1].m_startOffset = 100;
+	samples[1].m_duration = 50;
+	ProfilerTree_T* firstFrame = ProfilerTree_T::Create(samples, 2, 1000, std::this_thread::get_id());
+
+	samples[1].m_labelID = ProfilerInternLabel("Render");
+	samples[1].m_startOffset = 200;
+	samples[1].m_allocCount = 3;
+	samples[1].m_allocationSizeInBytes = 96;
+	samples[0].m_duration = 260;
+	ProfilerTree_T* secondFrame = ProfilerTree_T::Create(samples, 2, 1200, std::this_thread::get_id());
+
+	samples[0] = ProfilerSample_T();
+	samples[0].m_labelID = ProfilerInternLabel("Job \"Quoted\"");
+	samples[0].m_duration = 50;
+	ProfilerTree_T* job = ProfilerTree_T::Create(samples, 1, 1300, otherThreadID);
+
+	std::string fileName = "ProfilerTraceExportTest.json";
+	ProfilerTraceWriter writer;
+	CONFIRM(writer.Open(fileName));
+	writer.WriteTree(firstFrame);
+	writer.WriteTree(job);
+	writer.WriteTree(secondFrame);
+	writer.WriteInstantEvent("Hitch", 1200, std::this_thread::get_id(), "\"frameMs\":2.5");
+	writer.Close();
+
+	ProfilerTree_T::Destroy(firstFrame);
+	ProfilerTree_T::Destroy(secondFrame);
+	ProfilerTree_T::Destroy(job);
+	CONFIRM(!writer.IsOpen());
+
+	//5 samples, the marker and 2 thread names
+	CONFIRM(writer.GetNumEventsWritten() == 8);
+
+	char* fileData = nullptr;
+	unsigned long fileSize = CreateFileReadBuffer(fileName, &fileData);
+	std::string text(fileData, fileSize);
+	delete[] fileData;
+	remove(fileName.c_str());
+
+	CONFIRM(text.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+	CONFIRM(text.find("]}") != std::string::npos);
+	CONFIRM(CountOccurrences(text, "\"ph\":\"X\"") == 5 && CountOccurrences(text, "\"ph\":\"M\"") == 2);
+	CONFIRM(text.find("{\"name\":\"Hitch\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":0,\"ts\":") != std::string::npos && text.find("\"args\":{\"frameMs\":2.5}}") != std::string::npos);
+	CONFIRM(CountOccurrences(text, "{") == CountOccurrences(text, "}") && CountOccurrences(text, "\"") % 2 == 0);
+	CONFIRM(text.find("\"name\":\"Job Quoted\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":") != std::string::npos);
+	CONFIRM(text.find("\"name\":\"Render\",\"ph\":\"X\",\"pid\":0,\"tid\":0,") != std::string::npos);
+	CONFIRM(text.find("\"allocCount\":3,\"allocBytes\":96,") != std::string::npos);
+	CONFIRM(text.find("\"name\":\"Frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":0.000,") != std::string::npos);
+
+	return true;
+}
\ No newline at end of file
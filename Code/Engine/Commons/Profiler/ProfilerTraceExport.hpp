@@ -0,0 +1,46 @@
+#pragma once
+//------------------------------------------------------------------------------------------------------------------------------
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ProfilerSample_T;
+struct ProfilerTree_T;
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Writes profiler trees as a Chrome Trace Event JSON file, which chrome://tracing and ui.perfetto.dev both open.
+// Every sample becomes a complete ("X") event on the track of the thread that recorded it, with its allocation counts
+// as args. Trees can be written as they finish so a capture can keep streaming to disk, Close finishes the JSON.
+// Thread tracks are named with the OS thread ID so they can be matched up with a debugger or a crash dump.
+//------------------------------------------------------------------------------------------------------------------------------
+class ProfilerTraceWriter
+{
+public:
+	ProfilerTraceWriter();
+	~ProfilerTraceWriter();
+
+	bool						Open(std::string const& fileName);
+	void						WriteTree(ProfilerTree_T const* tree);
+	void						WriteInstantEvent(char const* name, uint64_t time, std::thread::id threadID, std::string const& args);	// args is the body of a JSON object
+	void						Close();
+
+	bool						IsOpen() const				{ return m_fileStream != nullptr; }
+	uint						GetNumEventsWritten() const	{ return m_numEventsWritten; }
+
+private:
+	void						WriteSample(ProfilerSample_T const& sample, uint64_t treeStartTime, uint threadIndex);
+	uint						GetThreadIndex(std::thread::id threadID);
+	double						GetTraceTime(uint64_t time) const;		// microseconds since m_baseTime, can be negative
+	void						FlushText();
+
+private:
+	std::ofstream*				m_fileStream = nullptr;
+	std::string					m_text;						// built up per tree, then handed to the stream in one write
+
+	std::vector<std::thread::id>	m_threadIDs;			// index in here is the tid in the trace
+	uint64_t					m_baseTime = 0;				// HPC time of the first tree, trace times are relative to it
+	uint						m_numEventsWritten = 0;
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: This is a bounded lock-free Multiple Producer Multiple Consumer queue (Dmitry Vyukov's design). Every cell carries a
+// sequence number that tells producers and consumers whose turn it is to use it, so the only shared writes are one CAS on
+// the enqueue or dequeue position. The capacity is fixed on construction (rounded up to a power of 2).
+// The Try methods never block. Enqueue and Dequeue yield the thread until they succeed.
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+class MPMCAsyncQueue
+{
+public:
+	explicit MPMCAsyncQueue(size_t capacity = 4096);
+	~MPMCAsyncQueue();
+
+	bool						TryEnqueue(TYPE const& element);	// returns false if the queue is full
+	bool						TryDequeue(TYPE* out);				// returns false if the queue is empty
+
+	void						Enqueue(TYPE const& element);		// blocks until there is space in the queue
+	void						Dequeue(TYPE* out);					// blocks until there is an element in the queue
+
+	int							GetLength() const;					// only a snapshot, may be stale as soon as it returns
+	size_t						GetCapacity() const					{ return m_mask + 1; }
+
+private:
+	struct Cell_T
+	{
+		std::atomic<size_t>		sequence;
+		TYPE					data;
+	};
+
+	Cell_T*						m_cells = nullptr;
+	size_t						m_mask = 0;
+
+	//Producers and consumers each get their own cache line
+	alignas(64) std::atomic<size_t>		m_enqueuePosition;
+	alignas(64) std::atomic<size_t>		m_dequeuePosition;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+MPMCAsyncQueue<TYPE>::MPMCAsyncQueue(size_t capacity /*= 4096*/)
+{
+	size_t powerOf2Capacity = 2;
+	while (powerOf2Capacity < capacity)
+	{
+		powerOf2Capacity <<= 1;
+	}
+
+	m_cells = new Cell_T[powerOf2Capacity];
+	m_mask = powerOf2Capacity - 1;
+
+	for (size_t cellIndex = 0; cellIndex < powerOf2Capacity; ++cellIndex)
+	{
+		m_cells[cellIndex].sequence.store(cellIndex, std::memory_order_relaxed);
+	}
+
+	m_enqueuePosition.store(0, std::memory_order_relaxed);
+	m_dequeuePosition.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+MPMCAsyncQueue<TYPE>::~MPMCAsyncQueue()
+{
+	delete[] m_cells;
+	m_cells = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool MPMCAsyncQueue<TYPE>::TryEnqueue(TYPE const& element)
+{
+	Cell_T* cell = nullptr;
+	size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+		if (difference == 0)
+		{
+			//Cell is free for this position, try to claim it
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			//Cell still holds an element from the previous lap, we are full
+			return false;
+		}
+		else
+		{
+			//Another producer beat us here
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->data = element;
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool MPMCAsyncQueue<TYPE>::TryDequeue(TYPE* out)
+{
+	Cell_T* cell = nullptr;
+	size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+		if (difference == 0)
+		{
+			//Cell has been published for this position, try to claim it
+			if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			//Nothing has been written here yet, we are empty
+			return false;
+		}
+		else
+		{
+			//Another consumer beat us here
+			position = m_dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	*out = cell->data;
+	//Hand the cell back to producers for the next lap around the buffer
+	cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+void MPMCAsyncQueue<TYPE>::Enqueue(TYPE const& element)
+{
+	while (!TryEnqueue(element))
+	{
+		std::this_thread::yield();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+void MPMCAsyncQueue<TYPE>::Dequeue(TYPE* out)
+{
+	while (!TryDequeue(out))
+	{
+		std::this_thread::yield();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+int MPMCAsyncQueue<TYPE>::GetLength() const
+{
+	size_t enqueuePosition = m_enqueuePosition.load(std::memory_order_relaxed);
+	size_t dequeuePosition = m_dequeuePosition.load(std::memory_order_relaxed);
+
+	return (enqueuePosition > dequeuePosition) ? (int)(enqueuePosition - dequeuePosition) : 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "Engine/Core/Async/MPMCAsyncQueue.hpp"
+#include "Engine/Core/Async/RingBufferTypes.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Fixed capacity Multiple Producer Multiple Consumer ring buffer on top of MPMCAsyncQueue, which already writes every
+// element in place into a slot with its own sequence number and never allocates after construction.
+// In RING_BUFFER_OVERWRITE_OLDEST mode a producer that finds the buffer full pops the oldest element itself and retries.
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+class MPMCRingBuffer
+{
+public:
+	explicit MPMCRingBuffer(size_t capacity, eRingBufferMode mode = RING_BUFFER_REJECT_WHEN_FULL);
+
+	//Returns false if the element was rejected, overwrite mode always succeeds
+	bool						Push(TYPE const& element);
+
+	//Returns false if there was nothing to read
+	bool						Pop(TYPE* out)						{ return m_queue.TryDequeue(out); }
+
+	int							GetLength() const					{ return m_queue.GetLength(); }
+	size_t						GetCapacity() const					{ return m_queue.GetCapacity(); }
+	eRingBufferMode				GetMode() const						{ return m_mode; }
+	uint64_t					GetNumOverwritten() const			{ return m_numOverwritten.load(std::memory_order_relaxed); }
+
+private:
+	MPMCAsyncQueue<TYPE>		m_queue;
+	eRingBufferMode				m_mode = RING_BUFFER_REJECT_WHEN_FULL;
+
+	std::atomic<uint64_t>		m_numOverwritten;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+MPMCRingBuffer<TYPE>::MPMCRingBuffer(size_t capacity, eRingBufferMode mode /*= RING_BUFFER_REJECT_WHEN_FULL*/)
+	: m_queue(capacity)
+	, m_mode(mode)
+{
+	m_numOverwritten.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool MPMCRingBuffer<TYPE>::Push(TYPE const& element)
+{
+	if (m_queue.TryEnqueue(element))
+	{
+		return true;
+	}
+
+	if (m_mode == RING_BUFFER_REJECT_WHEN_FULL)
+	{
+		return false;
+	}
+
+	TYPE dropped;
+	while (!m_queue.TryEnqueue(element))
+	{
+		//Less than full means a consumer has claimed the slot we need and is still reading it, dropping now would lose a
+		//newer element than necessary
+		if ((size_t)m_queue.GetLength() < m_queue.GetCapacity())
+		{
+			std::this_thread::yield();
+		}
+		else if (m_queue.TryDequeue(&dropped))
+		{
+			m_numOverwritten.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -1,5 +1,20 @@
 #include "Engine/Core/Async/MPSCAsyncRingBuffer.hpp"
+#include "Engine/Core/Async/SPSCRingBuffer.hpp"
+#include "Engine/Core/Async/MPMCRingBuffer.hpp"
 #include "Engine/Commons/ErrorWarningAssert.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <string.h>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+static size_t GetRecordSize(size_t writeSize)
+{
+	size_t paddedSize = (writeSize + RING_BUFFER_RECORD_ALIGNMENT - 1) & ~(RING_BUFFER_RECORD_ALIGNMENT - 1);
+	return RING_BUFFER_HEADER_SIZE + paddedSize;
+}
 
 //------------------------------------------------------------------------------------------------------------------------------
 MPSCRingBuffer::MPSCRingBuffer()
@@ -18,8 +33,15 @@ bool MPSCRingBuffer::InitializeBuffer(size_t sizeInBytes)
 {
 	if (m_buffer == nullptr)
 	{
-		m_buffer = (byte*)malloc(sizeInBytes);
-		m_byteSize = sizeInBytes;
+		//Records are 8 byte multiples so keep the buffer one too, that way a header slot never straddles the end
+		m_byteSize = sizeInBytes & ~(RING_BUFFER_RECORD_ALIGNMENT - 1);
+		m_buffer = (byte*)malloc(m_byteSize);
+
+		//A zeroed meta reads as not yet committed which is what the reader expects in space nobody has written to
+		ClearMetas(0U, m_byteSize);
+
+		m_writeHead = 0U;
+		m_readHead = 0U;
 		return true;
 	}
 	else
@@ -41,52 +63,88 @@ void MPSCRingBuffer::ReleaseBuffer()
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-void* MPSCRingBuffer::TryLockWrite(size_t writeSize)
+std::atomic<RingBufferMeta_T>* MPSCRingBuffer::GetMetaAt(uint64_t position) const
 {
-	ASSERT_OR_DIE(writeSize < (1 << 31), "The size of object to write exceeded the total size of the MPSC ring buffer");
+	return (std::atomic<RingBufferMeta_T>*)(m_buffer + (position % m_byteSize));
+}
 
-	size_t metaDataSize = sizeof(RingBufferMeta_T);
-	size_t totalSize = 2 * metaDataSize + writeSize;
+//------------------------------------------------------------------------------------------------------------------------------
+void MPSCRingBuffer::ClearMetas(uint64_t position, size_t byteSize)
+{
+	//Records start on 8 byte boundaries so any of these slots could be read as a meta later on
+	RingBufferMeta_T emptyMeta;
+	emptyMeta.bufferObjectSize = 0;
+	emptyMeta.isBufferObjectUnlocked = 0;
 
-	//If the space available is less than the size of meta data + write data, return nullptr
-	std::scoped_lock lock(m_lock);
-	if (GetWritableSpace() < totalSize) 
+	for (size_t slotOffset = 0; slotOffset < byteSize; slotOffset += RING_BUFFER_RECORD_ALIGNMENT)
 	{
-		return nullptr;
+		GetMetaAt(position + slotOffset)->store(emptyMeta, std::memory_order_relaxed);
 	}
+}
 
-	//We have enough space in the buffer so let's write meta and alloc the required space
-	uint newHead = (uint)(m_writeHead + totalSize);
-
-	if (newHead > m_byteSize) 
-	{
-		//Buffer needs to wrap, so let's write a skip meta buffer so the read head will wrap at this point
-		RingBufferMeta_T* skipBufferEntry = (RingBufferMeta_T*)(m_buffer + m_writeHead);
-		skipBufferEntry->bufferObjectSize = 0;  // 0 means skip; 
-		skipBufferEntry->isBufferObjectUnlocked = 1;
+//------------------------------------------------------------------------------------------------------------------------------
+size_t MPSCRingBuffer::GetMaxWriteSize() const
+{
+	//A record that doesn't fit before the end also reserves the tail it skips. Past half the buffer that can add up to more
+	//than the whole buffer even when it is empty, so such a record could never be placed
+	size_t maxRecordSize = (m_byteSize / 2) & ~(RING_BUFFER_RECORD_ALIGNMENT - 1);
+	return (maxRecordSize > RING_BUFFER_HEADER_SIZE) ? maxRecordSize - RING_BUFFER_HEADER_SIZE : 0;
+}
 
-		m_writeHead = 0;
-	}
+//------------------------------------------------------------------------------------------------------------------------------
+void* MPSCRingBuffer::TryLockWrite(size_t writeSize)
+{
+	ASSERT_OR_DIE(writeSize > 0, "Can't write an empty object to the MPSC ring buffer, size 0 is the skip marker");
 
-	//ASfter we wrapped we would like to check if the buffer has space again
-	if (GetWritableSpace() < totalSize) 
+	if (writeSize > GetMaxWriteSize())
 	{
+		ERROR_RECOVERABLE(Stringf("Can't write %zu bytes to the MPSC ring buffer, it only takes up to %zu", writeSize, GetMaxWriteSize()));
 		return nullptr;
 	}
 
-	//My write usable buffer
-	byte* usableBuffer = m_buffer + m_writeHead;
+	size_t recordSize = GetRecordSize(writeSize);
 
-	RingBufferMeta_T* head = (RingBufferMeta_T*)usableBuffer;
-	head->bufferObjectSize = (uint)writeSize;
-	head->isBufferObjectUnlocked = 0;
+	uint64_t writeHead = m_writeHead.load(std::memory_order_relaxed);
+	uint64_t recordStart = 0;
 
-	//uint usedHead = m_writeHead;
-	m_writeHead += (int)totalSize;
-	//we moved by 2 meta data in size so let's get back by 1 meta data size (TotalSize is 2*metaDataSize + writeSize)
-	m_writeHead -= (int)metaDataSize;
+	while (true)
+	{
+		//If the record doesn't fit before the end of the buffer we also reserve the tail end so we can skip it
+		size_t contiguousSpace = m_byteSize - (size_t)(writeHead % m_byteSize);
+		size_t reserveSize = (recordSize > contiguousSpace) ? contiguousSpace + recordSize : recordSize;
 
-	return head + 1;
+		uint64_t readHead = m_readHead.load(std::memory_order_acquire);
+		if (writeHead + reserveSize - readHead > m_byteSize)
+		{
+			return nullptr;
+		}
+
+		//On failure writeHead is reloaded with what the other producer left it at
+		if (m_writeHead.compare_exchange_weak(writeHead, writeHead + reserveSize, std::memory_order_relaxed))
+		{
+			recordStart = writeHead + reserveSize - recordSize;
+			if (recordStart != writeHead)
+			{
+				//Buffer needs to wrap, so let's write a skip meta buffer so the read head will wrap at this point
+				RingBufferMeta_T skipMeta;
+				skipMeta.bufferObjectSize = 0;  // 0 means skip; 
+				skipMeta.isBufferObjectUnlocked = 1;
+				GetMetaAt(writeHead)->store(skipMeta, std::memory_order_release);
+			}
+
+			break;
+		}
+	}
+
+	//Size goes in now so UnlockWrite can commit without needing to know it
+	RingBufferMeta_T meta;
+	meta.bufferObjectSize = (uint)writeSize;
+	meta.isBufferObjectUnlocked = 0;
+
+	std::atomic<RingBufferMeta_T>* recordMeta = GetMetaAt(recordStart);
+	recordMeta->store(meta, std::memory_order_relaxed);
+
+	return (byte*)recordMeta + RING_BUFFER_HEADER_SIZE;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -94,10 +152,35 @@ void* MPSCRingBuffer::TryLockWrite(size_t writeSize)
 //------------------------------------------------------------------------------------------------------------------------------
 void* MPSCRingBuffer::LockWrite(size_t size)
 {
+	//Too big to ever fit, waiting would never end
+	if (size > GetMaxWriteSize())
+	{
+		return TryLockWrite(size);
+	}
+
 	void* ptr = TryLockWrite(size);
+
+	int spinCount = 0;
 	while (ptr == nullptr) 
 	{
-		std::this_thread::yield();
+		if (spinCount < RING_BUFFER_WRITE_SPIN_COUNT)
+		{
+			++spinCount;
+			std::this_thread::yield();
+			ptr = TryLockWrite(size);
+			continue;
+		}
+
+		//Still full, sleep until the reader frees something. Retry after preparing so we can't miss its wake
+		uint parkTicket = m_blockedWriters.PrepareToPark();
+		ptr = TryLockWrite(size);
+		if (ptr != nullptr)
+		{
+			m_blockedWriters.CancelPark();
+			break;
+		}
+
+		m_blockedWriters.Park(parkTicket);
 		ptr = TryLockWrite(size);
 	}
 
@@ -107,66 +190,66 @@ void* MPSCRingBuffer::LockWrite(size_t size)
 //------------------------------------------------------------------------------------------------------------------------------
 size_t MPSCRingBuffer::GetWritableSpace() const
 {
-	// size_t remaining = (m_read_head - m_write_head - 1) % m_size;  
-	size_t remaining = 0;
-	if (m_writeHead >= m_readHead) 
-	{
-		remaining = m_byteSize - m_writeHead;
-		remaining += m_readHead;
-	}
-	else 
-	{
-		remaining = m_readHead - m_writeHead;
-	}
+	uint64_t usedSpace = m_writeHead.load(std::memory_order_relaxed) - m_readHead.load(std::memory_order_relaxed);
+	return m_byteSize - (size_t)usedSpace;
+}
 
-	return remaining;
+//------------------------------------------------------------------------------------------------------------------------------
+bool MPSCRingBuffer::IsEmpty() const
+{
+	return m_writeHead.load(std::memory_order_acquire) == m_readHead.load(std::memory_order_acquire);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void MPSCRingBuffer::UnlockWrite(void* ptr)
 {
-	RingBufferMeta_T* writeHead = (RingBufferMeta_T*)ptr;
-	--writeHead;
+	std::atomic<RingBufferMeta_T>* writeHead = (std::atomic<RingBufferMeta_T>*)((byte*)ptr - RING_BUFFER_HEADER_SIZE);
+
+	RingBufferMeta_T meta = writeHead->load(std::memory_order_relaxed);
+	meta.isBufferObjectUnlocked = 1;
 
-	writeHead->isBufferObjectUnlocked = 1;
+	//Release so the reader sees everything written into the record before it sees the commit bit
+	writeHead->store(meta, std::memory_order_release);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void* MPSCRingBuffer::TryLockRead(size_t* outSize)
 {
-	std::scoped_lock lock(m_lock);
+	//We are the only thread that moves the read head
+	uint64_t readHead = m_readHead.load(std::memory_order_relaxed);
 
 	while (true) 
 	{
 		//If the buffer is empty return
-		if (m_readHead == m_writeHead) 
+		if (readHead == m_writeHead.load(std::memory_order_acquire)) 
 		{
 			return nullptr;
 		}
 
 		//Cast to Meta object and figure how big the buffer is to return it
-		RingBufferMeta_T* readMeta = (RingBufferMeta_T*)(m_buffer + m_readHead);
-		if (readMeta->isBufferObjectUnlocked) 
+		std::atomic<RingBufferMeta_T>* readMetaSlot = GetMetaAt(readHead);
+		RingBufferMeta_T readMeta = readMetaSlot->load(std::memory_order_acquire);
+		if (!readMeta.isBufferObjectUnlocked)
 		{
-			if (readMeta->bufferObjectSize == 0) 
-			{
-				// Wrap around case
-				m_readHead = 0;
-			}
-			else 
-			{
-				// valid read case
-				*outSize = readMeta->bufferObjectSize;
+			//Reserved but the producer hasn't committed it yet, records are read in order so we have to wait for it
+			return nullptr;
+		}
 
-				// SINGLE CONSUMER CASE - nothing else happens
-				void* returnBuffer = readMeta + 1;
-				return returnBuffer;
-			}
+		if (readMeta.bufferObjectSize == 0) 
+		{
+			// Wrap around case, clear the skipped tail so a later record landing there doesn't see stale bytes
+			size_t skippedSize = m_byteSize - (size_t)(readHead % m_byteSize);
+			ClearMetas(readHead, skippedSize);
+
+			readHead += skippedSize;
+			m_readHead.store(readHead, std::memory_order_release);
+			m_blockedWriters.WakeAll();
 		}
 		else 
 		{
-			// only one consumer - this shouldn't happen
-			return nullptr;
+			// valid read case
+			*outSize = readMeta.bufferObjectSize;
+			return (byte*)readMetaSlot + RING_BUFFER_HEADER_SIZE;
 		}
 	}
 }
@@ -187,12 +270,303 @@ void* MPSCRingBuffer::LockRead(size_t* outSize)
 //------------------------------------------------------------------------------------------------------------------------------
 void MPSCRingBuffer::UnlockRead(void* ptr)
 {
-	std::scoped_lock lock(m_lock);
+	std::atomic<RingBufferMeta_T>* readMetaSlot = (std::atomic<RingBufferMeta_T>*)((byte*)ptr - RING_BUFFER_HEADER_SIZE);
+
+	uint64_t readHead = m_readHead.load(std::memory_order_relaxed);
+	ASSERT_RECOVERABLE((GetMetaAt(readHead) == readMetaSlot), "The read head for MPSC Async Ring Buffer is invalid");
+
+	//Clear the whole record, new records won't start on the same boundaries so any slot could become someone's meta
+	size_t recordSize = GetRecordSize(readMetaSlot->load(std::memory_order_relaxed).bufferObjectSize);
+	ClearMetas(readHead, recordSize);
+
+	m_readHead.store(readHead + recordSize, std::memory_order_release);
+	m_blockedWriters.WakeAll();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool MPSCRingBuffer::Write(void const* data, size_t byteSize)
+{
+	void* buffer = LockWrite(byteSize);
+	if (buffer == nullptr)
+	{
+		return false;
+	}
+
+	memcpy(buffer, data, byteSize);
+	UnlockWrite(buffer);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool MPSCRingBuffer::TryWrite(void const* data, size_t byteSize)
+{
+	void* buffer = TryLockWrite(byteSize);
+	if (buffer == nullptr)
+	{
+		return false;
+	}
+
+	memcpy(buffer, data, byteSize);
+	UnlockWrite(buffer);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t MPSCRingBuffer::Read(void* outData)
+{
+	size_t readSize = 0;
+	void* buffer = LockRead(&readSize);
+	memcpy(outData, buffer, readSize);
+	UnlockRead(buffer);
+
+	return readSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t MPSCRingBuffer::TryRead(void* outData)
+{
+	size_t readSize = 0;
+	void* buffer = TryLockRead(&readSize);
+	if (buffer == nullptr)
+	{
+		return 0;
+	}
+
+	memcpy(outData, buffer, readSize);
+	UnlockRead(buffer);
+
+	return readSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define RINGTEST_BUFFER_SIZE (64 * 1024)
+#define RINGTEST_TOTAL_MESSAGES 1'000'000
+#define RINGTEST_MAX_PRODUCERS 32
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct RingTestMessage_T
+{
+	uint	m_producerIndex;
+	uint	m_sequence;
+	uint	m_payload[14];
+};
 
-	RingBufferMeta_T* readHead = (RingBufferMeta_T*)ptr;
-	readHead--;
+//------------------------------------------------------------------------------------------------------------------------------
+static void RingBufferTestProducer(MPSCRingBuffer& ringBuffer, uint producerIndex, uint numMessages)
+{
+	for (uint sequence = 0; sequence < numMessages; ++sequence)
+	{
+		//Vary the size so records land on different boundaries every time around the buffer
+		uint numPayloadWords = sequence % 15;
+		size_t writeSize = sizeof(uint) * (2 + numPayloadWords);
 
-	ASSERT_RECOVERABLE(((m_buffer + m_readHead) == (byte*)readHead), "The read head for MPSC Async Ring Buffer is invalid");
+		RingTestMessage_T* message = (RingTestMessage_T*)ringBuffer.LockWrite(writeSize);
+		message->m_producerIndex = producerIndex;
+		message->m_sequence = sequence;
+		for (uint wordIndex = 0; wordIndex < numPayloadWords; ++wordIndex)
+		{
+			message->m_payload[wordIndex] = producerIndex ^ sequence ^ wordIndex;
+		}
+		ringBuffer.UnlockWrite(message);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Reads everything the producers wrote and checks each producer's messages arrive whole and in order
+static bool ConsumeRingBufferTestMessages(MPSCRingBuffer& ringBuffer, uint numProducers, uint messagesPerProducer)
+{
+	std::vector<uint> nextSequence(numProducers, 0U);
+	uint totalMessages = numProducers * messagesPerProducer;
+	bool isValid = true;
+
+	for (uint messageIndex = 0; messageIndex < totalMessages; ++messageIndex)
+	{
+		size_t readSize = 0;
+		RingTestMessage_T* message = (RingTestMessage_T*)ringBuffer.LockRead(&readSize);
+
+		uint producerIndex = message->m_producerIndex;
+		uint numPayloadWords = message->m_sequence % 15;
+		isValid = isValid && (producerIndex < numProducers) && (message->m_sequence == nextSequence[producerIndex]);
+		isValid = isValid && (readSize == sizeof(uint) * (2 + numPayloadWords));
+		for (uint wordIndex = 0; isValid && wordIndex < numPayloadWords; ++wordIndex)
+		{
+			isValid = (message->m_payload[wordIndex] == (producerIndex ^ message->m_sequence ^ wordIndex));
+		}
+
+		if (producerIndex < numProducers)
+		{
+			nextSequence[producerIndex]++;
+		}
+		ringBuffer.UnlockRead(message);
+	}
 
-	m_readHead += sizeof(RingBufferMeta_T) + readHead->bufferObjectSize;
+	size_t leftOver = 0;
+	return isValid && (ringBuffer.TryLockRead(&leftOver) == nullptr);
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Messages/sec through the ring buffer from 1 to 32 producers into one consumer, checking nothing is lost or torn
+UNITTEST("MPSCRingBufferThroughput", "Async", 200)
+{
+	MPSCRingBuffer ringBuffer;
+	ringBuffer.InitializeBuffer(RINGTEST_BUFFER_SIZE);
+
+	bool allValid = true;
+	for (uint numProducers = 1; numProducers <= RINGTEST_MAX_PRODUCERS; numProducers *= 2)
+	{
+		uint messagesPerProducer = RINGTEST_TOTAL_MESSAGES / numProducers;
+
+		double startTime = GetCurrentTimeSeconds();
+
+		std::vector<std::thread> producers;
+		for (uint producerIndex = 0; producerIndex < numProducers; ++producerIndex)
+		{
+			producers.emplace_back(RingBufferTestProducer, std::ref(ringBuffer), producerIndex, messagesPerProducer);
+		}
+
+		bool isValid = ConsumeRingBufferTestMessages(ringBuffer, numProducers, messagesPerProducer);
+
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+
+		double elapsed = GetCurrentTimeSeconds() - startTime;
+		uint totalMessages = numProducers * messagesPerProducer;
+		DebuggerPrintf("\n MPSC ring buffer %2u producers: %.0f messages/s %s", numProducers, (double)totalMessages / elapsed, isValid ? "" : "(CORRUPTED)");
+
+		allValid = allValid && isValid;
+	}
+
+	return allValid;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Records up to half the buffer must always get placed however the heads line up, bigger ones must be refused not waited on
+UNITTEST("MPSCRingBufferLargeRecords", "Async", 100)
+{
+	MPSCRingBuffer ringBuffer;
+	ringBuffer.InitializeBuffer(1024);
+
+	size_t maxWriteSize = ringBuffer.GetMaxWriteSize();
+	CONFIRM(maxWriteSize == 512 - RING_BUFFER_HEADER_SIZE);
+
+	std::vector<byte> writeData(maxWriteSize);
+	std::vector<byte> readData(maxWriteSize);
+	for (size_t writeSize = 8; writeSize <= maxWriteSize; writeSize += 8)
+	{
+		//Leave the heads just past a small record so the big one has to wrap
+		CONFIRM(ringBuffer.Write(writeData.data(), 16));
+		CONFIRM(ringBuffer.Read(readData.data()) == 16);
+
+		for (size_t byteIndex = 0; byteIndex < writeSize; ++byteIndex)
+		{
+			writeData[byteIndex] = (byte)(writeSize + byteIndex);
+		}
+
+		CONFIRM(ringBuffer.Write(writeData.data(), writeSize));
+		CONFIRM(ringBuffer.Read(readData.data()) == writeSize);
+		CONFIRM(memcmp(writeData.data(), readData.data(), writeSize) == 0);
+	}
+
+	return ringBuffer.TryLockWrite(maxWriteSize + 8) == nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+#define TYPEDRINGTEST_NUM_ITEMS 1'000'000
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Producer and consumer threads through a small SPSC buffer in both modes. Reject mode must deliver everything in order,
+// overwrite mode may drop items but whatever comes out must still be in order
+UNITTEST("SPSCRingBuffer", "Async", 100)
+{
+	SPSCRingBuffer<uint> rejectBuffer(64, RING_BUFFER_REJECT_WHEN_FULL);
+	SPSCRingBuffer<uint> overwriteBuffer(64, RING_BUFFER_OVERWRITE_OLDEST);
+
+	std::thread producer([&]()
+	{
+		for (uint item = 0; item < TYPEDRINGTEST_NUM_ITEMS; ++item)
+		{
+			while (!rejectBuffer.Push(item))
+			{
+				std::this_thread::yield();
+			}
+
+			overwriteBuffer.Push(item);
+		}
+	});
+
+	uint expectedItem = 0;
+	bool rejectInOrder = true;
+
+	uint overwriteCount = 0;
+	uint lastItem = 0;
+	bool overwriteInOrder = true;
+	uint item = 0;
+
+	while (expectedItem < TYPEDRINGTEST_NUM_ITEMS)
+	{
+		if (!rejectBuffer.Pop(&item))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		rejectInOrder = rejectInOrder && (item == expectedItem);
+		++expectedItem;
+
+		//Read the overwrite buffer now and then so our claims race the producer dropping the oldest element
+		if ((expectedItem & 0x3FF) == 0 && overwriteBuffer.Pop(&item))
+		{
+			overwriteInOrder = overwriteInOrder && (overwriteCount == 0 || item > lastItem);
+			lastItem = item;
+			++overwriteCount;
+		}
+	}
+
+	producer.join();
+
+	while (overwriteBuffer.Pop(&item))
+	{
+		overwriteInOrder = overwriteInOrder && (overwriteCount == 0 || item > lastItem);
+		lastItem = item;
+		++overwriteCount;
+	}
+
+	DebuggerPrintf("\n SPSC ring buffer overwrite mode read %u items, overwrote %llu", overwriteCount, overwriteBuffer.GetNumOverwritten());
+
+	CONFIRM(rejectInOrder && overwriteInOrder);
+	CONFIRM(lastItem == TYPEDRINGTEST_NUM_ITEMS - 1);
+	return overwriteCount + overwriteBuffer.GetNumOverwritten() == TYPEDRINGTEST_NUM_ITEMS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("MPMCRingBuffer", "Async", 100)
+{
+	//Reject mode keeps the first N, overwrite mode keeps the last N
+	MPMCRingBuffer<int> rejectBuffer(4, RING_BUFFER_REJECT_WHEN_FULL);
+	MPMCRingBuffer<int> overwriteBuffer(4, RING_BUFFER_OVERWRITE_OLDEST);
+
+	for (int item = 0; item < 10; ++item)
+	{
+		bool pushed = rejectBuffer.Push(item);
+		CONFIRM(pushed == (item < 4));
+		CONFIRM(overwriteBuffer.Push(item));
+	}
+
+	CONFIRM(rejectBuffer.GetLength() == 4 && overwriteBuffer.GetLength() == 4);
+	CONFIRM(overwriteBuffer.GetNumOverwritten() == 6);
+
+	int item = 0;
+	for (int expectedItem = 0; expectedItem < 4; ++expectedItem)
+	{
+		CONFIRM(rejectBuffer.Pop(&item) && item == expectedItem);
+		CONFIRM(overwriteBuffer.Pop(&item) && item == expectedItem + 6);
+	}
+
+	return !rejectBuffer.Pop(&item) && !overwriteBuffer.Pop(&item);
+}
\ No newline at end of file
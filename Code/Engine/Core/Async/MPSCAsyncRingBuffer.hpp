@@ -1,6 +1,7 @@
 #pragma once
+#include "Engine/Core/Async/ThreadParker.hpp"
+#include <atomic>
 #include <stdint.h>
-#include <mutex>
 
 //------------------------------------------------------------------------------------------------------------------------------
 typedef uint8_t byte;
@@ -16,8 +17,20 @@ struct RingBufferMeta_T
 	uint isBufferObjectUnlocked : 1;
 };
 
+//------------------------------------------------------------------------------------------------------------------------------
+// Every record starts with its meta in an 8 byte slot and is padded to 8 bytes so the data that follows stays aligned
+constexpr size_t RING_BUFFER_RECORD_ALIGNMENT = 8;
+constexpr size_t RING_BUFFER_HEADER_SIZE = 8;
+
+//Times a blocked writer yields before parking until the reader frees up space
+constexpr int RING_BUFFER_WRITE_SPIN_COUNT = 64;
+
 //------------------------------------------------------------------------------------------------------------------------------
 // This is a Multiple Producer Single Consumer Async Ring Buffer. 
+// Producers reserve space with a single CAS on the write head and commit by setting the unlocked bit in the record's meta, 
+// so no producer ever waits on another one. The read head is only ever moved by the single consumer, which never blocks 
+// the producers either. A record that would run past the end of the buffer leaves a skip meta (size 0) and starts at 0.
+// Heads are monotonic byte counts and wrap using the buffer size, so the full and empty cases never look the same.
 //------------------------------------------------------------------------------------------------------------------------------
 class MPSCRingBuffer
 {
@@ -30,30 +43,39 @@ class MPSCRingBuffer
 
 		//Instantly returns, either receive valid data pointer or a nullptr
 		void*			TryLockWrite(size_t size);
-		//Block until there room to write onto buffer
+		//Block until there room to write onto buffer. Returns nullptr right away for anything over GetMaxWriteSize
 		void*			LockWrite(size_t size);
 		void			UnlockWrite(void* ptr);
 
 		size_t			GetWritableSpace() const;
+		size_t			GetMaxWriteSize() const;		// a bit under half the buffer, larger writes are refused
+		bool			IsEmpty() const;				// also false while a record is reserved but not unlocked yet
 		
+		//Single consumer only
 		void*			TryLockRead(size_t* outSize);
 		void*			LockRead(size_t* outSize);
 		void			UnlockRead(void* ptr);
 
 		// helpers - optional
-		bool write(void const* data, size_t byte_size);
-		bool try_write(void const* data, size_t byte_size);
+		bool			Write(void const* data, size_t byteSize);
+		bool			TryWrite(void const* data, size_t byteSize);
 
 		//If fail, return 0. Else, return the number of bytes read
 		size_t			Read(void* outData);
 		size_t			TryRead(void* outData);
 
+	private:
+		std::atomic<RingBufferMeta_T>*	GetMetaAt(uint64_t position) const;
+		void							ClearMetas(uint64_t position, size_t byteSize);
+
 	private:
 		byte*			m_buffer = nullptr;
 		size_t			m_byteSize = 0;
 
-		uint			m_writeHead = 0;
-		uint			m_readHead = 0;
+		//Producers and the consumer each get their own cache line
+		alignas(64) std::atomic<uint64_t>	m_writeHead = 0U;
+		alignas(64) std::atomic<uint64_t>	m_readHead = 0U;
 
-		std::mutex		m_lock;
+		//Writers that found the buffer full sleep here until the reader frees space
+		ThreadParker	m_blockedWriters;
 };
\ No newline at end of file
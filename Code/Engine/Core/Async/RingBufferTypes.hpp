@@ -0,0 +1,9 @@
+#pragma once
+
+//------------------------------------------------------------------------------------------------------------------------------
+// What a typed ring buffer does when something is pushed while it is full
+enum eRingBufferMode : int
+{
+	RING_BUFFER_REJECT_WHEN_FULL = 0,	// Push fails and the buffer is left untouched
+	RING_BUFFER_OVERWRITE_OLDEST,		// The oldest unread element is dropped to make room
+};
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+#include "Engine/Core/Async/RingBufferTypes.hpp"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Fixed capacity Single Producer Single Consumer ring buffer. Slots are allocated once on construction (capacity is
+// rounded up to a power of 2) and elements are assigned in place, nothing is allocated after that.
+// Every slot carries a sequence number so the producer only writes a slot once the consumer has finished with it.
+// In RING_BUFFER_OVERWRITE_OLDEST mode the producer may also drop the oldest element, so the consumer claims elements with a
+// CAS on the read index instead of a plain store. That is the only extra cost the mode adds.
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+class SPSCRingBuffer
+{
+public:
+	explicit SPSCRingBuffer(size_t capacity, eRingBufferMode mode = RING_BUFFER_REJECT_WHEN_FULL);
+	~SPSCRingBuffer();
+
+	//Producer thread only. Returns false if the element was rejected, overwrite mode always succeeds
+	bool						Push(TYPE const& element);
+
+	//Consumer thread only. Returns false if there was nothing to read
+	bool						Pop(TYPE* out);
+
+	int							GetLength() const;					// only a snapshot, may be stale as soon as it returns
+	size_t						GetCapacity() const					{ return m_mask + 1; }
+	eRingBufferMode				GetMode() const						{ return m_mode; }
+	uint64_t					GetNumOverwritten() const			{ return m_numOverwritten.load(std::memory_order_relaxed); }
+
+private:
+	bool						TryPush(TYPE const& element);
+	bool						TryClaimOldest(TYPE* out);
+
+private:
+	struct Slot_T
+	{
+		std::atomic<size_t>		sequence;
+		TYPE					data;
+	};
+
+	Slot_T*						m_slots = nullptr;
+	size_t						m_mask = 0;
+	eRingBufferMode				m_mode = RING_BUFFER_REJECT_WHEN_FULL;
+
+	//Producer and consumer indices each get their own cache line
+	alignas(64) std::atomic<size_t>		m_writeIndex;
+	std::atomic<uint64_t>				m_numOverwritten;
+	alignas(64) std::atomic<size_t>		m_readIndex;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+SPSCRingBuffer<TYPE>::SPSCRingBuffer(size_t capacity, eRingBufferMode mode /*= RING_BUFFER_REJECT_WHEN_FULL*/)
+{
+	size_t powerOf2Capacity = 2;
+	while (powerOf2Capacity < capacity)
+	{
+		powerOf2Capacity <<= 1;
+	}
+
+	m_slots = new Slot_T[powerOf2Capacity];
+	m_mask = powerOf2Capacity - 1;
+	m_mode = mode;
+
+	for (size_t slotIndex = 0; slotIndex < powerOf2Capacity; ++slotIndex)
+	{
+		m_slots[slotIndex].sequence.store(slotIndex, std::memory_order_relaxed);
+	}
+
+	m_writeIndex.store(0, std::memory_order_relaxed);
+	m_readIndex.store(0, std::memory_order_relaxed);
+	m_numOverwritten.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+SPSCRingBuffer<TYPE>::~SPSCRingBuffer()
+{
+	delete[] m_slots;
+	m_slots = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool SPSCRingBuffer<TYPE>::Push(TYPE const& element)
+{
+	if (TryPush(element))
+	{
+		return true;
+	}
+
+	if (m_mode == RING_BUFFER_REJECT_WHEN_FULL)
+	{
+		return false;
+	}
+
+	TYPE dropped;
+	while (!TryPush(element))
+	{
+		//If the consumer already claimed the slot we need it is mid read, wait for it instead of dropping a newer element
+		size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+		size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+		if (writeIndex - readIndex < GetCapacity())
+		{
+			std::this_thread::yield();
+		}
+		else if (TryClaimOldest(&dropped))
+		{
+			m_numOverwritten.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool SPSCRingBuffer<TYPE>::TryPush(TYPE const& element)
+{
+	size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	Slot_T& slot = m_slots[writeIndex & m_mask];
+
+	//The slot is ours once the consumer has moved its sequence up to this lap
+	if (slot.sequence.load(std::memory_order_acquire) != writeIndex)
+	{
+		return false;
+	}
+
+	slot.data = element;
+	slot.sequence.store(writeIndex + 1, std::memory_order_release);
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool SPSCRingBuffer<TYPE>::Pop(TYPE* out)
+{
+	if (m_mode == RING_BUFFER_OVERWRITE_OLDEST)
+	{
+		return TryClaimOldest(out);
+	}
+
+	//Reject mode, nobody else ever moves the read index so no CAS needed
+	size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+	Slot_T& slot = m_slots[readIndex & m_mask];
+	if (slot.sequence.load(std::memory_order_acquire) != readIndex + 1)
+	{
+		return false;
+	}
+
+	*out = slot.data;
+	m_readIndex.store(readIndex + 1, std::memory_order_release);
+	slot.sequence.store(readIndex + m_mask + 1, std::memory_order_release);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool SPSCRingBuffer<TYPE>::TryClaimOldest(TYPE* out)
+{
+	size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		Slot_T& slot = m_slots[readIndex & m_mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(readIndex + 1);
+
+		if (difference == 0)
+		{
+			if (m_readIndex.compare_exchange_weak(readIndex, readIndex + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				*out = slot.data;
+				slot.sequence.store(readIndex + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			//Nothing written here yet, we are empty
+			return false;
+		}
+		else
+		{
+			//The other side claimed this one first
+			readIndex = m_readIndex.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+int SPSCRingBuffer<TYPE>::GetLength() const
+{
+	size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+
+	return (writeIndex > readIndex) ? (int)(writeIndex - readIndex) : 0;
+}
\ No newline at end of file
@@ -1,7 +1,5 @@
 #include "Engine/Core/Async/Semaphores.hpp"
-
-#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
-#include <windows.h>
+#include <chrono>
 
 //------------------------------------------------------------------------------------------------------------------------------
 Semaphore::Semaphore(uint initialCount, uint maxCount)
@@ -21,46 +19,93 @@ Semaphore::~Semaphore()
 	Destroy();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
 void Semaphore::Create(uint initialCount, uint maxCount)
 {
-	// Creating/Initializing
-	m_semaphore = ::CreateSemaphore(nullptr,  // security attributes - ignore 
-		initialCount,                      // count this starts at
-		maxCount,                          // max count this semaphore can reach
-		nullptr);                          // name, if used across processes
+	std::scoped_lock lock(m_mutex);
+
+	m_maxCount = maxCount;
+	m_count = (initialCount < maxCount) ? initialCount : maxCount;
+	m_isValid = true;
 }
 
-// note: should probably call from deconstructor
+//------------------------------------------------------------------------------------------------------------------------------
+// Wakes everyone still waiting, their Acquire returns without taking a count
 void Semaphore::Destroy()
 {
-	if (m_semaphore != nullptr) {
-		::CloseHandle(m_semaphore);
-		m_semaphore = nullptr;
+	{
+		std::scoped_lock lock(m_mutex);
+		m_isValid = false;
 	}
+
+	m_condition.notify_all();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
 // Acquire a Seamphore
 // this will block until the semaphore becomes invalid (destroyed)
 // or succeeds
 void Semaphore::Acquire()
 {
-	::WaitForSingleObject(m_semaphore, // object to wait on
-		INFINITE);                      // time to wait in milliseconds
+	std::unique_lock lock(m_mutex);
+	m_condition.wait(lock, [this]() { return m_count > 0 || !m_isValid; });
+
+	if (m_count > 0)
+	{
+		--m_count;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Same as Acquire but only blocks for up to the given time
+bool Semaphore::AcquireFor(double seconds)
+{
+	std::unique_lock lock(m_mutex);
+	m_condition.wait_for(lock, std::chrono::duration<double>(seconds), [this]() { return m_count > 0 || !m_isValid; });
+
+	if (m_count > 0)
+	{
+		--m_count;
+		return true;
+	}
+
+	return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
 // may or may not succeed
 // if returns true, the counter was decremented
 // if returns false, the counter was 0 and unable to be decremented
 bool Semaphore::TryAcquire()
 {
-	DWORD result = ::WaitForSingleObject(m_semaphore, 0);
-	return (result == WAIT_OBJECT_0); // we successfully waited on the first object (m_semaphroe)
+	std::scoped_lock lock(m_mutex);
+	if (m_count == 0)
+	{
+		return false;
+	}
+
+	--m_count;
+	return true;
 }
 
-// releases teh seamphore - ie, adds to the counter up to max
+//------------------------------------------------------------------------------------------------------------------------------
+// releases the semaphore - ie, adds to the counter up to max
 void Semaphore::Release(uint count)
 {
-	::ReleaseSemaphore(m_semaphore,
-		count,      // how many to add to the semaphore
-		nullptr);  // out for previous count
+	uint added = 0;
+	{
+		std::scoped_lock lock(m_mutex);
+
+		added = (m_maxCount - m_count < count) ? m_maxCount - m_count : count;
+		m_count += added;
+	}
+
+	if (added == 1)
+	{
+		m_condition.notify_one();
+	}
+	else if (added > 1)
+	{
+		m_condition.notify_all();
+	}
 }
\ No newline at end of file
@@ -1,11 +1,20 @@
 #pragma once
+#include <condition_variable>
+#include <mutex>
 
-typedef void* HANDLE;
 typedef unsigned int uint;
 
+//------------------------------------------------------------------------------------------------------------------------------
+// Counting semaphore built on a mutex and condition variable so it works on every platform we build for.
+// Release clamps the count at maxCount the same way a Win32 semaphore would.
+//------------------------------------------------------------------------------------------------------------------------------
 class Semaphore
 {
-	HANDLE		m_semaphore;
+	std::mutex					m_mutex;
+	std::condition_variable		m_condition;
+	uint						m_count = 0U;
+	uint						m_maxCount = 0U;
+	bool						m_isValid = false;
 
 public:
 	Semaphore();
@@ -15,6 +24,7 @@ public:
 	void		Create(uint initialCount, uint maxCount);
 	void		Destroy();
 	void		Acquire();
+	bool		AcquireFor(double seconds);		// gives up after the timeout, returns true if the counter was decremented
 	bool		TryAcquire();
 	void		Release(uint count = 1);
 
@@ -22,4 +32,4 @@ public:
 	inline void Lock()					{ Acquire(); }
 	inline bool TryLock()				{ return TryAcquire(); };
 	inline void Unlock()				{ Release(1); }
-};
+};
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "Engine/Core/Async/ThreadParker.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint ThreadParker::PrepareToPark()
+{
+	//seq_cst so a waker either sees us as a waiter or we see its epoch bump, never neither
+	m_numWaiters.fetch_add(1, std::memory_order_seq_cst);
+	return m_epoch.load(std::memory_order_seq_cst);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ThreadParker::CancelPark()
+{
+	m_numWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ThreadParker::Park(uint parkTicket)
+{
+	std::unique_lock lock(m_mutex);
+
+	//Somebody woke the pool after we prepared, go look for the work they pushed
+	if (m_epoch.load(std::memory_order_relaxed) == parkTicket)
+	{
+		m_numParked.fetch_add(1, std::memory_order_relaxed);
+		m_condition.wait(lock, [this]() { return m_wakeTokens > 0; });
+		m_wakeTokens--;
+		m_numParked.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	m_numWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ThreadParker::WakeN(uint count)
+{
+	//Full fence so the work the caller just published can't be reordered after this check. Pairs with PrepareToPark
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	//Fast path, nobody is trying to sleep so there is nothing to do
+	if (count == 0 || m_numWaiters.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	uint numToNotify = 0;
+	{
+		std::scoped_lock lock(m_mutex);
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+		//Tokens are capped at the number of sleepers so they can't pile up and make later Parks return early
+		uint numParked = m_numParked.load(std::memory_order_relaxed);
+		uint numIdle = numParked - m_wakeTokens;
+		numToNotify = (count < numIdle) ? count : numIdle;
+		m_wakeTokens += numToNotify;
+	}
+
+	if (numToNotify == 1)
+	{
+		m_condition.notify_one();
+	}
+	else if (numToNotify > 1)
+	{
+		m_condition.notify_all();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void ThreadParker::WakeAll()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_numWaiters.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	{
+		std::scoped_lock lock(m_mutex);
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		m_wakeTokens = m_numParked.load(std::memory_order_relaxed);
+	}
+
+	m_condition.notify_all();
+}
\ No newline at end of file
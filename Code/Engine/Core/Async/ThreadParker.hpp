@@ -0,0 +1,35 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+typedef unsigned int uint;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Lets a pool of threads sleep when there is no work without missing a wake up (an event count).
+// A thread that wants to sleep calls PrepareToPark, checks for work one last time and then calls either CancelPark or Park.
+// Any WakeOne/WakeN/WakeAll that happens after PrepareToPark makes Park return straight away, so work pushed in that window
+// is never slept through. Wakes are free when no thread is parked, so producers can call WakeOne for every item they push.
+//------------------------------------------------------------------------------------------------------------------------------
+class ThreadParker
+{
+public:
+	uint						PrepareToPark();
+	void						CancelPark();
+	void						Park(uint parkTicket);
+
+	void						WakeOne()					{ WakeN(1); }
+	void						WakeN(uint count);
+	void						WakeAll();
+
+	uint						GetNumParked() const		{ return m_numParked.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint>			m_epoch = 0U;
+	std::atomic<uint>			m_numWaiters = 0U;			// threads between PrepareToPark and leaving Park or CancelPark
+	std::atomic<uint>			m_numParked = 0U;			// threads actually asleep on the condition variable
+
+	std::mutex					m_mutex;
+	std::condition_variable		m_condition;
+	uint						m_wakeTokens = 0U;			// guarded by m_mutex
+};
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: This is a Chase-Lev work stealing deque. The owning thread pushes and pops from the bottom (LIFO) while any other
+// thread may steal from the top (FIFO). The owner never takes a lock and thieves only contend on a single CAS of the top.
+// Capacity is fixed on construction (rounded up to a power of 2). When the deque is full Push returns false so the caller
+// can fall back to a shared queue instead of growing the buffer.
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+class WorkStealingQueue
+{
+public:
+	explicit WorkStealingQueue(size_t capacity = 1024);
+	~WorkStealingQueue();
+
+	bool					Push(TYPE const& element);		// Owner thread only
+	bool					Pop(TYPE* out);					// Owner thread only
+	bool					Steal(TYPE* out);				// Any thread
+
+	int						GetLength() const;
+	size_t					GetCapacity() const				{ return m_mask + 1; }
+
+private:
+	std::atomic<TYPE>*		m_buffer = nullptr;
+	size_t					m_mask = 0;
+
+	//Top and bottom live on their own cache lines so thieves don't false share with the owner
+	alignas(64) std::atomic<int64_t>	m_top;
+	alignas(64) std::atomic<int64_t>	m_bottom;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+WorkStealingQueue<TYPE>::WorkStealingQueue(size_t capacity /*= 1024*/)
+{
+	size_t powerOf2Capacity = 2;
+	while (powerOf2Capacity < capacity)
+	{
+		powerOf2Capacity <<= 1;
+	}
+
+	m_buffer = new std::atomic<TYPE>[powerOf2Capacity];
+	m_mask = powerOf2Capacity - 1;
+
+	m_top.store(0, std::memory_order_relaxed);
+	m_bottom.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+WorkStealingQueue<TYPE>::~WorkStealingQueue()
+{
+	delete[] m_buffer;
+	m_buffer = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool WorkStealingQueue<TYPE>::Push(TYPE const& element)
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+
+	if (bottom - top > (int64_t)m_mask)
+	{
+		//We are full, let the caller decide where this element goes
+		return false;
+	}
+
+	m_buffer[bottom & m_mask].store(element, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool WorkStealingQueue<TYPE>::Pop(TYPE* out)
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		//Deque was empty, restore the bottom
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	*out = m_buffer[bottom & m_mask].load(std::memory_order_relaxed);
+	if (top != bottom)
+	{
+		//More than one element left so no thief can race us for this one
+		return true;
+	}
+
+	//Last element, race the thieves for it
+	bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return won;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+bool WorkStealingQueue<TYPE>::Steal(TYPE* out)
+{
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return false;
+	}
+
+	TYPE element = m_buffer[top & m_mask].load(std::memory_order_relaxed);
+	if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		//Lost the race to the owner or another thief
+		return false;
+	}
+
+	*out = element;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE>
+int WorkStealingQueue<TYPE>::GetLength() const
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	return (bottom > top) ? (int)(bottom - top) : 0;
+}
@@ -1,6 +1,8 @@
 //------------------------------------------------------------------------------------------------------------------------------
 #include "Engine/Core/DevConsole.hpp"
+#include "Engine/Allocators/SizeClassAllocator.hpp"
 #include "Engine/Core/EventSystems.hpp"
+#include "Engine/Core/JobSystem/JobSystem.hpp"
 #include "Engine/Core/NamedProperties.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
@@ -12,7 +14,6 @@
 #include "Game/EngineBuildPreferences.hpp"
 #include <algorithm>
 #include "Engine/Core/MemTracking.hpp"
-#include "Engine/Allocators/TemplatedUntrackedAllocator.hpp"
 
 DevConsole* g_devConsole = nullptr;
 
@@ -24,9 +25,6 @@ const STATIC Rgba DevConsole::CONSOLE_ERROR_DESC	=	Rgba(1.0f, 0.5f, 0.3f, 1.0f);
 const STATIC Rgba DevConsole::CONSOLE_INPUT			=	Rgba(1.0f, 1.0f, 1.0f, 1.0f);
 const STATIC Rgba DevConsole::CONSOLE_ECHO_COLOR	=	Rgba(1.0f, 1.0f, 1.0f, 1.0f);
 
-extern std::mutex gTrackerLock;
-extern std::map<void*, MemTrackInfo_T, std::less<void*>, TemplatedUntrackedAllocator<std::pair<void* const, MemTrackInfo_T>>> gMemTrackers;
-
 //------------------------------------------------------------------------------------------------------------------------------
 void LogHookForDevConsole(const LogObject_T* logObj)
 {
@@ -313,8 +311,11 @@ void DevConsole::Startup()
 	g_eventSystem->SubscribeEventCallBackFn("DisableLogFilter", Command_DisableLogFilter);
 	g_eventSystem->SubscribeEventCallBackFn("FlushLog", Command_FlushLogSystem);
 	g_eventSystem->SubscribeEventCallBackFn("Logf", Command_Logf);
+	g_eventSystem->SubscribeEventCallBackFn("DecodeLog", Command_DecodeLog);
 
 	g_eventSystem->SubscribeEventCallBackFn("Screenshot", Command_ScreenShot);
+	g_eventSystem->SubscribeEventCallBackFn("JobStats", Command_JobStats);
+	g_eventSystem->SubscribeEventCallBackFn("AllocatorStats", Command_AllocatorStats);
 
 	m_currentInput.clear();
 }
@@ -577,6 +578,22 @@ void DevConsole::GetVertsForDevConsoleMemTracker(std::vector<Vertex_PCU>& textVe
 		memTrackingBox.m_maxBounds += Vec2(0.f, lineHeight);
 		m_consoleFont->AddVertsForTextInBox2D(textVerts, memTrackingBox, lineHeight, textString, Rgba::GREEN, 1.f, Vec2::ALIGN_LEFT_BOTTOM);
 
+	#elif (MEM_TRACKING == MEM_TRACK_SAMPLED)
+		textString = "Tracking Mode: Sampled";
+		uint numAllocations = (uint)gTotalAllocations;
+		numAllocationsText = Stringf("Total Allocation count: %u", numAllocations);
+		totalBytesAllocatedText = "Estimated " + GetSizeString(MemTrackGetLiveByteCount());
+
+		m_consoleFont->AddVertsForTextInBox2D(textVerts, memTrackingBox, lineHeight, totalBytesAllocatedText, Rgba::GREEN, 1.f, Vec2::ALIGN_LEFT_BOTTOM);
+		
+		memTrackingBox.m_minBounds += Vec2(0.f, lineHeight);
+		memTrackingBox.m_maxBounds += Vec2(0.f, lineHeight);
+		m_consoleFont->AddVertsForTextInBox2D(textVerts, memTrackingBox, lineHeight, numAllocationsText, Rgba::GREEN, 1.f, Vec2::ALIGN_LEFT_BOTTOM);
+
+		memTrackingBox.m_minBounds += Vec2(0.f, lineHeight);
+		memTrackingBox.m_maxBounds += Vec2(0.f, lineHeight);
+		m_consoleFont->AddVertsForTextInBox2D(textVerts, memTrackingBox, lineHeight, textString, Rgba::GREEN, 1.f, Vec2::ALIGN_LEFT_BOTTOM);
+
 	#endif
 #else
 	textString = "Tracking is Off";
@@ -700,7 +717,44 @@ STATIC bool DevConsole::Command_Logf(EventArgs& args)
 	std::string messageText;
 	filterText = args.GetValue("Filter", filterText);
 	messageText = args.GetValue("Message", messageText);
-	g_LogSystem->Logf(filterText.c_str(), messageText.c_str());
+	g_LogSystem->Logf(filterText.c_str(), "%s", messageText.c_str());
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC bool DevConsole::Command_DecodeLog(EventArgs& args)
+{
+	//Defaults to the log this run is writing
+	std::string binaryFileName;
+	std::string textFileName;
+	binaryFileName = args.GetValue("File", binaryFileName);
+	textFileName = args.GetValue("Out", textFileName);
+
+	if (binaryFileName.empty())
+	{
+		g_LogSystem->LogFlush();
+		binaryFileName = g_LogSystem->m_fileWriter.GetFileName();
+	}
+
+	if (textFileName.empty())
+	{
+		textFileName = binaryFileName;
+		size_t extensionStart = textFileName.rfind(".bin");
+		if (extensionStart != std::string::npos)
+		{
+			textFileName.erase(extensionStart);
+		}
+		textFileName += ".txt";
+	}
+
+	if (LogDecodeBinaryFile(binaryFileName, textFileName))
+	{
+		g_devConsole->PrintString(CONSOLE_INFO, Stringf("Decoded %s to %s", binaryFileName.c_str(), textFileName.c_str()));
+	}
+	else
+	{
+		g_devConsole->PrintString(CONSOLE_ERROR, Stringf("Could not decode %s, wrote whatever was readable to %s", binaryFileName.c_str(), textFileName.c_str()));
+	}
 	return true;
 }
 
@@ -711,3 +765,68 @@ STATIC bool DevConsole::Command_ScreenShot(EventArgs& args)
 	g_renderContext->RequestScreenshot();
 	return true;
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Prints queue depth and wait times for every job priority. Pass Reset=true to clear the counters after printing
+STATIC bool DevConsole::Command_JobStats(EventArgs& args)
+{
+	static const char* categoryNames[JOB_CATEGORY_CORE_COUNT] = { "Generic", "Main", "Render" };
+	static const char* priorityNames[JOB_PRIORITY_COUNT] = { "High", "Normal", "Low" };
+
+	JobSystem* jobSystem = JobSystem::GetInstance();
+
+	g_devConsole->PrintString(CONSOLE_INFO, "> Job stats per priority (pending, started, avg wait, max wait)");
+	for (int category = 0; category < JOB_CATEGORY_CORE_COUNT; ++category)
+	{
+		for (int priority = 0; priority < JOB_PRIORITY_COUNT; ++priority)
+		{
+			JobPriorityStats_T stats;
+			jobSystem->GetPriorityStats(category, (eJobPriority)priority, &stats);
+
+			std::string printString = Stringf("   %-8s %-7s %6d pending %10llu started %9.3f ms avg %9.3f ms max", categoryNames[category], priorityNames[priority], stats.m_pendingJobs, stats.m_numJobsStarted, stats.m_averageWaitMS, stats.m_maxWaitMS);
+			g_devConsole->PrintString(CONSOLE_ECHO_COLOR, printString);
+		}
+	}
+
+	bool resetStats = false;
+	resetStats = args.GetValue("Reset", resetStats);
+	if (resetStats)
+	{
+		jobSystem->ResetPriorityStats();
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Prints occupancy and fragmentation for every size class of the pools behind PooledAlloc and the pooled global new.
+// Pass Reset=true to reset the peaks
+STATIC bool DevConsole::Command_AllocatorStats(EventArgs& args)
+{
+	SizeClassAllocator* allocator = FindPooledAllocator();
+	if (allocator == nullptr)
+	{
+		g_devConsole->PrintString(CONSOLE_INFO, "> Nothing has allocated from the pooled allocator yet");
+		return true;
+	}
+
+	g_devConsole->PrintString(CONSOLE_INFO, "> Size class stats (live, peak, total, used KB, reserved KB, occupancy, internal fragmentation)");
+	for (uint sizeClass = 0; sizeClass <= SIZE_CLASS_COUNT; ++sizeClass)
+	{
+		SizeClassStats_T stats;
+		allocator->GetSizeClassStats(sizeClass, &stats);
+
+		std::string className = (sizeClass < SIZE_CLASS_COUNT) ? Stringf("%zu B", stats.m_blockSize) : "Large";
+		std::string printString = Stringf("   %-7s %8llu live %8llu peak %10llu total %10.1f KB %10.1f KB %6.1f%% %6.1f%%", className.c_str(), stats.m_numLiveAllocations, stats.m_peakLiveAllocations, stats.m_totalAllocations, stats.m_usedBytes / 1024.0, stats.m_reservedBytes / 1024.0, stats.m_occupancy * 100.f, stats.m_internalFragmentation * 100.f);
+		g_devConsole->PrintString(CONSOLE_ECHO_COLOR, printString);
+	}
+
+	bool resetStats = false;
+	resetStats = args.GetValue("Reset", resetStats);
+	if (resetStats)
+	{
+		allocator->ResetPeakStats();
+	}
+
+	return true;
+}
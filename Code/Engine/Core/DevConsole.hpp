@@ -73,8 +73,11 @@ public:
 	static bool		Command_DisableLogFilter(EventArgs& args);
 	static bool		Command_FlushLogSystem(EventArgs& args);
 	static bool		Command_Logf(EventArgs& args);
+	static bool		Command_DecodeLog(EventArgs& args);
 
 	static bool		Command_ScreenShot(EventArgs& args);
+	static bool		Command_JobStats(EventArgs& args);
+	static bool		Command_AllocatorStats(EventArgs& args);
 	//Uses ExecuteCommandLine for now
 	static bool		Command_Exec(EventArgs& args);
 
@@ -1,6 +1,10 @@
 //------------------------------------------------------------------------------------------------------------------------------
 #include "Engine/Core/EventSystems.hpp"
+#include "Engine/Commons/UnitTest.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <map>
 
 EventSystems* g_eventSystem = nullptr;
 
@@ -43,33 +47,29 @@ void EventSystems::ShutDown()
 //------------------------------------------------------------------------------------------------------------------------------
 void EventSystems::SubscribeEventCallBackFn( const std::string& eventName, EventCallBackFn callBack )
 {
-	//Push the event into the event list
-	EventSubscription* subscriber = new EventSubscription(callBack);
-	m_eventSubscriptions[eventName].push_back(subscriber);
+	uint entryIndex = FindOrAddEntry(eventName);
+	if(entryIndex == EVENT_EMPTY_SLOT)
+	{
+		return;
+	}
+
+	m_events[entryIndex].subscribers.push_back(callBack);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void EventSystems::UnsubscribeEventCallBackFn( const std::string& eventName, EventCallBackFn callBack )
 {
-	std::map<std::string, SubscribersList >::iterator eventIterator;
-	eventIterator = m_eventSubscriptions.begin();
-	while(eventIterator != m_eventSubscriptions.end())
+	uint entryIndex = FindEntry(eventName);
+	if(entryIndex == EVENT_EMPTY_SLOT)
 	{
-		if(eventName.compare(eventIterator->first) == 0)
-		{
-			for(int subscribeIndex = 0; subscribeIndex < static_cast<int>(eventIterator->second.size()); subscribeIndex++)
-			{
-				if(eventIterator->second[subscribeIndex]->m_callbackFn == callBack)
-				{
-					eventIterator->second[subscribeIndex]->m_callbackFn = nullptr;
-					eventIterator->second.erase(eventIterator->second.begin() + subscribeIndex);
-					break;
-				}
-			}
-			break;
-		}
+		return;
+	}
 
-		eventIterator++;
+	std::vector<EventCallBackFn>& subscribers = m_events[entryIndex].subscribers;
+	std::vector<EventCallBackFn>::iterator subscriberIterator = std::find(subscribers.begin(), subscribers.end(), callBack);
+	if(subscriberIterator != subscribers.end())
+	{
+		subscribers.erase(subscriberIterator);
 	}
 }
 
@@ -83,22 +83,28 @@ int EventSystems::FireEvent( const std::string& eventName )
 //------------------------------------------------------------------------------------------------------------------------------
 int EventSystems::FireEvent( const std::string& eventName, EventArgs& args )
 {
-	int numFired = 0;
-	std::map<std::string, SubscribersList >::iterator eventIterator;
+	return FireEntry(FindEntry(eventName), args);
+}
 
-	//Find the function to call
-	eventIterator = m_eventSubscriptions.find(eventName);
+//------------------------------------------------------------------------------------------------------------------------------
+int EventSystems::FireEvent( EventID eventID, EventArgs& args )
+{
+	return FireEntry(FindEntry(eventID), args);
+}
 
-	//If we are at the end just return 
-	if(eventIterator == m_eventSubscriptions.end())
+//------------------------------------------------------------------------------------------------------------------------------
+int EventSystems::FireEntry( uint entryIndex, EventArgs& args )
+{
+	if(entryIndex == EVENT_EMPTY_SLOT)
 	{
 		return 0;
 	}
 
-	bool eventConsumption;
-	for(int subscriberIndex = 0; subscriberIndex < static_cast<int>(eventIterator->second.size()); subscriberIndex++)
+	//Callbacks may subscribe or unsubscribe, so index into m_events again on every step instead of holding on to a reference
+	int numFired = 0;
+	for(uint subscriberIndex = 0; subscriberIndex < (uint)m_events[entryIndex].subscribers.size(); subscriberIndex++)
 	{
-		eventConsumption = eventIterator->second[subscriberIndex]->m_callbackFn(args);
+		bool eventConsumption = m_events[entryIndex].subscribers[subscriberIndex](args);
 		numFired++;
 		if(eventConsumption)
 		{
@@ -113,26 +119,263 @@ int EventSystems::FireEvent( const std::string& eventName, EventArgs& args )
 //------------------------------------------------------------------------------------------------------------------------------
 int EventSystems::GetNumSubscribersForCommand( const std::string& eventName ) const
 {
-	//Find the event
-	std::map<std::string, SubscribersList >::const_iterator eventIterator;
-	eventIterator = m_eventSubscriptions.find(eventName);
+	uint entryIndex = FindEntry(eventName);
+	if(entryIndex == EVENT_EMPTY_SLOT)
+	{
+		return 0;
+	}
 
-	int numEvents = static_cast<int>(eventIterator->second.size());
-	return numEvents;
+	return static_cast<int>(m_events[entryIndex].subscribers.size());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void EventSystems::GetSubscribedEventsList( std::vector<std::string>& eventNamesWithSubscribers ) const
 {
-	std::map<std::string, SubscribersList >::const_iterator eventIterator;
-	eventIterator = m_eventSubscriptions.begin();
-	while( eventIterator != m_eventSubscriptions.end() )
+	size_t firstNewName = eventNamesWithSubscribers.size();
+	for(const EventEntry_T& entry : m_events)
+	{
+		if(entry.subscribers.size() != 0)
+		{
+			eventNamesWithSubscribers.push_back(entry.name);
+		}
+	}
+
+	//Keep handing these back in alphabetical order like the old std::map did
+	std::sort(eventNamesWithSubscribers.begin() + firstNewName, eventNamesWithSubscribers.end());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint EventSystems::FindEntry( EventID eventID ) const
+{
+	if(m_slots.size() == 0)
+	{
+		return EVENT_EMPTY_SLOT;
+	}
+
+	uint mask = (uint)m_slots.size() - 1;
+	for(uint slotIndex = eventID & mask; ; slotIndex = (slotIndex + 1) & mask)
+	{
+		const EventSlot_T& slot = m_slots[slotIndex];
+		if(slot.entryIndex == EVENT_EMPTY_SLOT || slot.id == eventID)
+		{
+			return slot.entryIndex;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint EventSystems::FindEntry( const std::string& eventName ) const
+{
+	//Names that collide on the ID must not reach the other event's subscribers
+	uint entryIndex = FindEntry(GetEventID(eventName.c_str()));
+	if(entryIndex == EVENT_EMPTY_SLOT || m_events[entryIndex].name != eventName)
+	{
+		return EVENT_EMPTY_SLOT;
+	}
+
+	return entryIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint EventSystems::FindOrAddEntry( const std::string& eventName )
+{
+	EventID eventID = GetEventID(eventName.c_str());
+	uint entryIndex = FindEntry(eventID);
+	if(entryIndex != EVENT_EMPTY_SLOT)
+	{
+		if(m_events[entryIndex].name != eventName)
+		{
+			ERROR_RECOVERABLE(Stringf("Event %s has the same ID as event %s, it will not be subscribed", eventName.c_str(), m_events[entryIndex].name.c_str()));
+			return EVENT_EMPTY_SLOT;
+		}
+
+		return entryIndex;
+	}
+
+	//Grow before we go over half full so probes stay short
+	if((m_events.size() + 1) * 2 > m_slots.size())
+	{
+		Rehash(m_slots.size() == 0 ? EVENT_START_SLOTS : (uint)m_slots.size() * 2);
+	}
+
+	entryIndex = (uint)m_events.size();
+	m_events.push_back(EventEntry_T{ eventID, eventName, std::vector<EventCallBackFn>() });
+
+	uint mask = (uint)m_slots.size() - 1;
+	uint slotIndex = eventID & mask;
+	while(m_slots[slotIndex].entryIndex != EVENT_EMPTY_SLOT)
+	{
+		slotIndex = (slotIndex + 1) & mask;
+	}
+
+	m_slots[slotIndex].id = eventID;
+	m_slots[slotIndex].entryIndex = entryIndex;
+	return entryIndex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void EventSystems::Rehash( uint numSlots )
+{
+	m_slots.assign(numSlots, EventSlot_T());
+
+	uint mask = numSlots - 1;
+	for(uint entryIndex = 0; entryIndex < (uint)m_events.size(); entryIndex++)
+	{
+		uint slotIndex = m_events[entryIndex].id & mask;
+		while(m_slots[slotIndex].entryIndex != EVENT_EMPTY_SLOT)
+		{
+			slotIndex = (slotIndex + 1) & mask;
+		}
+
+		m_slots[slotIndex].id = m_events[entryIndex].id;
+		m_slots[slotIndex].entryIndex = entryIndex;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define EVENTTEST_FIRES 1000000
+#define EVENTTEST_NAMES 1000
+
+static int gEventTestCalls = 0;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool EventTestCount( EventArgs& args )
+{
+	UNUSED(args);
+	gEventTestCalls++;
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static bool EventTestConsume( EventArgs& args )
+{
+	UNUSED(args);
+	gEventTestCalls += 100;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("EventSystems", "Core", 100)
+{
+	constexpr EventID TEST_EVENT = GetEventID("EventTest_Fire");
+	static_assert(TEST_EVENT != GetEventID("EventTest_Other"), "Event IDs should differ");
+
+	EventSystems events;
+	EventArgs args;
+	CONFIRM(events.FireEvent("EventTest_Fire") == 0);
+	CONFIRM(events.GetNumSubscribersForCommand("EventTest_Fire") == 0);
+
+	events.SubscribeEventCallBackFn("EventTest_Fire", EventTestCount);
+	events.SubscribeEventCallBackFn("EventTest_Fire", EventTestCount);
+	gEventTestCalls = 0;
+	CONFIRM(events.FireEvent("EventTest_Fire") == 2 && gEventTestCalls == 2);
+	CONFIRM(events.FireEvent(TEST_EVENT, args) == 2 && gEventTestCalls == 4);
+	CONFIRM(events.FireEvent("EventTest_Other") == 0);
+
+	//A consumed event stops at the subscriber that consumed it
+	events.SubscribeEventCallBackFn("EventTest_Consume", EventTestConsume);
+	events.SubscribeEventCallBackFn("EventTest_Consume", EventTestCount);
+	gEventTestCalls = 0;
+	CONFIRM(events.FireEvent("EventTest_Consume") == 1 && gEventTestCalls == 100);
+
+	events.UnsubscribeEventCallBackFn("EventTest_Consume", EventTestConsume);
+	gEventTestCalls = 0;
+	CONFIRM(events.FireEvent("EventTest_Consume") == 1 && gEventTestCalls == 1);
+
+	events.UnsubscribeEventCallBackFn("EventTest_Fire", EventTestCount);
+	CONFIRM(events.GetNumSubscribersForCommand("EventTest_Fire") == 1);
+	events.UnsubscribeEventCallBackFn("EventTest_Fire", EventTestCount);
+	events.UnsubscribeEventCallBackFn("EventTest_NeverSubscribed", EventTestCount);
+	CONFIRM(events.FireEvent(TEST_EVENT, args) == 0);
+
+	//"costarring" and "liquid" have the same FNV-1a hash, only the name that was subscribed gets through
+	static_assert(GetEventID("costarring") == GetEventID("liquid"), "Test names should collide");
+	events.SubscribeEventCallBackFn("costarring", EventTestCount);
+	gEventTestCalls = 0;
+	CONFIRM(events.FireEvent("liquid") == 0 && events.FireEvent("liquid", args) == 0 && gEventTestCalls == 0);
+	CONFIRM(events.GetNumSubscribersForCommand("liquid") == 0);
+	events.UnsubscribeEventCallBackFn("liquid", EventTestCount);
+	CONFIRM(events.GetNumSubscribersForCommand("costarring") == 1);
+	CONFIRM(events.FireEvent("costarring") == 1 && gEventTestCalls == 1);
+	events.UnsubscribeEventCallBackFn("costarring", EventTestCount);
+
+	//Enough names to rehash a few times, all still found afterwards
+	for(int nameIndex = 0; nameIndex < EVENTTEST_NAMES; nameIndex++)
+	{
+		events.SubscribeEventCallBackFn(Stringf("EventTest_%d", nameIndex), EventTestCount);
+	}
+
+	gEventTestCalls = 0;
+	for(int nameIndex = 0; nameIndex < EVENTTEST_NAMES; nameIndex++)
+	{
+		events.FireEvent(Stringf("EventTest_%d", nameIndex));
+	}
+	CONFIRM(gEventTestCalls == EVENTTEST_NAMES);
+
+	//Only events that still have subscribers are listed, in order
+	std::vector<std::string> eventNames;
+	events.GetSubscribedEventsList(eventNames);
+	CONFIRM(eventNames.size() == EVENTTEST_NAMES + 1);
+	CONFIRM(std::is_sorted(eventNames.begin(), eventNames.end()));
+	CONFIRM(std::find(eventNames.begin(), eventNames.end(), "EventTest_Fire") == eventNames.end());
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("EventSystemsFire", "Core", 200)
+{
+	std::vector<std::string> names;
+	std::vector<EventID> eventIDs;
+	for(int nameIndex = 0; nameIndex < EVENTTEST_NAMES; nameIndex++)
 	{
-		if(eventIterator->second.size() != 0)
+		names.push_back(Stringf("EventBenchmark_Event_%d", nameIndex));
+		eventIDs.push_back(GetEventID(names.back().c_str()));
+	}
+
+	//What FireEvent used to do, a std::map lookup by string and then a walk over the subscribers
+	std::map<std::string, std::vector<EventCallBackFn>> legacyEvents;
+	EventSystems events;
+	for(int nameIndex = 0; nameIndex < EVENTTEST_NAMES; nameIndex++)
+	{
+		legacyEvents[names[nameIndex]].push_back(EventTestCount);
+		events.SubscribeEventCallBackFn(names[nameIndex], EventTestCount);
+	}
+
+	EventArgs args;
+	char const* runNames[3] = { "std::map by name", "hashed by name", "hashed by EventID" };
+	for(int runIndex = 0; runIndex < 3; runIndex++)
+	{
+		gEventTestCalls = 0;
+		double startTime = GetCurrentTimeSeconds();
+		for(int fireIndex = 0; fireIndex < EVENTTEST_FIRES; fireIndex++)
 		{
-			eventNamesWithSubscribers.push_back(eventIterator->first);
+			//Stride through the names so consecutive fires don't hit the same event
+			int nameIndex = (fireIndex * 7) % EVENTTEST_NAMES;
+			if(runIndex == 0)
+			{
+				std::map<std::string, std::vector<EventCallBackFn>>::iterator eventIterator = legacyEvents.find(names[nameIndex]);
+				for(EventCallBackFn subscriber : eventIterator->second)
+				{
+					subscriber(args);
+				}
+			}
+			else if(runIndex == 1)
+			{
+				events.FireEvent(names[nameIndex], args);
+			}
+			else
+			{
+				events.FireEvent(eventIDs[nameIndex], args);
+			}
 		}
 
-		eventIterator++;
+		double elapsed = GetCurrentTimeSeconds() - startTime;
+		DebuggerPrintf("\n Event fire %-18s %d fires across %d events: %.2f ms, %.2f ns per fire %s", runNames[runIndex], EVENTTEST_FIRES,
+			EVENTTEST_NAMES, elapsed * 1000.0, elapsed * 1000000000.0 / (double)EVENTTEST_FIRES, gEventTestCalls == EVENTTEST_FIRES ? "" : "(WRONG)");
 	}
+
+	return true;
 }
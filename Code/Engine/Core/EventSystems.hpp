@@ -4,27 +4,48 @@
 #include "Engine/Core/NamedStrings.hpp"
 
 typedef bool (*EventCallBackFn)(EventArgs& args);
+typedef uint32_t EventID;
 
 //------------------------------------------------------------------------------------------------------------------------------
-class EventSubscription
+// FNV-1a of the event name. It is constexpr so a name known at compile time only gets hashed once, for example
+// constexpr EventID HELP_EVENT = GetEventID("Help"); and then FireEvent(HELP_EVENT, args)
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr EventID GetEventID(char const* eventName)
 {
-	friend class EventSystems;
-
-private:
-	EventSubscription(EventCallBackFn name)
+	EventID hash = 2166136261U;
+	for (char const* character = eventName; *character != '\0'; ++character)
 	{
-		m_callbackFn = name;
+		hash = (hash ^ (EventID)(unsigned char)*character) * 16777619U;
 	}
 
-private:
-	EventCallBackFn m_callbackFn = nullptr;
-};
+	return hash;
+}
 
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Events live in a flat open addressing hash map keyed by EventID, so fire, subscribe and unsubscribe are all a single
+// probe plus a walk over that event's own subscriber array. Subscribers are stored as plain function pointers, nothing is
+// allocated per subscription and nothing at all is allocated to fire an event. Two names that hash to the same ID can't be
+// subscribed at the same time, the second one is rejected with a warning. Anything called with a name checks it against the
+// event it found, firing by EventID skips that check.
 //------------------------------------------------------------------------------------------------------------------------------
 class EventSystems
 {
-	//Use this for std::map being stored as m_eventSubscriptions
-	typedef std::vector<EventSubscription*> SubscribersList;
+	struct EventEntry_T
+	{
+		EventID							id;
+		std::string						name;
+		std::vector<EventCallBackFn>	subscribers;
+	};
+
+	//entryIndex is EVENT_EMPTY_SLOT for a slot that was never used, events are never removed from the map
+	struct EventSlot_T
+	{
+		EventID							id = 0;
+		uint							entryIndex = EVENT_EMPTY_SLOT;
+	};
+
+	static constexpr uint EVENT_EMPTY_SLOT = 0xFFFFFFFF;
+	static constexpr uint EVENT_START_SLOTS = 256;
 
 public:
 	EventSystems();
@@ -39,9 +60,18 @@ public:
 	void			UnsubscribeEventCallBackFn(const std::string& eventName, EventCallBackFn callBack);
 	int				FireEvent(const std::string& eventName);
 	int				FireEvent(const std::string& eventName, EventArgs& args);
+	int				FireEvent(EventID eventID, EventArgs& args);
 	int				GetNumSubscribersForCommand(const std::string& eventName) const;
 	void			GetSubscribedEventsList(std::vector<std::string>& eventNamesWithSubscribers) const;
 
 private:
-	std::map<std::string, SubscribersList > m_eventSubscriptions;
+	uint			FindEntry(EventID eventID) const;				// EVENT_EMPTY_SLOT if there is no such event
+	uint			FindEntry(const std::string& eventName) const;	// also EVENT_EMPTY_SLOT if a different name has its ID
+	uint			FindOrAddEntry(const std::string& eventName);	// EVENT_EMPTY_SLOT on a hash collision
+	void			Rehash(uint numSlots);
+	int				FireEntry(uint entryIndex, EventArgs& args);
+
+private:
+	std::vector<EventEntry_T>		m_events;
+	std::vector<EventSlot_T>		m_slots;						// power of 2 and at most half full
 };
\ No newline at end of file
@@ -97,6 +97,11 @@ void Job::FinishJob()
 		(*itr)->TryStart();
 		itr++;
 	}
+
+	if (m_counter.IsValid())
+	{
+		JobSystem::GetInstance()->DecrementCounter(m_counter);
+	}
 	
 	if (m_finishCallback != nullptr) 
 	{
@@ -2,16 +2,19 @@
 #include "Engine/Core/JobSystem/JobTypes.hpp"
 #include <functional>
 #include <atomic>
+#include <stdint.h>
 #include <mutex>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------
 class Job
 {
 	friend class JobSystem;
+	friend class JobCategory;
 
 public:
 	Job();
-	~Job();
+	virtual ~Job();
 
 	using finishCallback = std::function<void(Job*)>;
 
@@ -27,6 +30,13 @@ public:
 
 	void				SetJobCategory(eJobCategory type);
 	eJobCategory		GetJobCategory();
+
+	void				SetPriority(eJobPriority priority)			{ m_priority = priority; }
+	eJobPriority		GetPriority() const							{ return (eJobPriority)m_priority; }
+
+	//Rough guess of how long Execute takes. Used to skip the job when processing up to a deadline it can't make
+	void				SetEstimatedCostMS(float estimatedCostMS)	{ m_estimatedCostMS = estimatedCostMS; }
+	float				GetEstimatedCostMS() const					{ return m_estimatedCostMS; }
 	virtual void		Execute() = 0;
 
 private:
@@ -36,13 +46,20 @@ private:
 	void				FinishJob();
 
 	int 				m_category = JOB_GENERIC;
+	int					m_priority = JOB_PRIORITY_NORMAL;
+	float				m_estimatedCostMS = 0.f;
+
+	//Set when the job is queued so we can track how long it waited to run
+	uint64_t			m_enqueueHPC = 0U;
+
+	//Counter to decrement once this job is done, only set for jobs started with JobSystem::RunJob
+	JobHandle			m_counter;
 
 	std::vector<Job*> 	m_successors;
 	std::atomic<int> 	m_predecessorCount;
 
 	// Options - support at least one callback version
 	finishCallback		m_finishCallback;
-	std::string 		m_event;
 
 	std::mutex			m_mutex;
 };
\ No newline at end of file
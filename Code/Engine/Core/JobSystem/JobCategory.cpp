@@ -1,29 +1,85 @@
 #include "Engine/Core/JobSystem/JobCategory.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobCategory::JobQueue_T::Enqueue(Job* job)
+{
+	//Once jobs have spilled keep spilling until the overflow drains so jobs still come out in the order they were queued
+	if (numOverflowJobs.load(std::memory_order_acquire) == 0 && queue.TryEnqueue(job))
+	{
+		return;
+	}
+
+	numOverflowJobs.fetch_add(1, std::memory_order_acq_rel);
+	overflow.EnqueueLocked(job);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool JobCategory::JobQueue_T::TryDequeue(Job** out)
+{
+	if (queue.TryDequeue(out))
+	{
+		return true;
+	}
+
+	if (numOverflowJobs.load(std::memory_order_acquire) > 0 && overflow.DequeueLocked(out))
+	{
+		numOverflowJobs.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+JobCategory::JobCategory()
+{
+
+}
 
 //------------------------------------------------------------------------------------------------------------------------------
 void JobCategory::Enqueue(Job* job)
 {
-	m_pendingQueue.EnqueueLocked(job);
+	m_pendingQueues[job->GetPriority()].Enqueue(job);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 Job* JobCategory::TryDequeue()
 {
 	Job* jobReturned = nullptr;
-	m_pendingQueue.DequeueLocked(&jobReturned);
+	for (int priority = 0; priority < JOB_PRIORITY_COUNT; ++priority)
+	{
+		if (m_pendingQueues[priority].TryDequeue(&jobReturned))
+		{
+			return jobReturned;
+		}
+	}
 
-	return jobReturned;
+	return nullptr;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-Job* JobCategory::Dequeue()
+Job* JobCategory::TryDequeue(eJobPriority priority)
 {
 	Job* jobReturned = nullptr;
-	bool result = false;
+	m_pendingQueues[priority].TryDequeue(&jobReturned);
 
-	while (!result)
+	return jobReturned;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Job* JobCategory::Dequeue()
+{
+	Job* jobReturned = TryDequeue();
+	while (jobReturned == nullptr)
 	{
-		result = m_pendingQueue.DequeueLocked(&jobReturned);
+		std::this_thread::yield();
+		jobReturned = TryDequeue();
 	}
 
 	return jobReturned;
@@ -32,14 +88,241 @@ Job* JobCategory::Dequeue()
 //------------------------------------------------------------------------------------------------------------------------------
 void JobCategory::EnqueueFinished(Job* job)
 {
-	m_finishQueue.EnqueueLocked(job);
+	m_finishQueue.Enqueue(job);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 Job* JobCategory::TryDequeueFinished()
 {
 	Job* jobReturned = nullptr;
-	m_finishQueue.DequeueLocked(&jobReturned);
+	m_finishQueue.TryDequeue(&jobReturned);
 
 	return jobReturned;
 }
+
+//------------------------------------------------------------------------------------------------------------------------------
+int JobCategory::GetNumPendingJobs() const
+{
+	int numPending = 0;
+	for (int priority = 0; priority < JOB_PRIORITY_COUNT; ++priority)
+	{
+		numPending += m_pendingQueues[priority].GetLength();
+	}
+
+	return numPending;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int JobCategory::GetNumOverflowJobs() const
+{
+	int numOverflow = m_finishQueue.numOverflowJobs.load(std::memory_order_relaxed);
+	for (int priority = 0; priority < JOB_PRIORITY_COUNT; ++priority)
+	{
+		numOverflow += m_pendingQueues[priority].numOverflowJobs.load(std::memory_order_relaxed);
+	}
+
+	return numOverflow;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobCategory::RecordJobStarted(Job* job)
+{
+	PriorityCounters_T& counters = m_priorityCounters[job->GetPriority()];
+
+	uint64_t nowHPC = GetCurrentTimeHPC();
+	uint64_t waitHPC = (nowHPC > job->m_enqueueHPC) ? nowHPC - job->m_enqueueHPC : 0U;
+
+	counters.m_numJobsStarted.fetch_add(1, std::memory_order_relaxed);
+	counters.m_totalWaitHPC.fetch_add(waitHPC, std::memory_order_relaxed);
+
+	uint64_t maxWaitHPC = counters.m_maxWaitHPC.load(std::memory_order_relaxed);
+	while (waitHPC > maxWaitHPC && !counters.m_maxWaitHPC.compare_exchange_weak(maxWaitHPC, waitHPC, std::memory_order_relaxed));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobCategory::GetPriorityStats(eJobPriority priority, JobPriorityStats_T* outStats) const
+{
+	PriorityCounters_T const& counters = m_priorityCounters[priority];
+
+	outStats->m_pendingJobs = m_pendingQueues[priority].GetLength();
+	outStats->m_numJobsStarted = counters.m_numJobsStarted.load(std::memory_order_relaxed);
+
+	double totalWaitMS = GetHPCToSeconds(counters.m_totalWaitHPC.load(std::memory_order_relaxed)) * 1000.0;
+	outStats->m_averageWaitMS = (outStats->m_numJobsStarted > 0) ? totalWaitMS / (double)outStats->m_numJobsStarted : 0.0;
+	outStats->m_maxWaitMS = GetHPCToSeconds(counters.m_maxWaitHPC.load(std::memory_order_relaxed)) * 1000.0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobCategory::ResetStats()
+{
+	for (int priority = 0; priority < JOB_PRIORITY_COUNT; ++priority)
+	{
+		m_priorityCounters[priority].m_numJobsStarted = 0U;
+		m_priorityCounters[priority].m_totalWaitHPC = 0U;
+		m_priorityCounters[priority].m_maxWaitHPC = 0U;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define QUEUETEST_CAPACITY 64
+#define QUEUETEST_ITEMS_PER_PRODUCER 500'000
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void QueueStressProducer(MPMCAsyncQueue<uint>& queue, uint producerIndex)
+{
+	uint firstItem = producerIndex * QUEUETEST_ITEMS_PER_PRODUCER;
+	for (uint itemIndex = 0; itemIndex < QUEUETEST_ITEMS_PER_PRODUCER; ++itemIndex)
+	{
+		//Mix the blocking and non blocking paths so both see a full queue
+		uint item = firstItem + itemIndex;
+		if (itemIndex & 1)
+		{
+			queue.Enqueue(item);
+		}
+		else
+		{
+			while (!queue.TryEnqueue(item))
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void QueueStressConsumer(MPMCAsyncQueue<uint>& queue, std::vector<std::atomic<uint>>& seenCounts, std::atomic<uint>& consumedCount, uint totalItems)
+{
+	uint item = 0;
+	while (consumedCount.load(std::memory_order_relaxed) < totalItems)
+	{
+		if (queue.TryDequeue(&item))
+		{
+			seenCounts[item]++;
+			consumedCount++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Hammers a tiny queue with producers and consumers so it is constantly full or empty, then checks every item came out once
+UNITTEST("MPMCQueueStress", "JobSystem", 100)
+{
+	uint coreCount = std::thread::hardware_concurrency();
+	uint numProducers = (coreCount / 2 > 1) ? coreCount / 2 : 2;
+	uint numConsumers = numProducers;
+	uint totalItems = numProducers * QUEUETEST_ITEMS_PER_PRODUCER;
+
+	MPMCAsyncQueue<uint> queue(QUEUETEST_CAPACITY);
+	std::vector<std::atomic<uint>> seenCounts(totalItems);
+	std::atomic<uint> consumedCount = 0U;
+
+	std::vector<std::thread> threads;
+	for (uint consumerIndex = 0; consumerIndex < numConsumers; ++consumerIndex)
+	{
+		threads.emplace_back(QueueStressConsumer, std::ref(queue), std::ref(seenCounts), std::ref(consumedCount), totalItems);
+	}
+
+	for (uint producerIndex = 0; producerIndex < numProducers; ++producerIndex)
+	{
+		threads.emplace_back(QueueStressProducer, std::ref(queue), producerIndex);
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	uint lostItems = 0;
+	uint duplicatedItems = 0;
+	for (uint itemIndex = 0; itemIndex < totalItems; ++itemIndex)
+	{
+		uint count = seenCounts[itemIndex].load();
+		if (count == 0)
+		{
+			++lostItems;
+		}
+		else if (count > 1)
+		{
+			++duplicatedItems;
+		}
+	}
+
+	DebuggerPrintf("\n MPMC queue stress: %u items, %u lost, %u duplicated", totalItems, lostItems, duplicatedItems);
+
+	uint leftOver = 0;
+	return (lostItems == 0) && (duplicatedItems == 0) && !queue.TryDequeue(&leftOver);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+class PriorityTestJob : public Job
+{
+public:
+	explicit PriorityTestJob(eJobPriority priority = JOB_PRIORITY_NORMAL) { SetPriority(priority); }
+	void	Execute() {}
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Jobs queued low to high must come back out high to low, and in order within a priority
+UNITTEST("JobPriorityOrder", "JobSystem", 100)
+{
+	JobCategory category;
+
+	PriorityTestJob lowJob(JOB_PRIORITY_LOW);
+	PriorityTestJob normalJob(JOB_PRIORITY_NORMAL);
+	PriorityTestJob firstHighJob(JOB_PRIORITY_HIGH);
+	PriorityTestJob secondHighJob(JOB_PRIORITY_HIGH);
+
+	category.Enqueue(&lowJob);
+	category.Enqueue(&normalJob);
+	category.Enqueue(&firstHighJob);
+	category.Enqueue(&secondHighJob);
+
+	CONFIRM(category.GetNumPendingJobs() == 4);
+	CONFIRM(category.GetNumPendingJobs(JOB_PRIORITY_HIGH) == 2);
+
+	CONFIRM(category.TryDequeue() == &firstHighJob);
+	CONFIRM(category.TryDequeue() == &secondHighJob);
+	CONFIRM(category.TryDequeue() == &normalJob);
+
+	category.RecordJobStarted(&lowJob);
+	JobPriorityStats_T lowStats;
+	category.GetPriorityStats(JOB_PRIORITY_LOW, &lowStats);
+	CONFIRM(lowStats.m_numJobsStarted == 1 && lowStats.m_pendingJobs == 1);
+
+	CONFIRM(category.TryDequeue() == &lowJob);
+	return category.TryDequeue() == nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// The main and render categories are filled and drained by the same thread, queueing past the capacity before draining
+// must spill instead of waiting on itself
+UNITTEST("JobCategoryOverflow", "JobSystem", 100)
+{
+	constexpr int numJobs = (int)JOB_CATEGORY_QUEUE_CAPACITY + 1000;
+
+	JobCategory category;
+	std::unique_ptr<PriorityTestJob[]> jobs(new PriorityTestJob[numJobs]);
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		category.Enqueue(&jobs[jobIndex]);
+		category.EnqueueFinished(&jobs[jobIndex]);
+	}
+
+	CONFIRM(category.GetNumPendingJobs() == numJobs);
+	CONFIRM(category.GetNumOverflowJobs() == 2 * (numJobs - (int)JOB_CATEGORY_QUEUE_CAPACITY));
+
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+	{
+		CONFIRM(category.TryDequeue() == &jobs[jobIndex]);
+		CONFIRM(category.TryDequeueFinished() == &jobs[jobIndex]);
+	}
+
+	CONFIRM(category.GetNumOverflowJobs() == 0);
+	return category.TryDequeue() == nullptr && category.TryDequeueFinished() == nullptr;
+}
\ No newline at end of file
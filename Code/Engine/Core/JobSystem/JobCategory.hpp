@@ -1,19 +1,69 @@
 #pragma once
 #include "Engine/Core/JobSystem/Job.hpp"
 #include "Engine/Core/Async/AsyncQueue.hpp"
+#include "Engine/Core/Async/MPMCAsyncQueue.hpp"
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Jobs that can be waiting in a category's lock-free queue at once. Past this jobs spill into a locked overflow queue instead
+// of blocking, the main and render categories are only drained by the thread that fills them so Enqueue must never wait
+constexpr size_t JOB_CATEGORY_QUEUE_CAPACITY = 16384;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct JobPriorityStats_T
+{
+	int						m_pendingJobs = 0;
+	uint64_t				m_numJobsStarted = 0U;
+	double					m_averageWaitMS = 0.0;
+	double					m_maxWaitMS = 0.0;
+};
 
 //------------------------------------------------------------------------------------------------------------------------------
 class JobCategory
 {
 public:
-	void				Enqueue(Job* job);
-	Job*				TryDequeue();			// returns nullptr if no job is ready(I.e fails if the queue is empty)
-	Job*				Dequeue();				// returns nullptr only if system is shutdown, otherwise block until a job is ready for use (I.e waits till a job was added to queue)
+	JobCategory();
+
+	void					Enqueue(Job* job);		// queued by the job's priority
+	Job*					TryDequeue();			// returns nullptr if no job is ready(I.e fails if the queue is empty). Highest priority first
+	Job*					TryDequeue(eJobPriority priority);
+	Job*					Dequeue();				// returns nullptr only if system is shutdown, otherwise block until a job is ready for use (I.e waits till a job was added to queue)
+
+	void					EnqueueFinished(Job* job);
+	Job*					TryDequeueFinished();
 
-	void				EnqueueFinished(Job* job);
-	Job*				TryDequeueFinished();
+	int						GetNumPendingJobs() const;
+	int						GetNumPendingJobs(eJobPriority priority) const		{ return m_pendingQueues[priority].GetLength(); }
+	int						GetNumOverflowJobs() const;
+
+	//Stats are tracked from when a job was queued to when it started running
+	void					RecordJobStarted(Job* job);
+	void					GetPriorityStats(eJobPriority priority, JobPriorityStats_T* outStats) const;
+	void					ResetStats();
 
 private:
-	AsyncQueue<Job*>	m_pendingQueue;
-	AsyncQueue<Job*>	m_finishQueue;
+	//Lock-free ring with an unbounded locked queue behind it for when the ring is full
+	struct JobQueue_T
+	{
+		JobQueue_T() : queue(JOB_CATEGORY_QUEUE_CAPACITY) {}
+
+		void					Enqueue(Job* job);
+		bool					TryDequeue(Job** out);
+		int						GetLength() const		{ return queue.GetLength() + numOverflowJobs.load(std::memory_order_relaxed); }
+
+		MPMCAsyncQueue<Job*>	queue;
+		AsyncQueue<Job*>		overflow;
+		std::atomic<int>		numOverflowJobs = 0;
+	};
+
+	struct PriorityCounters_T
+	{
+		std::atomic<uint64_t>	m_numJobsStarted = 0U;
+		std::atomic<uint64_t>	m_totalWaitHPC = 0U;
+		std::atomic<uint64_t>	m_maxWaitHPC = 0U;
+	};
+
+	JobQueue_T				m_pendingQueues[JOB_PRIORITY_COUNT];
+	PriorityCounters_T		m_priorityCounters[JOB_PRIORITY_COUNT];
+
+	JobQueue_T				m_finishQueue;
 };
\ No newline at end of file
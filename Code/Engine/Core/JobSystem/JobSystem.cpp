@@ -2,12 +2,70 @@
 #include "Engine/Commons/EngineCommon.hpp"
 #include "Engine/Core/JobSystem/Job.hpp"
 #include "Engine/Core/Time.hpp"
-
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
+#include "Engine/Core/Async/AsyncQueue.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Allocators/UntrackedAllocator.hpp"
 
 JobSystem* gJobSystem = nullptr;
 
+//------------------------------------------------------------------------------------------------------------------------------
+//Index of the generic worker running on this thread, -1 for any thread that is not a generic worker
+static thread_local int tWorkerIndex = -1;
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Job made by RunJob. Lives in the JobSystem's block pool so running one never touches the general heap
+//------------------------------------------------------------------------------------------------------------------------------
+class PooledJob : public Job
+{
+public:
+	PooledJob(JobFunction function, void* data);
+	~PooledJob();
+
+	void			Execute();
+
+	static void*	operator new(size_t size);
+	static void		operator delete(void* ptr);
+
+private:
+	JobFunction		m_function = nullptr;
+	void*			m_data = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+PooledJob::PooledJob(JobFunction function, void* data)
+{
+	m_function = function;
+	m_data = data;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+PooledJob::~PooledJob()
+{
+
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PooledJob::Execute()
+{
+	m_function(m_data);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void* PooledJob::operator new(size_t size)
+{
+	void* buffer = JobSystem::GetInstance()->m_jobPool.Allocate(size);
+	ASSERT_OR_DIE(buffer != nullptr, "Job pool could not allocate a pooled job");
+
+	return buffer;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void PooledJob::operator delete(void* ptr)
+{
+	//Same accessor as operator new so a job always goes back to the pool it came from
+	JobSystem::GetInstance()->m_jobPool.Free(ptr);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 JobSystem* JobSystem::CreateInstance()
 {
@@ -39,17 +97,25 @@ void JobSystem::DestroyInstance()
 	{
 		gJobSystem->Shutdown();
 		delete gJobSystem;
+		gJobSystem = nullptr;
 	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 void JobSystem::Startup(int numGenericThreads /*= -1*/, int numCategories /*= JOB_CATEGORY_CORE_COUNT*/)
 {
-	m_genericJobsSemaphore.Create(0, 1);
 	m_isRunning = true;
 
 	//Create required number of JobCategories
 	m_categories = new JobCategory[numCategories];
+	m_numCategories = numCategories;
+
+	m_jobPool.Initialize(UntrackedAllocator::GetInstance(), sizeof(PooledJob), alignof(PooledJob), JOB_POOL_BLOCKS_PER_CHUNK);
+
+	for (uint counterIndex = 0; counterIndex < JOB_MAX_COUNTERS; ++counterIndex)
+	{
+		m_freeCounters.Enqueue(counterIndex);
+	}
 
 	// figure out thread count
 	int coreCount = std::thread::hardware_concurrency();
@@ -67,10 +133,16 @@ void JobSystem::Startup(int numGenericThreads /*= -1*/, int numCategories /*= JO
 		numThreadsToMake = numGenericThreads;
 	}
 
+	//Every worker gets its own deque before any thread starts so thieves never see a partial list
+	for (int threadIndex = 0; threadIndex < numThreadsToMake; threadIndex++)
+	{
+		m_workerQueues.push_back(new WorkStealingQueue<Job*>(WORKER_QUEUE_CAPACITY));
+	}
+
 	for (int threadIndex = 0; threadIndex < numThreadsToMake; threadIndex++)
 	{
 		//Make these threads run the generic work task
-		m_genericThreads.emplace_back(&GenericThreadWork);
+		m_genericThreads.emplace_back(&GenericThreadWork, threadIndex);
 	}
 }
 
@@ -78,13 +150,22 @@ void JobSystem::Startup(int numGenericThreads /*= -1*/, int numCategories /*= JO
 void JobSystem::Shutdown()
 {
 	m_isRunning = false;
-	SignalWork();
+	m_workerParker.WakeAll();
 
 	for (int threadIndex = 0; threadIndex < m_genericThreads.size(); threadIndex++)
 	{
 		m_genericThreads[threadIndex].join();
 	}
+	m_genericThreads.clear();
 
+	for (int queueIndex = 0; queueIndex < (int)m_workerQueues.size(); queueIndex++)
+	{
+		delete m_workerQueues[queueIndex];
+		m_workerQueues[queueIndex] = nullptr;
+	}
+	m_workerQueues.clear();
+
+	m_jobPool.Deinitialize();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -96,47 +177,90 @@ void JobSystem::Run(Job* job)
 //------------------------------------------------------------------------------------------------------------------------------
 bool JobSystem::ProcessCategoryForTimeInMS(int category, uint ms)
 {
-	double startTime = GetCurrentTimeSeconds() * 1000;
-	double endTime = 0;
-	bool elapsed = false;
-	bool result = false;
+	double deadlineSeconds = GetCurrentTimeSeconds() + (double)ms * 0.001;
+	return ProcessCategoryUntilDeadline(category, deadlineSeconds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool JobSystem::ProcessCategoryUntilDeadline(int category, double deadlineSeconds)
+{
+	//Jobs skipped in a row since the last one we ran. Once that covers everything queued nothing left fits in the time we have
+	int numSkippedInARow = 0;
 
-	while (!elapsed)
+	double currentTime = GetCurrentTimeSeconds();
+	while (currentTime < deadlineSeconds)
 	{
-		result = ProcessCategory(category);
-		if (!result)
+		Job* job = TryGetJob(category);
+		if (job == nullptr)
 		{
-			elapsed = true;
+			return numSkippedInARow > 0;
 		}
 
-		endTime = GetCurrentTimeSeconds() * 1000;
-		if (endTime > startTime + ms)
+		//Don't start something we already know will blow the deadline, leave it for the next frame or a worker and keep
+		//looking for something shorter to fill the time that is left
+		double remainingMS = (deadlineSeconds - currentTime) * 1000.0;
+		if ((double)job->GetEstimatedCostMS() > remainingMS)
 		{
-			elapsed = true;
+			m_categories[category].Enqueue(job);
+			if (category == JOB_GENERIC)
+			{
+				m_workerParker.WakeOne();
+			}
+
+			++numSkippedInARow;
+			if (numSkippedInARow >= m_categories[category].GetNumPendingJobs())
+			{
+				return true;
+			}
+
+			currentTime = GetCurrentTimeSeconds();
+			continue;
 		}
+
+		numSkippedInARow = 0;
+		ExecuteJob(job, category);
+		currentTime = GetCurrentTimeSeconds();
 	}
 
-	return result;
+	return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
 bool JobSystem::ProcessCategory(int category)
 {
-	Job* job = nullptr;
-
-	job = m_categories[category].TryDequeue();
+	Job* job = TryGetJob(category);
 
 	if (job != nullptr)
 	{
-		job->Execute();
-		job->FinishJob();
-
+		ExecuteJob(job, category);
 		return true;
 	}
 
 	return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+Job* JobSystem::TryGetJob(int category)
+{
+	if (category == JOB_GENERIC)
+	{
+		return TryGetGenericJob();
+	}
+	else
+	{
+		return m_categories[category].TryDequeue();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobSystem::ExecuteJob(Job* job, int category)
+{
+	m_categories[category].RecordJobStarted(job);
+
+	job->Execute();
+	job->FinishJob();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 void JobSystem::ProcessFinishJobsForCategory(int category)
 {
@@ -156,8 +280,25 @@ void JobSystem::ProcessFinishJobsForCategory(int category)
 //------------------------------------------------------------------------------------------------------------------------------
 void JobSystem::AddJobForCategory(Job* job, int category)
 {
-	m_categories[category].Enqueue(job);
-	SignalWork();
+	job->m_enqueueHPC = GetCurrentTimeHPC();
+
+	//Generic workers keep the NORMAL jobs they spawn in their own deque, everyone else (or a full deque) uses the shared queues
+	bool pushedToWorker = false;
+	if (category == JOB_GENERIC && tWorkerIndex >= 0 && job->GetPriority() == JOB_PRIORITY_NORMAL)
+	{
+		pushedToWorker = m_workerQueues[tWorkerIndex]->Push(job);
+	}
+
+	if (!pushedToWorker)
+	{
+		m_categories[category].Enqueue(job);
+	}
+
+	//Only generic jobs are run by the workers, the other categories are pumped by their owning threads
+	if (category == JOB_GENERIC)
+	{
+		m_workerParker.WakeOne();
+	}
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
@@ -167,18 +308,605 @@ void JobSystem::AddFinishedJobForCategory(Job* job, int category)
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-STATIC void JobSystem::GenericThreadWork()
+Job* JobSystem::TryGetGenericJob()
+{
+	JobCategory& genericCategory = m_categories[JOB_GENERIC];
+
+	Job* job = genericCategory.TryDequeue(JOB_PRIORITY_HIGH);
+	if (job != nullptr)
+	{
+		return job;
+	}
+
+	//Newest job on our own deque is the most likely to be cache warm
+	if (tWorkerIndex >= 0 && m_workerQueues[tWorkerIndex]->Pop(&job))
+	{
+		return job;
+	}
+
+	job = genericCategory.TryDequeue(JOB_PRIORITY_NORMAL);
+	if (job != nullptr)
+	{
+		return job;
+	}
+
+	job = TryStealGenericJob();
+	if (job != nullptr)
+	{
+		return job;
+	}
+
+	return genericCategory.TryDequeue(JOB_PRIORITY_LOW);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+Job* JobSystem::TryStealGenericJob()
+{
+	int numQueues = (int)m_workerQueues.size();
+	if (numQueues == 0)
+	{
+		return nullptr;
+	}
+
+	//Start at a different victim each time so thieves spread out instead of all hitting worker 0
+	int startIndex = (int)(m_stealSeed.fetch_add(1, std::memory_order_relaxed) % (uint)numQueues);
+
+	Job* job = nullptr;
+	for (int offset = 0; offset < numQueues; offset++)
+	{
+		int victimIndex = (startIndex + offset) % numQueues;
+		if (victimIndex == tWorkerIndex)
+		{
+			continue;
+		}
+
+		if (m_workerQueues[victimIndex]->Steal(&job))
+		{
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobSystem::GetPriorityStats(int category, eJobPriority priority, JobPriorityStats_T* outStats) const
+{
+	m_categories[category].GetPriorityStats(priority, outStats);
+
+	if (category == JOB_GENERIC && priority == JOB_PRIORITY_NORMAL)
+	{
+		for (int queueIndex = 0; queueIndex < (int)m_workerQueues.size(); queueIndex++)
+		{
+			outStats->m_pendingJobs += m_workerQueues[queueIndex]->GetLength();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobSystem::ResetPriorityStats()
+{
+	for (int category = 0; category < m_numCategories; ++category)
+	{
+		m_categories[category].ResetStats();
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+JobHandle JobSystem::RunJob(JobFunction function, void* data, JobHandle counter /*= JobHandle()*/, eJobPriority priority /*= JOB_PRIORITY_NORMAL*/)
+{
+	if (!counter.IsValid())
+	{
+		counter = CreateCounter();
+	}
+
+	//Count the job before it can possibly run so a WaitFor can never see the counter hit 0 early
+	m_counters[counter.m_index].m_pendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+	PooledJob* job = new PooledJob(function, data);
+	job->m_counter = counter;
+	job->SetPriority(priority);
+	job->TryStart();
+
+	return counter;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobSystem::WaitFor(JobHandle handle)
 {
+	if (!handle.IsValid())
+	{
+		return;
+	}
+
+	while (!IsDone(handle))
+	{
+		//Help out instead of blocking, the jobs we are waiting on may be sitting in our own deque
+		if (!ProcessCategory(JOB_GENERIC))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	ReleaseCounter(handle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool JobSystem::IsDone(JobHandle handle) const
+{
+	JobCounter_T const& counter = m_counters[handle.m_index];
+
+	//A newer generation means this handle was already waited on and released
+	if (counter.m_generation.load(std::memory_order_acquire) != handle.m_generation)
+	{
+		return true;
+	}
+
+	return counter.m_pendingJobs.load(std::memory_order_acquire) == 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobSystem::DecrementCounter(JobHandle handle)
+{
+	int pendingJobs = m_counters[handle.m_index].m_pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+	ASSERT_RECOVERABLE(pendingJobs > 0, "Job counter was decremented more times than jobs were added to it");
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+JobHandle JobSystem::CreateCounter()
+{
+	uint counterIndex = 0;
+	bool result = m_freeCounters.TryDequeue(&counterIndex);
+	ASSERT_OR_DIE(result, "Ran out of job counters, make sure every handle from RunJob is passed to WaitFor");
+
+	JobHandle handle;
+	handle.m_index = counterIndex;
+	handle.m_generation = m_counters[counterIndex].m_generation.load(std::memory_order_relaxed);
+
+	return handle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void JobSystem::ReleaseCounter(JobHandle handle)
+{
+	JobCounter_T& counter = m_counters[handle.m_index];
+
+	//Only the first waiter to bump the generation gets to recycle the index
+	uint expectedGeneration = handle.m_generation;
+	if (counter.m_generation.compare_exchange_strong(expectedGeneration, expectedGeneration + 1, std::memory_order_acq_rel))
+	{
+		m_freeCounters.Enqueue(handle.m_index);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void JobSystem::GenericThreadWork(int workerIndex)
+{
+	tWorkerIndex = workerIndex;
+
 	//This is the work the generic thread needs to do
 	JobSystem* system = JobSystem::GetInstance();
-	while (system->m_isRunning)
+
+	int spinLimit = JOB_WORKER_MIN_SPINS;
+	int spinCount = 0;
+
+	while (system->m_isRunning.load(std::memory_order_acquire))
 	{
-		system->WaitForWork();
-		while (system->ProcessCategoryForTimeInMS(JOB_GENERIC, 5));
+		if (system->ProcessCategory(JOB_GENERIC))
+		{
+			//Spinning paid off, be willing to spin a little longer next time
+			if (spinCount > 0 && spinLimit < JOB_WORKER_MAX_SPINS)
+			{
+				spinLimit *= 2;
+			}
+
+			spinCount = 0;
+			continue;
+		}
 
 		system->ProcessFinishJobsForCategory(JOB_GENERIC);
-		Sleep(0);
+
+		if (spinCount < spinLimit)
+		{
+			++spinCount;
+			std::this_thread::yield();
+			continue;
+		}
+
+		//Spun the whole limit for nothing, spin less next time and go to sleep
+		if (spinLimit > JOB_WORKER_MIN_SPINS)
+		{
+			spinLimit /= 2;
+		}
+		spinCount = 0;
+
+		uint parkTicket = system->m_workerParker.PrepareToPark();
+		if (!system->m_isRunning.load(std::memory_order_acquire) || system->HasPendingGenericJobs())
+		{
+			system->m_workerParker.CancelPark();
+			continue;
+		}
+
+		system->m_workerParker.Park(parkTicket);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool JobSystem::HasPendingGenericJobs() const
+{
+	if (m_categories[JOB_GENERIC].GetNumPendingJobs() > 0)
+	{
+		return true;
+	}
+
+	for (int queueIndex = 0; queueIndex < (int)m_workerQueues.size(); queueIndex++)
+	{
+		if (m_workerQueues[queueIndex]->GetLength() > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define JOBTEST_JOBS_PER_THREAD 200'000
+#define JOBTEST_BURST_SIZE 64
+
+//Tiny bit of work per job so the benchmark measures the queues and not the jobs
+static uint64_t DoBenchmarkJobWork(uint jobValue)
+{
+	uint64_t hash = jobValue;
+	for (int iteration = 0; iteration < 16; ++iteration)
+	{
+		hash = hash * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+
+	return hash >> 32;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Every thread spawns bursts of jobs and then drains whatever it can find, the same pattern our generation bursts follow
+static void SharedQueueBenchmarkThread(AsyncQueue<uint>& queue, std::atomic<uint>& executedCount, uint totalJobs)
+{
+	uint produced = 0;
+	uint64_t checksum = 0;
+
+	while (executedCount.load(std::memory_order_relaxed) < totalJobs)
+	{
+		for (uint burstIndex = 0; burstIndex < JOBTEST_BURST_SIZE && produced < JOBTEST_JOBS_PER_THREAD; ++burstIndex)
+		{
+			queue.EnqueueLocked(produced++);
+		}
+
+		uint executed = 0;
+		uint jobValue = 0;
+		while (queue.DequeueLocked(&jobValue))
+		{
+			checksum += DoBenchmarkJobWork(jobValue);
+			++executed;
+		}
+
+		executedCount += executed;
 	}
+
+	UNUSED(checksum);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
+static void WorkStealingBenchmarkThread(std::vector<WorkStealingQueue<uint>*>& queues, int threadIndex, std::atomic<uint>& executedCount, uint totalJobs)
+{
+	WorkStealingQueue<uint>* ownQueue = queues[threadIndex];
+	int numQueues = (int)queues.size();
+
+	uint produced = 0;
+	uint64_t checksum = 0;
+
+	while (executedCount.load(std::memory_order_relaxed) < totalJobs)
+	{
+		for (uint burstIndex = 0; burstIndex < JOBTEST_BURST_SIZE && produced < JOBTEST_JOBS_PER_THREAD; ++burstIndex)
+		{
+			ownQueue->Push(produced++);
+		}
+
+		uint executed = 0;
+		uint jobValue = 0;
+		bool foundWork = true;
+		while (foundWork)
+		{
+			foundWork = ownQueue->Pop(&jobValue);
+			for (int offset = 1; !foundWork && offset < numQueues; ++offset)
+			{
+				foundWork = queues[(threadIndex + offset) % numQueues]->Steal(&jobValue);
+			}
+
+			if (foundWork)
+			{
+				checksum += DoBenchmarkJobWork(jobValue);
+				++executed;
+			}
+		}
+
+		executedCount += executed;
+	}
+
+	UNUSED(checksum);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double RunSharedQueueBenchmark(uint threadCount, uint& outExecuted)
+{
+	AsyncQueue<uint> queue;
+	std::atomic<uint> executedCount = 0U;
+	uint totalJobs = threadCount * JOBTEST_JOBS_PER_THREAD;
+
+	double startTime = GetCurrentTimeSeconds();
+
+	std::vector<std::thread> threads;
+	for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+	{
+		threads.emplace_back(SharedQueueBenchmarkThread, std::ref(queue), std::ref(executedCount), totalJobs);
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	double elapsed = GetCurrentTimeSeconds() - startTime;
+	outExecuted = executedCount.load();
+
+	return (double)outExecuted / elapsed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static double RunWorkStealingBenchmark(uint threadCount, uint& outExecuted)
+{
+	std::vector<WorkStealingQueue<uint>*> queues;
+	for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+	{
+		queues.push_back(new WorkStealingQueue<uint>(WORKER_QUEUE_CAPACITY));
+	}
+
+	std::atomic<uint> executedCount = 0U;
+	uint totalJobs = threadCount * JOBTEST_JOBS_PER_THREAD;
+
+	double startTime = GetCurrentTimeSeconds();
+
+	std::vector<std::thread> threads;
+	for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+	{
+		threads.emplace_back(WorkStealingBenchmarkThread, std::ref(queues), (int)threadIndex, std::ref(executedCount), totalJobs);
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	double elapsed = GetCurrentTimeSeconds() - startTime;
+	outExecuted = executedCount.load();
+
+	for (WorkStealingQueue<uint>* queue : queues)
+	{
+		delete queue;
+	}
+
+	return (double)outExecuted / elapsed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Compares jobs/sec of the old single mutex queue against per worker deques with stealing at 1 to N threads
+UNITTEST("JobQueueContention", "JobSystem", 200)
+{
+	uint coreCount = std::thread::hardware_concurrency();
+	bool allJobsRan = true;
+
+	uint threadCount = 1;
+	while (threadCount <= coreCount)
+	{
+		uint sharedExecuted = 0;
+		uint stealingExecuted = 0;
+
+		double sharedJobsPerSecond = RunSharedQueueBenchmark(threadCount, sharedExecuted);
+		double stealingJobsPerSecond = RunWorkStealingBenchmark(threadCount, stealingExecuted);
+
+		DebuggerPrintf("\n Job contention %u threads: shared queue %.0f jobs/s, work stealing %.0f jobs/s (%.2fx)", threadCount, sharedJobsPerSecond, stealingJobsPerSecond, stealingJobsPerSecond / sharedJobsPerSecond);
+
+		uint totalJobs = threadCount * JOBTEST_JOBS_PER_THREAD;
+		allJobsRan = allJobsRan && (sharedExecuted == totalJobs) && (stealingExecuted == totalJobs);
+
+		//Always finish on the full core count even when it isn't a power of 2
+		if (threadCount < coreCount && threadCount * 2 > coreCount)
+		{
+			threadCount = coreCount;
+		}
+		else
+		{
+			threadCount *= 2;
+		}
+	}
+
+	return allJobsRan;
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------------
+#define JOBTEST_OVERHEAD_JOB_COUNT 100'000
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Empty job made the old way, one heap allocation per job and deleted by FinishJob
+class OverheadBenchmarkJob : public Job
+{
+public:
+	explicit OverheadBenchmarkJob(std::atomic<uint>* remaining) { m_remaining = remaining; }
+	void					Execute() { m_remaining->fetch_sub(1, std::memory_order_release); }
+
+private:
+	std::atomic<uint>*		m_remaining = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void OverheadBenchmarkFunction(void* data)
+{
+	std::atomic<uint>* executedCount = (std::atomic<uint>*)data;
+	executedCount->fetch_add(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Cost of spawning and completing a tiny job with heap allocated Job subclasses vs pooled jobs waited on with a handle
+UNITTEST("JobOverhead", "JobSystem", 200)
+{
+	JobSystem* jobSystem = JobSystem::GetInstance();
+
+	//Heap allocated jobs, completion tracked by hand
+	std::atomic<uint> remaining = JOBTEST_OVERHEAD_JOB_COUNT;
+	double startTime = GetCurrentTimeSeconds();
+	for (uint jobIndex = 0; jobIndex < JOBTEST_OVERHEAD_JOB_COUNT; ++jobIndex)
+	{
+		jobSystem->Run(new OverheadBenchmarkJob(&remaining));
+	}
+
+	while (remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (!jobSystem->ProcessCategory(JOB_GENERIC))
+		{
+			std::this_thread::yield();
+		}
+	}
+	double heapJobTime = GetCurrentTimeSeconds() - startTime;
+
+	//Pooled jobs sharing one handle
+	std::atomic<uint> executedCount = 0U;
+	startTime = GetCurrentTimeSeconds();
+
+	JobHandle handle;
+	for (uint jobIndex = 0; jobIndex < JOBTEST_OVERHEAD_JOB_COUNT; ++jobIndex)
+	{
+		handle = jobSystem->RunJob(OverheadBenchmarkFunction, &executedCount, handle);
+	}
+	jobSystem->WaitFor(handle);
+
+	double pooledJobTime = GetCurrentTimeSeconds() - startTime;
+
+	double heapNsPerJob = (heapJobTime * 1'000'000'000.0) / JOBTEST_OVERHEAD_JOB_COUNT;
+	double pooledNsPerJob = (pooledJobTime * 1'000'000'000.0) / JOBTEST_OVERHEAD_JOB_COUNT;
+	DebuggerPrintf("\n Job overhead over %d jobs: heap jobs %.1f ns/job, pooled jobs %.1f ns/job (%.2fx)", JOBTEST_OVERHEAD_JOB_COUNT, heapNsPerJob, pooledNsPerJob, heapNsPerJob / pooledNsPerJob);
+
+	CONFIRM(executedCount.load() == JOBTEST_OVERHEAD_JOB_COUNT);
+	return jobSystem->IsDone(handle);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+#define JOBTEST_WAKE_TRIALS 200
+#define JOBTEST_IDLE_MEASURE_SECONDS 0.5
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct WakeLatencyProbe_T
+{
+	std::atomic<double>		m_startedTime = 0.0;
+	std::atomic<bool>		m_hasRun = false;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void WakeLatencyFunction(void* data)
+{
+	WakeLatencyProbe_T* probe = (WakeLatencyProbe_T*)data;
+	probe->m_startedTime = GetCurrentTimeSeconds();
+	probe->m_hasRun.store(true, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Time from pushing a job to a parked worker starting it, and how much CPU the workers burn while there is no work
+UNITTEST("WorkerWakeLatency", "JobSystem", 200)
+{
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	if (jobSystem->GetNumGenericThreads() == 0)
+	{
+		return true;
+	}
+
+	//Let every worker spin down and park
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	double totalLatency = 0.0;
+	double worstLatency = 0.0;
+	for (int trialIndex = 0; trialIndex < JOBTEST_WAKE_TRIALS; ++trialIndex)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+		WakeLatencyProbe_T probe;
+		double pushTime = GetCurrentTimeSeconds();
+		JobHandle handle = jobSystem->RunJob(WakeLatencyFunction, &probe);
+
+		//Don't help here or we would just be timing ourselves
+		while (!probe.m_hasRun.load(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+		jobSystem->WaitFor(handle);
+
+		double latency = probe.m_startedTime - pushTime;
+		totalLatency += latency;
+		worstLatency = (latency > worstLatency) ? latency : worstLatency;
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	double cpuStart = GetProcessCPUTimeSeconds();
+	double wallStart = GetCurrentTimeSeconds();
+	std::this_thread::sleep_for(std::chrono::milliseconds((int)(JOBTEST_IDLE_MEASURE_SECONDS * 1000.0)));
+	double cpuUsed = GetProcessCPUTimeSeconds() - cpuStart;
+	double wallElapsed = GetCurrentTimeSeconds() - wallStart;
+
+	double averageLatencyUs = (totalLatency / JOBTEST_WAKE_TRIALS) * 1'000'000.0;
+	double idleCorePercent = (cpuUsed / wallElapsed) * 100.0;
+	DebuggerPrintf("\n Worker wake latency: avg %.1f us, worst %.1f us. Idle CPU with %d workers: %.2f%% of a core", averageLatencyUs, worstLatency * 1'000'000.0, jobSystem->GetNumGenericThreads(), idleCorePercent);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+class DeadlineTestJob : public Job
+{
+public:
+	explicit DeadlineTestJob(std::atomic<int>* executedCount) { m_executedCount = executedCount; }
+	void				Execute() { m_executedCount->fetch_add(1); }
+
+private:
+	std::atomic<int>*	m_executedCount = nullptr;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// A job estimated to take longer than the time left must be left in the queue rather than started, and shorter jobs queued
+// behind it should still get to use the time
+UNITTEST("JobDeadlineSkip", "JobSystem", 100)
+{
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	std::atomic<int> executedCount = 0;
+
+	DeadlineTestJob* longJob = new DeadlineTestJob(&executedCount);
+	longJob->SetJobCategory(JOB_MAIN);
+	longJob->SetEstimatedCostMS(10'000.f);
+	jobSystem->Run(longJob);
+
+	for (int jobIndex = 0; jobIndex < 3; ++jobIndex)
+	{
+		DeadlineTestJob* shortJob = new DeadlineTestJob(&executedCount);
+		shortJob->SetJobCategory(JOB_MAIN);
+		jobSystem->Run(shortJob);
+	}
+
+	bool hasMoreJobs = jobSystem->ProcessCategoryForTimeInMS(JOB_MAIN, 50);
+	CONFIRM(hasMoreJobs && executedCount.load() == 3);
+	JobPriorityStats_T mainStats;
+	jobSystem->GetPriorityStats(JOB_MAIN, JOB_PRIORITY_NORMAL, &mainStats);
+	CONFIRM(mainStats.m_pendingJobs == 1);
+
+	//Plenty of time now so it should run and leave the category empty
+	hasMoreJobs = jobSystem->ProcessCategoryUntilDeadline(JOB_MAIN, GetCurrentTimeSeconds() + 60.0);
+	return !hasMoreJobs && executedCount.load() == 4;
+}
\ No newline at end of file
@@ -1,16 +1,43 @@
 #pragma once
 #include "Engine/Core/JobSystem/JobTypes.hpp"
-#include "Engine/Core/Async/Semaphores.hpp"
+#include "Engine/Core/Async/ThreadParker.hpp"
 #include "Engine/Core/JobSystem/JobCategory.hpp"
+#include "Engine/Core/Async/WorkStealingQueue.hpp"
+#include "Engine/Core/Async/MPMCAsyncQueue.hpp"
+#include "Engine/Allocators/BlockAllocator.hpp"
 #include <vector>
 #include <thread>
 
 typedef unsigned int uint;
 class Job;
 
+//------------------------------------------------------------------------------------------------------------------------------
+// Number of jobs a generic worker can hold in its own deque before new work spills into the shared category queue
+constexpr size_t WORKER_QUEUE_CAPACITY = 4096;
+
+//Number of job handles that can be in flight at once, a handle is in flight from RunJob until it has been waited on
+constexpr uint JOB_MAX_COUNTERS = 4096;
+
+//Pooled jobs are carved out of chunks of this many blocks
+constexpr uint JOB_POOL_BLOCKS_PER_CHUNK = 1024;
+
+//Idle workers yield this many times looking for work before parking. The limit adapts per worker between these bounds,
+//growing when spinning finds work and shrinking when it doesn't
+constexpr int JOB_WORKER_MIN_SPINS = 32;
+constexpr int JOB_WORKER_MAX_SPINS = 2048;
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct JobCounter_T
+{
+	std::atomic<int>	m_pendingJobs = 0;
+	std::atomic<uint>	m_generation = 0U;
+};
+
 //------------------------------------------------------------------------------------------------------------------------------
 class JobSystem
 {
+	friend class PooledJob;
+
 public:
 
 	static JobSystem*	CreateInstance();
@@ -26,24 +53,67 @@ public:
 
 	bool				ProcessCategoryForTimeInMS(int category, uint ms); // process until no more jobs, or until 'ms' has passed 
 	bool				ProcessCategory(int category); // process until no more jobs, return number of jobs executed
+
+	// process until no more jobs or until GetCurrentTimeSeconds() reaches deadlineSeconds. Jobs with an estimated cost
+	// longer than the time left are put back for later instead of being started, shorter ones behind them still run.
+	// Returns false once the category is empty
+	bool				ProcessCategoryUntilDeadline(int category, double deadlineSeconds);
 	
 	void				ProcessFinishJobsForCategory(int category);
 
 	void				AddJobForCategory(Job* job, int category);
 	void				AddFinishedJobForCategory(Job* job, int category);
 
+	int					GetNumGenericThreads() const	{ return (int)m_genericThreads.size(); }
+
+	//Generic NORMAL pending jobs include the ones sitting in the workers' own deques
+	void				GetPriorityStats(int category, eJobPriority priority, JobPriorityStats_T* outStats) const;
+	void				ResetPriorityStats();
+
+	//Runs function(data) as a pooled generic job. Jobs share a counter when an existing handle is passed in, otherwise a new
+	//one is made. Every handle returned here has to be passed to WaitFor once so the counter is released
+	JobHandle			RunJob(JobFunction function, void* data, JobHandle counter = JobHandle(), eJobPriority priority = JOB_PRIORITY_NORMAL);
+
+	//Runs other pending generic jobs until every job on the handle's counter is done, then releases the counter
+	void				WaitFor(JobHandle handle);
+	bool				IsDone(JobHandle handle) const;
+
+	void				DecrementCounter(JobHandle handle);
+
 private:
-	static void			GenericThreadWork();
+	static void			GenericThreadWork(int workerIndex);
+
+	Job*				TryGetJob(int category);
+	void				ExecuteJob(Job* job, int category);
 
-	Semaphore			m_genericJobsSemaphore;
+	//Generic jobs are taken in priority order. The worker deques only ever hold NORMAL jobs so the order is
+	//shared HIGH, our own deque, shared NORMAL, stolen from other workers and finally shared LOW
+	Job*				TryGetGenericJob();
+	Job*				TryStealGenericJob();
 
-	void				WaitForWork()	{ m_genericJobsSemaphore.Acquire(); }
-	void				SignalWork()	{ m_genericJobsSemaphore.Release(1); }
+	JobHandle			CreateCounter();
+	void				ReleaseCounter(JobHandle handle);
+
+	//Checked right before a worker parks so work pushed while it was spinning down isn't slept through
+	bool				HasPendingGenericJobs() const;
+
+	ThreadParker		m_workerParker;
 
 	JobCategory*				m_categories;
 	int							m_numCategories = JOB_CATEGORY_CORE_COUNT;
 
 	std::vector<std::thread>	m_genericThreads;
 
-	bool m_isRunning;
+	//One deque per generic worker, indexed by the worker index
+	std::vector<WorkStealingQueue<Job*>*>	m_workerQueues;
+	std::atomic<uint>						m_stealSeed = 0U;
+
+	//Handles index into this table, free indices are recycled through the queue
+	JobCounter_T							m_counters[JOB_MAX_COUNTERS];
+	MPMCAsyncQueue<uint>					m_freeCounters{ JOB_MAX_COUNTERS };
+
+	//Backing storage for jobs made by RunJob
+	BlockAllocator							m_jobPool;
+
+	std::atomic<bool>	m_isRunning = false;
 };
\ No newline at end of file
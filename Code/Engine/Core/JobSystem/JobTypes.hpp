@@ -8,4 +8,33 @@ enum eJobCategory : int
 	JOB_RENDER,
 
 	JOB_CATEGORY_CORE_COUNT,
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Jobs are always picked up in priority order inside a category. Use LOW for streaming and background work that can wait
+enum eJobPriority : int
+{
+	JOB_PRIORITY_HIGH = 0,
+	JOB_PRIORITY_NORMAL,
+	JOB_PRIORITY_LOW,
+
+	JOB_PRIORITY_COUNT,
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Function run by a pooled job, data is owned by the caller and must stay alive until the job's handle has been waited on
+typedef void(*JobFunction)(void* data);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Lightweight reference to a completion counter in the JobSystem. The generation lets a stale handle be detected after the
+// counter has been released and reused by someone else
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr unsigned int INVALID_JOB_HANDLE_INDEX = 0xFFFFFFFF;
+
+struct JobHandle
+{
+	unsigned int	m_index = INVALID_JOB_HANDLE_INDEX;
+	unsigned int	m_generation = 0U;
+
+	bool			IsValid() const		{ return m_index != INVALID_JOB_HANDLE_INDEX; }
 };
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "Engine/Core/JobSystem/ParallelFor.hpp"
+#include "Engine/Core/JobSystem/Job.hpp"
+#include "Engine/Core/JobSystem/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include <climits>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------------------
+//Chunks handed out per worker when the caller lets us pick the grain size, more than 1 so uneven chunks can balance out
+constexpr int PARALLEL_CHUNKS_PER_WORKER = 4;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void ProcessParallelChunks(ParallelRange_T& range)
+{
+	int chunkIndex = range.nextChunk.fetch_add(1, std::memory_order_relaxed);
+	while (chunkIndex < range.numChunks)
+	{
+		//Done in 64 bits, chunkIndex * grainSize can be past INT_MAX for a range that ends near it
+		int64_t chunkBegin = (int64_t)range.begin + (int64_t)chunkIndex * (int64_t)range.grainSize;
+		int64_t chunkEnd = ((int64_t)range.end - chunkBegin > (int64_t)range.grainSize) ? chunkBegin + range.grainSize : (int64_t)range.end;
+
+		range.chunkCallback(range.context, chunkIndex, (int)chunkBegin, (int)chunkEnd);
+
+		chunkIndex = range.nextChunk.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Helper job, one of these is run per worker and not per chunk
+static void ParallelChunksJob(void* data)
+{
+	ProcessParallelChunks(*(ParallelRange_T*)data);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int ComputeParallelGrainSize(int begin, int end, int grainSize)
+{
+	if (grainSize > 0)
+	{
+		return grainSize;
+	}
+
+	int numWorkers = JobSystem::GetInstance()->GetNumGenericThreads() + 1;
+	int64_t autoGrainSize = ((int64_t)end - (int64_t)begin) / (numWorkers * PARALLEL_CHUNKS_PER_WORKER);
+
+	return (autoGrainSize > 0) ? (int)autoGrainSize : 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+int ComputeParallelNumChunks(int begin, int end, int grainSize)
+{
+	return (int)(((int64_t)end - (int64_t)begin + grainSize - 1) / grainSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void RunParallelRange(ParallelRange_T& range)
+{
+	ASSERT_OR_DIE(range.grainSize > 0, "Parallel range needs a grain size of at least 1");
+	ASSERT_OR_DIE(range.chunkCallback != nullptr, "Parallel range has no chunk callback");
+
+	range.numChunks = ComputeParallelNumChunks(range.begin, range.end, range.grainSize);
+	range.nextChunk = 0;
+
+	JobSystem* jobSystem = JobSystem::GetInstance();
+
+	//The caller takes a share of the chunks itself so we only need helpers for the rest
+	int numHelpers = jobSystem->GetNumGenericThreads();
+	if (numHelpers > range.numChunks - 1)
+	{
+		numHelpers = range.numChunks - 1;
+	}
+
+	JobHandle helpers;
+	for (int helperIndex = 0; helperIndex < numHelpers; ++helperIndex)
+	{
+		helpers = jobSystem->RunJob(ParallelChunksJob, &range, helpers);
+	}
+
+	ProcessParallelChunks(range);
+
+	//Our helpers may still be queued behind other work, WaitFor runs generic jobs instead of blocking on them.
+	//The range lives on our stack so we can't return until every helper is done with it
+	jobSystem->WaitFor(helpers);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define PARALLELTEST_NUM_ELEMENTS 1'000'000
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ParallelFor", "JobSystem", 100)
+{
+	std::vector<std::atomic<uint>> visitCounts(PARALLELTEST_NUM_ELEMENTS);
+
+	//Odd grain size so the last chunk is a partial one
+	ParallelFor(0, PARALLELTEST_NUM_ELEMENTS, 1023, [&](int index)
+	{
+		visitCounts[index]++;
+	});
+
+	for (int index = 0; index < PARALLELTEST_NUM_ELEMENTS; ++index)
+	{
+		CONFIRM(visitCounts[index].load() == 1);
+	}
+
+	//Auto grain size and a range that does not start at 0
+	ParallelFor(10, 20, 0, [&](int index)
+	{
+		visitCounts[index]++;
+	});
+
+	for (int index = 10; index < 20; ++index)
+	{
+		CONFIRM(visitCounts[index].load() == 2);
+	}
+
+	//Empty range should not call anything
+	bool wasCalled = false;
+	ParallelFor(5, 5, 1, [&](int) { wasCalled = true; });
+	CONFIRM(!wasCalled);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+UNITTEST("ParallelReduce", "JobSystem", 100)
+{
+	uint64_t expectedSum = ((uint64_t)PARALLELTEST_NUM_ELEMENTS * (PARALLELTEST_NUM_ELEMENTS - 1)) / 2;
+
+	double startTime = GetCurrentTimeSeconds();
+	uint64_t sum = ParallelReduce(0, PARALLELTEST_NUM_ELEMENTS, 0, (uint64_t)0,
+		[](int chunkBegin, int chunkEnd, uint64_t partial)
+		{
+			for (int index = chunkBegin; index < chunkEnd; ++index)
+			{
+				partial += (uint64_t)index;
+			}
+			return partial;
+		},
+		[](uint64_t a, uint64_t b) { return a + b; });
+	double endTime = GetCurrentTimeSeconds();
+
+	DebuggerPrintf("\n ParallelReduce over %d elements took %f ms", PARALLELTEST_NUM_ELEMENTS, (endTime - startTime) * 1000.0);
+	CONFIRM(sum == expectedSum);
+
+	//Non commutative reduce to make sure partials are combined in order
+	uint64_t digits = ParallelReduce(1, 10, 1, (uint64_t)0,
+		[](int chunkBegin, int chunkEnd, uint64_t partial)
+		{
+			for (int index = chunkBegin; index < chunkEnd; ++index)
+			{
+				partial = partial * 10 + (uint64_t)index;
+			}
+			return partial;
+		},
+		[](uint64_t a, uint64_t b) { return a * 10 + b; });
+	CONFIRM(digits == 123456789ULL);
+
+	//bool partials are written from different chunks at once and must not be packed into shared words
+	bool allEven = ParallelReduce(0, 4096, 1, true,
+		[](int chunkBegin, int chunkEnd, bool partial)
+		{
+			for (int index = chunkBegin; index < chunkEnd; ++index)
+			{
+				partial = partial && ((index * 2) % 2 == 0);
+			}
+			return partial;
+		},
+		[](bool a, bool b) { return a && b; });
+	CONFIRM(allEven);
+
+	//Almost the whole int range, chunk offsets past INT_MAX must not wrap
+	int64_t numIndices = ParallelReduce(INT_MIN + 1, INT_MAX, 1 << 28, (int64_t)0,
+		[](int chunkBegin, int chunkEnd, int64_t partial)
+		{
+			return partial + ((int64_t)chunkEnd - (int64_t)chunkBegin);
+		},
+		[](int64_t a, int64_t b) { return a + b; });
+
+	return numIndices == (int64_t)INT_MAX - (int64_t)(INT_MIN + 1);
+}
\ No newline at end of file
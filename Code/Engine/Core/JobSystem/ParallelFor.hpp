@@ -0,0 +1,114 @@
+#pragma once
+#include "Engine/Commons/EngineCommon.hpp"
+#include <atomic>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: ParallelFor and ParallelReduce split [begin, end) into chunks of grainSize indices and run them on the generic
+// workers. Only one helper job per worker is created for the whole range, each helper keeps grabbing the next chunk from a
+// shared counter until the range is exhausted. The calling thread also grabs chunks and then helps run generic jobs until
+// every helper has finished, so both calls are blocking and safe to use from the main thread or from inside a job.
+// A grainSize of 0 or less lets the system pick one based on the number of workers.
+//------------------------------------------------------------------------------------------------------------------------------
+typedef void(*ParallelChunkCallback)(void* context, int chunkIndex, int chunkBegin, int chunkEnd);
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct ParallelRange_T
+{
+	int						begin = 0;
+	int						end = 0;
+	int						grainSize = 1;
+	int						numChunks = 0;
+
+	ParallelChunkCallback	chunkCallback = nullptr;
+	void*					context = nullptr;
+
+	std::atomic<int>		nextChunk = 0;
+};
+
+int		ComputeParallelGrainSize(int begin, int end, int grainSize);
+int		ComputeParallelNumChunks(int begin, int end, int grainSize);
+void	RunParallelRange(ParallelRange_T& range);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// fn is called once per index as fn(int index)
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename FUNC>
+void ParallelFor(int begin, int end, int grainSize, FUNC const& fn)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+
+	ParallelRange_T range;
+	range.begin = begin;
+	range.end = end;
+	range.grainSize = ComputeParallelGrainSize(begin, end, grainSize);
+	range.context = (void*)&fn;
+	range.chunkCallback = [](void* context, int chunkIndex, int chunkBegin, int chunkEnd)
+	{
+		UNUSED(chunkIndex);
+
+		FUNC const& function = *(FUNC const*)context;
+		for (int index = chunkBegin; index < chunkEnd; ++index)
+		{
+			function(index);
+		}
+	};
+
+	RunParallelRange(range);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// rangeFn reduces a whole chunk as rangeFn(int chunkBegin, int chunkEnd, TYPE identity) -> TYPE
+// reduceFn combines two partial results as reduceFn(TYPE a, TYPE b) -> TYPE
+// Partials are combined on the calling thread in chunk order so the result is the same every run
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename TYPE, typename RANGE_FUNC, typename REDUCE_FUNC>
+TYPE ParallelReduce(int begin, int end, int grainSize, TYPE const& identity, RANGE_FUNC const& rangeFn, REDUCE_FUNC const& reduceFn)
+{
+	if (end <= begin)
+	{
+		return identity;
+	}
+
+	//Each partial gets its own cache line. Chunks write them from different threads so they must not share a word
+	//(std::vector<bool> packs bits) or a line with each other
+	struct alignas(64) ReducePartial_T
+	{
+		TYPE						value;
+	};
+
+	struct ReduceContext_T
+	{
+		RANGE_FUNC const*				rangeFunction;
+		TYPE const*						identity;
+		std::vector<ReducePartial_T>	partials;
+	};
+
+	ParallelRange_T range;
+	range.begin = begin;
+	range.end = end;
+	range.grainSize = ComputeParallelGrainSize(begin, end, grainSize);
+
+	int numChunks = ComputeParallelNumChunks(begin, end, range.grainSize);
+
+	ReduceContext_T reduceContext{ &rangeFn, &identity, std::vector<ReducePartial_T>(numChunks, ReducePartial_T{ identity }) };
+	range.context = &reduceContext;
+	range.chunkCallback = [](void* context, int chunkIndex, int chunkBegin, int chunkEnd)
+	{
+		ReduceContext_T* reduce = (ReduceContext_T*)context;
+		reduce->partials[chunkIndex].value = (*reduce->rangeFunction)(chunkBegin, chunkEnd, *reduce->identity);
+	};
+
+	RunParallelRange(range);
+
+	TYPE result = identity;
+	for (int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+	{
+		result = reduceFn(result, reduceContext.partials[chunkIndex].value);
+	}
+
+	return result;
+}
\ No newline at end of file
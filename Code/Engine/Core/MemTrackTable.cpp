@@ -0,0 +1,621 @@
+#include "Engine/Core/MemTrackTable.hpp"
+#include "Engine/Allocators/TemplatedPoolAllocator.hpp"
+#include "Engine/Commons/EngineCommon.hpp"
+#include "Engine/Commons/UnitTest.hpp"
+#include "Engine/Core/MemTracking.hpp"
+#include "Engine/Core/Time.hpp"
+#include <map>
+#include <math.h>
+#include <new>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------
+uint CallstackTable::Intern(void* const* trace, uint depth, unsigned long hash)
+{
+	uint64_t key = (uint64_t)hash + 1;
+	uint mask = CALLSTACK_TABLE_CAPACITY - 1;
+	uint slotIndex = (uint)(hash * 2654435761u) & mask;
+
+	for (uint probeCount = 0; probeCount < CALLSTACK_TABLE_CAPACITY; ++probeCount)
+	{
+		Entry_T& entry = m_entries[slotIndex];
+		uint64_t existingKey = entry.m_key.load(std::memory_order_acquire);
+
+		if (existingKey == 0)
+		{
+			if (entry.m_key.compare_exchange_strong(existingKey, key, std::memory_order_acq_rel))
+			{
+				//We own this slot now, publish a copy of the trace
+				Callstack* callstack = new (UntrackedAlloc(sizeof(Callstack))) Callstack();
+				callstack->m_depth = (depth < MAX_TRACE) ? depth : MAX_TRACE;
+				callstack->m_hash = hash;
+				memcpy(callstack->m_trace, trace, callstack->m_depth * sizeof(void*));
+
+				entry.m_callstack.store(callstack, std::memory_order_release);
+				m_numCallstacks.fetch_add(1, std::memory_order_relaxed);
+				return slotIndex;
+			}
+
+			//Somebody claimed it first, existingKey now holds their key so look at it again below
+		}
+
+		if (existingKey == key)
+		{
+			//Owner may still be copying the trace
+			while (entry.m_callstack.load(std::memory_order_acquire) == nullptr)
+			{
+				std::this_thread::yield();
+			}
+
+			return slotIndex;
+		}
+
+		slotIndex = (slotIndex + 1) & mask;
+	}
+
+	return INVALID_CALLSTACK_ID;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool CallstackTable::GetCallstack(uint callstackId, Callstack* out) const
+{
+	if (callstackId >= CALLSTACK_TABLE_CAPACITY)
+	{
+		return false;
+	}
+
+	Callstack* callstack = m_entries[callstackId].m_callstack.load(std::memory_order_acquire);
+	if (callstack == nullptr)
+	{
+		return false;
+	}
+
+	*out = *callstack;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+MemTrackTable::~MemTrackTable()
+{
+	for (uint shardIndex = 0; shardIndex < MEM_TRACK_SHARD_COUNT; ++shardIndex)
+	{
+		//Empty shards bail out of Remove before touching the records
+		Shard_T& shard = m_shards[shardIndex];
+		UntrackedFree(shard.m_records);
+		shard.m_records = nullptr;
+		shard.m_capacity = 0;
+		shard.m_numRecords = 0;
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void MemTrackTable::Add(void* pointer, size_t byteSize, uint callstackId)
+{
+	uint64_t hash = HashPointer(pointer);
+	Shard_T& shard = m_shards[hash & (MEM_TRACK_SHARD_COUNT - 1)];
+
+	MemTrackRecord_T record;
+	record.m_pointer = pointer;
+	record.m_byteSize = byteSize;
+	record.m_callstackId = callstackId;
+
+	std::scoped_lock lock(shard.m_lock);
+
+	if ((shard.m_numRecords + 1) * 4 > shard.m_capacity * 3)
+	{
+		GrowShard(shard);
+	}
+
+	InsertRecord(shard, record, hash);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool MemTrackTable::Remove(void* pointer, MemTrackRecord_T* outRecord)
+{
+	uint64_t hash = HashPointer(pointer);
+	Shard_T& shard = m_shards[hash & (MEM_TRACK_SHARD_COUNT - 1)];
+
+	std::scoped_lock lock(shard.m_lock);
+
+	if (shard.m_numRecords == 0)
+	{
+		return false;
+	}
+
+	uint mask = shard.m_capacity - 1;
+	uint slotIndex = (uint)(hash >> 32) & mask;
+	while (shard.m_records[slotIndex].m_pointer != pointer)
+	{
+		if (shard.m_records[slotIndex].m_pointer == nullptr)
+		{
+			return false;
+		}
+
+		slotIndex = (slotIndex + 1) & mask;
+	}
+
+	*outRecord = shard.m_records[slotIndex];
+
+	//Backward shift: pull later records of the same run into the hole so lookups never need tombstones
+	uint holeIndex = slotIndex;
+	uint nextIndex = slotIndex;
+	while (true)
+	{
+		nextIndex = (nextIndex + 1) & mask;
+		MemTrackRecord_T& next = shard.m_records[nextIndex];
+		if (next.m_pointer == nullptr)
+		{
+			break;
+		}
+
+		//Only move it if its home slot is at or before the hole (cyclically)
+		uint homeIndex = (uint)(HashPointer(next.m_pointer) >> 32) & mask;
+		uint distanceToHole = (holeIndex - homeIndex) & mask;
+		uint distanceToNext = (nextIndex - homeIndex) & mask;
+		if (distanceToHole < distanceToNext)
+		{
+			shard.m_records[holeIndex] = next;
+			holeIndex = nextIndex;
+		}
+	}
+
+	shard.m_records[holeIndex] = MemTrackRecord_T();
+	shard.m_numRecords--;
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t MemTrackTable::GetNumRecords() const
+{
+	size_t numRecords = 0;
+	for (uint shardIndex = 0; shardIndex < MEM_TRACK_SHARD_COUNT; ++shardIndex)
+	{
+		numRecords += m_shards[shardIndex].m_numRecords;
+	}
+
+	return numRecords;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint64_t MemTrackTable::HashPointer(void* pointer)
+{
+	//Allocations are at least 8 byte aligned so the low bits carry nothing, mix the rest (MurmurHash3 finalizer)
+	uint64_t hash = (uint64_t)(uintptr_t)pointer >> 3;
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	//Low bits pick the shard, high bits pick the slot inside it
+	return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void MemTrackTable::InsertRecord(Shard_T& shard, MemTrackRecord_T const& record, uint64_t hash)
+{
+	uint mask = shard.m_capacity - 1;
+	uint slotIndex = (uint)(hash >> 32) & mask;
+
+	while (shard.m_records[slotIndex].m_pointer != nullptr)
+	{
+		if (shard.m_records[slotIndex].m_pointer == record.m_pointer)
+		{
+			//Address got reused without us seeing the free, the new record wins
+			shard.m_records[slotIndex] = record;
+			return;
+		}
+
+		slotIndex = (slotIndex + 1) & mask;
+	}
+
+	shard.m_records[slotIndex] = record;
+	shard.m_numRecords++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC void MemTrackTable::GrowShard(Shard_T& shard)
+{
+	MemTrackRecord_T* oldRecords = shard.m_records;
+	uint oldCapacity = shard.m_capacity;
+
+	uint newCapacity = (oldCapacity == 0) ? MEM_TRACK_SHARD_INITIAL_CAPACITY : oldCapacity * 2;
+	MemTrackRecord_T* newRecords = (MemTrackRecord_T*)UntrackedAlloc(newCapacity * sizeof(MemTrackRecord_T));
+	ASSERT_OR_DIE(newRecords != nullptr, "MemTrackTable ran out of memory growing a shard");
+	for (uint recordIndex = 0; recordIndex < newCapacity; ++recordIndex)
+	{
+		new (&newRecords[recordIndex]) MemTrackRecord_T();
+	}
+
+	shard.m_records = newRecords;
+	shard.m_capacity = newCapacity;
+	shard.m_numRecords = 0;
+
+	for (uint recordIndex = 0; recordIndex < oldCapacity; ++recordIndex)
+	{
+		if (oldRecords[recordIndex].m_pointer != nullptr)
+		{
+			InsertRecord(shard, oldRecords[recordIndex], HashPointer(oldRecords[recordIndex].m_pointer));
+		}
+	}
+
+	UntrackedFree(oldRecords);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Sampler state is per thread so the common path is a subtract and a compare
+static thread_local uint64_t tBytesUntilSample = 0;
+static thread_local uint64_t tSamplerRandomState = 0;
+
+//------------------------------------------------------------------------------------------------------------------------------
+static uint64_t DrawBytesUntilSample(size_t sampleRateBytes)
+{
+	if (tSamplerRandomState == 0)
+	{
+		//Seed from this thread's own storage so threads don't sample in lockstep
+		tSamplerRandomState = ((uint64_t)(uintptr_t)&tSamplerRandomState * 0x9E3779B97F4A7C15ULL) | 1;
+	}
+
+	//xorshift64*
+	tSamplerRandomState ^= tSamplerRandomState >> 12;
+	tSamplerRandomState ^= tSamplerRandomState << 25;
+	tSamplerRandomState ^= tSamplerRandomState >> 27;
+	uint64_t random = tSamplerRandomState * 0x2545F4914F6CDD1DULL;
+
+	//Uniform in (0, 1] then turned into an exponential gap with the requested mean
+	double uniform = (double)((random >> 11) + 1) * (1.0 / 9007199254740992.0);
+	return (uint64_t)(-log(uniform) * (double)sampleRateBytes) + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool MemTrackShouldSample(size_t byteSize, size_t sampleRateBytes)
+{
+	if (tBytesUntilSample == 0)
+	{
+		tBytesUntilSample = DrawBytesUntilSample(sampleRateBytes);
+	}
+
+	if (byteSize < tBytesUntilSample)
+	{
+		tBytesUntilSample -= byteSize;
+		return false;
+	}
+
+	tBytesUntilSample = DrawBytesUntilSample(sampleRateBytes);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+size_t MemTrackGetSampleWeight(size_t byteSize, size_t sampleRateBytes)
+{
+	if (byteSize == 0)
+	{
+		return 0;
+	}
+
+	//Chance an allocation of this size had of being picked is 1 - e^(-size / rate)
+	double sampleChance = 1.0 - exp(-(double)byteSize / (double)sampleRateBytes);
+	return (size_t)((double)byteSize / sampleChance + 0.5);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SampledPointerFilter::Add(void* pointer)
+{
+	std::atomic<uint8_t>& counter = m_counters[GetCounterIndex(pointer)];
+
+	//Saturate instead of wrapping, a stuck counter only costs us a few extra lookups
+	uint8_t count = counter.load(std::memory_order_relaxed);
+	while (count < 255 && !counter.compare_exchange_weak(count, (uint8_t)(count + 1), std::memory_order_relaxed))
+	{
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void SampledPointerFilter::Remove(void* pointer)
+{
+	std::atomic<uint8_t>& counter = m_counters[GetCounterIndex(pointer)];
+
+	uint8_t count = counter.load(std::memory_order_relaxed);
+	while (count > 0 && count < 255 && !counter.compare_exchange_weak(count, (uint8_t)(count - 1), std::memory_order_relaxed))
+	{
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+bool SampledPointerFilter::MayContain(void* pointer) const
+{
+	return m_counters[GetCounterIndex(pointer)].load(std::memory_order_relaxed) != 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+STATIC uint SampledPointerFilter::GetCounterIndex(void* pointer)
+{
+	uint64_t hash = ((uint64_t)(uintptr_t)pointer >> 3) * 0x9E3779B97F4A7C15ULL;
+	return (uint)(hash >> 48) & (MEM_TRACK_SAMPLE_FILTER_SIZE - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// UNIT TEST
+//------------------------------------------------------------------------------------------------------------------------------
+#define MEMTABLETEST_THREADS 4
+#define MEMTABLETEST_ALLOCS_PER_THREAD 200'000
+#define MEMTABLETEST_LIVE_WINDOW 256
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Fake allocation addresses so the test doesn't depend on the real heap, each thread gets its own range
+static void* GetFakeAllocation(uint threadIndex, uint allocIndex)
+{
+	return (void*)(uintptr_t)(((uint64_t)(threadIndex + 1) << 40) + ((uint64_t)allocIndex << 4));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+static void MemTrackTableTestThread(MemTrackTable* table, CallstackTable* callstacks, uint threadIndex, std::atomic<bool>* failed)
+{
+	for (uint allocIndex = 0; allocIndex < MEMTABLETEST_ALLOCS_PER_THREAD; ++allocIndex)
+	{
+		//A handful of call sites shared by every thread
+		void* trace[2] = { (void*)(uintptr_t)(0x1000 + (allocIndex % 8)), (void*)(uintptr_t)0x2000 };
+		uint callstackId = callstacks->Intern(trace, 2, 0xABC0 + (allocIndex % 8));
+
+		table->Add(GetFakeAllocation(threadIndex, allocIndex), allocIndex + 1, callstackId);
+
+		if (allocIndex >= MEMTABLETEST_LIVE_WINDOW)
+		{
+			uint freeIndex = allocIndex - MEMTABLETEST_LIVE_WINDOW;
+			MemTrackRecord_T record;
+			if (!table->Remove(GetFakeAllocation(threadIndex, freeIndex), &record) || record.m_byteSize != freeIndex + 1)
+			{
+				failed->store(true);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Tracking from several threads at once keeps every record, and shared call sites collapse to one callstack each
+UNITTEST("MemTrackTable", "MemTracking", 100)
+{
+	MemTrackTable* table = new (UntrackedAlloc(sizeof(MemTrackTable))) MemTrackTable();
+	CallstackTable* callstacks = new (UntrackedAlloc(sizeof(CallstackTable))) CallstackTable();
+
+	std::atomic<bool> failed = false;
+	std::vector<std::thread> threads;
+	for (uint threadIndex = 0; threadIndex < MEMTABLETEST_THREADS; ++threadIndex)
+	{
+		threads.emplace_back(MemTrackTableTestThread, table, callstacks, threadIndex, &failed);
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	CONFIRM(!failed.load());
+	CONFIRM(table->GetNumRecords() == MEMTABLETEST_THREADS * MEMTABLETEST_LIVE_WINDOW);
+	CONFIRM(callstacks->GetNumCallstacks() == 8);
+
+	size_t liveBytes = 0;
+	bool allHaveCallstacks = true;
+	table->ForEach([&](MemTrackRecord_T const& record)
+	{
+		liveBytes += record.m_byteSize;
+		Callstack callstack;
+		allHaveCallstacks = allHaveCallstacks && callstacks->GetCallstack(record.m_callstackId, &callstack) && callstack.m_depth == 2;
+	});
+	CONFIRM(allHaveCallstacks);
+
+	//Each thread leaves its last window alive
+	size_t expectedBytes = 0;
+	for (uint allocIndex = MEMTABLETEST_ALLOCS_PER_THREAD - MEMTABLETEST_LIVE_WINDOW; allocIndex < MEMTABLETEST_ALLOCS_PER_THREAD; ++allocIndex)
+	{
+		expectedBytes += allocIndex + 1;
+	}
+	CONFIRM(liveBytes == expectedBytes * MEMTABLETEST_THREADS);
+
+	MemTrackRecord_T record;
+	CONFIRM(!table->Remove(GetFakeAllocation(0, 0), &record));
+
+	table->~MemTrackTable();
+	UntrackedFree(table);
+	UntrackedFree(callstacks);
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Same tracking pattern as above through the sharded table and through the old single lock std::map
+UNITTEST("MemTrackContention", "MemTracking", 200)
+{
+	typedef std::map<void*, MemTrackRecord_T, std::less<void*>, TemplatedPoolAllocator<std::pair<void* const, MemTrackRecord_T>>> SingleLockMap;
+
+	for (uint threadCount = 1; threadCount <= 8; threadCount *= 2)
+	{
+		MemTrackTable* table = new (UntrackedAlloc(sizeof(MemTrackTable))) MemTrackTable();
+		CallstackTable* callstacks = new (UntrackedAlloc(sizeof(CallstackTable))) CallstackTable();
+		std::atomic<bool> failed = false;
+		std::vector<std::thread> threads;
+
+		double startTime = GetCurrentTimeSeconds();
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			threads.emplace_back(MemTrackTableTestThread, table, callstacks, threadIndex, &failed);
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		double shardedTime = GetCurrentTimeSeconds() - startTime;
+		threads.clear();
+		CONFIRM(!failed.load());
+
+		std::mutex mapLock;
+		SingleLockMap* map = new SingleLockMap();
+
+		startTime = GetCurrentTimeSeconds();
+		for (uint threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+		{
+			threads.emplace_back([&, threadIndex]()
+			{
+				for (uint allocIndex = 0; allocIndex < MEMTABLETEST_ALLOCS_PER_THREAD; ++allocIndex)
+				{
+					MemTrackRecord_T record;
+					record.m_pointer = GetFakeAllocation(threadIndex, allocIndex);
+					record.m_byteSize = allocIndex + 1;
+					{
+						std::scoped_lock lock(mapLock);
+						(*map)[record.m_pointer] = record;
+					}
+
+					if (allocIndex >= MEMTABLETEST_LIVE_WINDOW)
+					{
+						std::scoped_lock lock(mapLock);
+						map->erase(GetFakeAllocation(threadIndex, allocIndex - MEMTABLETEST_LIVE_WINDOW));
+					}
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		double mapTime = GetCurrentTimeSeconds() - startTime;
+
+		delete map;
+		table->~MemTrackTable();
+		UntrackedFree(table);
+		UntrackedFree(callstacks);
+
+		double numOperations = (double)threadCount * MEMTABLETEST_ALLOCS_PER_THREAD;
+		DebuggerPrintf("\n %u threads: sharded table %.1f ns per track/untrack, single lock map %.1f ns per track/untrack", threadCount, (shardedTime * 1'000'000'000.0) / numOperations, (mapTime * 1'000'000'000.0) / numOperations);
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+#define MEMSAMPLETEST_RATE_BYTES 4096
+#define MEMSAMPLETEST_ALLOCATIONS 2'000'000
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Scaling the sampled records back up should land close to what was really allocated, for small and large sizes alike
+UNITTEST("MemTrackSamplingEstimate", "MemTracking", 100)
+{
+	static const size_t sizes[] = { 16, 64, 200, 1024, 8192, 100'000 };
+
+	for (size_t byteSize : sizes)
+	{
+		uint numAllocations = (uint)(((size_t)MEMSAMPLETEST_ALLOCATIONS * 64) / byteSize);
+		size_t actualBytes = 0;
+		size_t estimatedBytes = 0;
+
+		for (uint allocIndex = 0; allocIndex < numAllocations; ++allocIndex)
+		{
+			actualBytes += byteSize;
+			if (MemTrackShouldSample(byteSize, MEMSAMPLETEST_RATE_BYTES))
+			{
+				estimatedBytes += MemTrackGetSampleWeight(byteSize, MEMSAMPLETEST_RATE_BYTES);
+			}
+		}
+
+		double error = fabs((double)estimatedBytes - (double)actualBytes) / (double)actualBytes;
+		CONFIRM(error < 0.05);
+	}
+
+	SampledPointerFilter* filter = new (UntrackedAlloc(sizeof(SampledPointerFilter))) SampledPointerFilter();
+	int value = 0;
+	filter->Add(&value);
+	CONFIRM(filter->MayContain(&value));
+	filter->Remove(&value);
+	CONFIRM(!filter->MayContain(&value));
+	UntrackedFree(filter);
+
+	return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Cost per malloc/free pair of what each tracking mode adds on top of the allocation itself
+UNITTEST("MemTrackSamplingOverhead", "MemTracking", 200)
+{
+	static const size_t sizes[] = { 16, 48, 128, 512, 2048 };
+	static const uint numSizes = sizeof(sizes) / sizeof(sizes[0]);
+	static const uint numAllocations = 1'000'000;
+	static const size_t sampleRateBytes = 512 * 1024;
+
+	std::atomic<size_t> totalAllocations = 0;
+	std::vector<void*> liveAllocations(64);
+
+	//MEM_TRACK_ALLOC_COUNT: count and forward
+	double startTime = GetCurrentTimeSeconds();
+	for (uint allocIndex = 0; allocIndex < numAllocations; ++allocIndex)
+	{
+		void*& slot = liveAllocations[allocIndex & 63];
+		if (slot != nullptr)
+		{
+			--totalAllocations;
+			UntrackedFree(slot);
+		}
+
+		++totalAllocations;
+		slot = UntrackedAlloc(sizes[allocIndex % numSizes]);
+	}
+	double countTime = GetCurrentTimeSeconds() - startTime;
+
+	for (void*& slot : liveAllocations)
+	{
+		UntrackedFree(slot);
+		slot = nullptr;
+	}
+
+	//MEM_TRACK_SAMPLED: count, countdown, and a filter check on free
+	MemTrackTable* table = new (UntrackedAlloc(sizeof(MemTrackTable))) MemTrackTable();
+	CallstackTable* callstacks = new (UntrackedAlloc(sizeof(CallstackTable))) CallstackTable();
+	SampledPointerFilter* filter = new (UntrackedAlloc(sizeof(SampledPointerFilter))) SampledPointerFilter();
+	uint numSampled = 0;
+
+	startTime = GetCurrentTimeSeconds();
+	for (uint allocIndex = 0; allocIndex < numAllocations; ++allocIndex)
+	{
+		void*& slot = liveAllocations[allocIndex & 63];
+		if (slot != nullptr)
+		{
+			--totalAllocations;
+			MemTrackRecord_T record;
+			if (filter->MayContain(slot) && table->Remove(slot, &record))
+			{
+				filter->Remove(slot);
+			}
+			UntrackedFree(slot);
+		}
+
+		++totalAllocations;
+		size_t byteSize = sizes[allocIndex % numSizes];
+		slot = UntrackedAlloc(byteSize);
+
+		if (MemTrackShouldSample(byteSize, sampleRateBytes))
+		{
+			void* trace[MEM_TRACK_CALLSTACK_DEPTH];
+			unsigned long hash = 0;
+			uint depth = CallstackCapture(trace, MEM_TRACK_CALLSTACK_DEPTH, 0, &hash);
+
+			table->Add(slot, byteSize, callstacks->Intern(trace, depth, hash));
+			filter->Add(slot);
+			numSampled++;
+		}
+	}
+	double sampledTime = GetCurrentTimeSeconds() - startTime;
+
+	for (void*& slot : liveAllocations)
+	{
+		UntrackedFree(slot);
+		slot = nullptr;
+	}
+
+	table->~MemTrackTable();
+	UntrackedFree(table);
+	UntrackedFree(callstacks);
+	UntrackedFree(filter);
+
+	DebuggerPrintf("\n Tracking cost per alloc/free: alloc count %.1f ns, sampled every %zu KB %.1f ns (%u of %u allocations sampled)", (countTime * 1'000'000'000.0) / numAllocations, sampleRateBytes / 1024, (sampledTime * 1'000'000'000.0) / numAllocations, numSampled, numAllocations);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+#include "Engine/Commons/Callstack.hpp"
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------------------------------------------------------
+constexpr uint MEM_TRACK_SHARD_COUNT = 64;					// Power of 2, picked from the pointer hash
+constexpr uint MEM_TRACK_SHARD_INITIAL_CAPACITY = 1024;		// Power of 2, shards double when they pass 3/4 full
+constexpr uint CALLSTACK_TABLE_CAPACITY = 16384;			// Power of 2, unique callstacks we can remember
+constexpr uint MEM_TRACK_CALLSTACK_DEPTH = 32;				// Frames captured per tracked allocation
+constexpr uint INVALID_CALLSTACK_ID = 0xFFFFFFFF;
+constexpr uint MEM_TRACK_SAMPLE_FILTER_SIZE = 65536;		// Power of 2, counters in the sampled pointer filter
+
+//------------------------------------------------------------------------------------------------------------------------------
+struct MemTrackRecord_T
+{
+	void*		m_pointer = nullptr;
+	size_t		m_byteSize = 0;
+	uint		m_callstackId = INVALID_CALLSTACK_ID;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Deduplicated callstacks keyed by Callstack::m_hash. Each unique callstack is stored once and handed out as a small id
+// so tracking records don't carry a copy of the trace. Interning is lock-free (a CAS to claim a slot), entries are never
+// removed. Different callstacks with the same hash share an entry, same as the hash keyed logging always did.
+//------------------------------------------------------------------------------------------------------------------------------
+class CallstackTable
+{
+public:
+	uint						Intern(void* const* trace, uint depth, unsigned long hash);	// returns INVALID_CALLSTACK_ID when full
+	bool						GetCallstack(uint callstackId, Callstack* out) const;
+	uint						GetNumCallstacks() const	{ return m_numCallstacks.load(std::memory_order_relaxed); }
+
+private:
+	struct Entry_T
+	{
+		std::atomic<uint64_t>	m_key;			// hash + 1, 0 means empty
+		std::atomic<Callstack*>	m_callstack;	// set once the owner finishes copying the trace
+	};
+
+	Entry_T						m_entries[CALLSTACK_TABLE_CAPACITY] = {};
+	std::atomic<uint>			m_numCallstacks = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Live allocation records in open addressing hash tables (linear probing, backward shift deletes). The table is split
+// into MEM_TRACK_SHARD_COUNT shards chosen by pointer bits, each with its own lock, so threads tracking different
+// allocations rarely contend. All storage comes from UntrackedAlloc so this is safe to call from operator new.
+// Nothing passed to ForEach may do tracked allocations since the shard lock is held while it runs.
+//------------------------------------------------------------------------------------------------------------------------------
+class MemTrackTable
+{
+public:
+	~MemTrackTable();
+
+	void						Add(void* pointer, size_t byteSize, uint callstackId);
+	bool						Remove(void* pointer, MemTrackRecord_T* outRecord);		// false if pointer wasn't tracked
+
+	size_t						GetNumRecords() const;
+
+	template <typename FUNC>
+	void						ForEach(FUNC const& fn);	// fn(MemTrackRecord_T const&) for every live record
+
+private:
+	//Keep neighbouring locks off each other's cache lines
+	struct alignas(64) Shard_T
+	{
+		std::mutex				m_lock;
+		MemTrackRecord_T*		m_records = nullptr;
+		uint					m_capacity = 0;
+		uint					m_numRecords = 0;
+	};
+
+	static uint64_t				HashPointer(void* pointer);
+	static void					InsertRecord(Shard_T& shard, MemTrackRecord_T const& record, uint64_t hash);
+	static void					GrowShard(Shard_T& shard);
+
+private:
+	Shard_T						m_shards[MEM_TRACK_SHARD_COUNT];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+// NOTE: Sampling helpers. Every thread counts down a random number of bytes (exponentially distributed with a mean of
+// sampleRateBytes) and the allocation that crosses zero gets sampled, so on average one allocation is recorded per
+// sampleRateBytes allocated no matter how sizes are mixed. A sampled allocation of byteSize stands in for
+// MemTrackGetSampleWeight bytes of live memory, which is byteSize divided by the chance it had of being sampled.
+//------------------------------------------------------------------------------------------------------------------------------
+bool		MemTrackShouldSample(size_t byteSize, size_t sampleRateBytes);
+size_t		MemTrackGetSampleWeight(size_t byteSize, size_t sampleRateBytes);
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Counting filter over sampled pointers so frees of allocations that were never sampled (nearly all of them) can skip the
+// table lookup. MayContain can say yes for a pointer that was never added, never no for one that was.
+//------------------------------------------------------------------------------------------------------------------------------
+class SampledPointerFilter
+{
+public:
+	void						Add(void* pointer);
+	void						Remove(void* pointer);
+	bool						MayContain(void* pointer) const;
+
+private:
+	static uint					GetCounterIndex(void* pointer);
+
+private:
+	std::atomic<uint8_t>		m_counters[MEM_TRACK_SAMPLE_FILTER_SIZE] = {};
+};
+
+//------------------------------------------------------------------------------------------------------------------------------
+template <typename FUNC>
+void MemTrackTable::ForEach(FUNC const& fn)
+{
+	for (uint shardIndex = 0; shardIndex < MEM_TRACK_SHARD_COUNT; ++shardIndex)
+	{
+		Shard_T& shard = m_shards[shardIndex];
+		std::scoped_lock lock(shard.m_lock);
+
+		for (uint recordIndex = 0; recordIndex < shard.m_capacity; ++recordIndex)
+		{
+			if (shard.m_records[recordIndex].m_pointer != nullptr)
+			{
+				fn(shard.m_records[recordIndex]);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Engine/Core/MemTracking.hpp"
-#include "Engine/Allocators/TemplatedUntrackedAllocator.hpp"
+#include "Engine/Allocators/SizeClassAllocator.hpp"
+#include "Engine/Allocators/TemplatedPoolAllocator.hpp"
+#include "Engine/Core/MemTrackTable.hpp"
 #include "Engine/Commons/EngineCommon.hpp"
 #include "Game/EngineBuildPreferences.hpp"
 #include <malloc.h>
@@ -11,33 +13,40 @@
 #include <chrono>
 #include <thread>
 #include <map>
+#include <new>
 
 using namespace std::chrono_literals;
 
-/*
-std::mutex gTrackerLock;
-
-std::map<void*,		// key
-	MemTrackInfo_T, // value
-	std::less<void*>, // less to use for map
-	UntrackedAllocator<std::pair<void* const, MemTrackInfo_T>> // allocator  
-> gMemTrackers;
-*/
+//------------------------------------------------------------------------------------------------------------------------------
+// Function statics so they are ready no matter how early the first tracked allocation happens. They are built in static
+// storage and never destroyed, tracked frees can still come in from other static destructors at exit
+//------------------------------------------------------------------------------------------------------------------------------
+MemTrackTable& GetMemTrackTable()
+{
+	alignas(MemTrackTable) static uint8_t memTrackTableStorage[sizeof(MemTrackTable)];
+	static MemTrackTable* memTrackTable = new (memTrackTableStorage) MemTrackTable();
+	return *memTrackTable;
+}
 
 //------------------------------------------------------------------------------------------------------------------------------
-std::mutex& GetMemTrackerLock()
+CallstackTable& GetCallstackTable()
 {
-	static std::mutex trackerLock;
-	return trackerLock;
+	alignas(CallstackTable) static uint8_t callstackTableStorage[sizeof(CallstackTable)];
+	static CallstackTable* callstackTable = new (callstackTableStorage) CallstackTable();
+	return *callstackTable;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------
-std::map<void*,	MemTrackInfo_T,	std::less<void*>, TemplatedUntrackedAllocator<std::pair<void* const, MemTrackInfo_T>>>& GetMemTrakingMap()
+SampledPointerFilter& GetSampledPointerFilter()
 {
-	static std::map<void*, MemTrackInfo_T, std::less<void*>, TemplatedUntrackedAllocator<std::pair<void* const, MemTrackInfo_T>>> memTrackerMap;
-	return memTrackerMap;
+	alignas(SampledPointerFilter) static uint8_t sampledPointerFilterStorage[sizeof(SampledPointerFilter)];
+	static SampledPointerFilter* sampledPointerFilter = new (sampledPointerFilterStorage) SampledPointerFilter();
+	return *sampledPointerFilter;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+// Live bytes estimated from the sampled records
+static std::atomic<size_t> gSampledLiveBytes = 0U;
 
 //------------------------------------------------------------------------------------------------------------------------------
 std::string GetSizeString(size_t byte_count)
@@ -101,6 +110,18 @@ void* TrackedAlloc(size_t byte_count)
 		void* allocation = ::malloc(byte_count);
 		TrackAllocation(allocation, byte_count);
 		return allocation;
+	#elif (MEM_TRACKING == MEM_TRACK_SAMPLED)
+		++gTotalAllocations;
+
+		//Bytes are only counted for sampled allocations, see TrackAllocation
+		++tTotalAllocations;
+
+		void* allocation = ::malloc(byte_count);
+		if (MemTrackShouldSample(byte_count, MEM_TRACK_SAMPLE_RATE_BYTES))
+		{
+			TrackAllocation(allocation, byte_count);
+		}
+		return allocation;
 	#endif
 #endif
 }
@@ -120,6 +141,14 @@ void TrackedFree(void* ptr)
 
 	++tTotalFrees;
 
+	UntrackAllocation(ptr);
+#elif (MEM_TRACKING == MEM_TRACK_SAMPLED)
+	if (ptr == nullptr)
+		return;
+
+	--gTotalAllocations;
+	++tTotalFrees;
+
 	UntrackAllocation(ptr);
 #endif
 }
@@ -127,35 +156,63 @@ void TrackedFree(void* ptr)
 //------------------------------------------------------------------------
 void TrackAllocation(void* allocation, size_t byte_count)
 {
-#if (MEM_TRACKING == MEM_TRACK_VERBOSE)
-	Callstack callstack = CallstackGet();
-	
-	MemTrackInfo_T info;
-
-	info.m_byteSize = byte_count;
-	info.m_callstack = callstack;
-	info.m_originalPointer = allocation;
-	{
-		std::scoped_lock lock(GetMemTrackerLock());
-		GetMemTrakingMap()[allocation] = info;
-	}
+#if (MEM_TRACKING == MEM_TRACK_VERBOSE) || (MEM_TRACKING == MEM_TRACK_SAMPLED)
+	//Only capture what we need straight into a stack buffer, the full trace is only copied the first time we see it
+	void* trace[MEM_TRACK_CALLSTACK_DEPTH];
+	unsigned long hash = 0;
+	uint depth = CallstackCapture(trace, MEM_TRACK_CALLSTACK_DEPTH, 2, &hash);
+
+	uint callstackId = GetCallstackTable().Intern(trace, depth, hash);
+	GetMemTrackTable().Add(allocation, byte_count, callstackId);
+
+	#if (MEM_TRACKING == MEM_TRACK_SAMPLED)
+		//Frees only see the sampled allocations, so both byte counts are estimated from the samples to stay comparable
+		size_t sampleWeight = MemTrackGetSampleWeight(byte_count, MEM_TRACK_SAMPLE_RATE_BYTES);
+		GetSampledPointerFilter().Add(allocation);
+		gSampledLiveBytes += sampleWeight;
+		tTotalBytesAllocated += sampleWeight;
+	#endif
+#else
+	UNUSED(allocation);
+	UNUSED(byte_count);
 #endif
 }
 
 //------------------------------------------------------------------------
 void UntrackAllocation(void* allocation)
 {
+#if (MEM_TRACKING == MEM_TRACK_SAMPLED)
+	//Almost nothing is sampled, don't go near the table unless the filter says we might have it
+	if (!GetSampledPointerFilter().MayContain(allocation))
 	{
-		std::scoped_lock lock(GetMemTrackerLock());
-		auto mapIterator = GetMemTrakingMap().find(allocation);
 		::free(allocation);
-		if (mapIterator != GetMemTrakingMap().end())
-		{
-			gTotalBytesAllocated -= mapIterator->second.m_byteSize;
-			tTotalBytesFreed += mapIterator->second.m_byteSize;
-			GetMemTrakingMap().erase(mapIterator);
-		}
+		return;
+	}
+
+	MemTrackRecord_T sampledRecord;
+	bool wasSampled = GetMemTrackTable().Remove(allocation, &sampledRecord);
+	::free(allocation);
+
+	if (wasSampled)
+	{
+		size_t sampleWeight = MemTrackGetSampleWeight(sampledRecord.m_byteSize, MEM_TRACK_SAMPLE_RATE_BYTES);
+		GetSampledPointerFilter().Remove(allocation);
+		gSampledLiveBytes -= sampleWeight;
+		tTotalBytesFreed += sampleWeight;
+	}
+#else
+	MemTrackRecord_T record;
+	bool wasTracked = GetMemTrackTable().Remove(allocation, &record);
+
+	//Free outside of any tracking lock
+	::free(allocation);
+
+	if (wasTracked)
+	{
+		gTotalBytesAllocated -= record.m_byteSize;
+		tTotalBytesFreed += record.m_byteSize;
 	}
+#endif
 }
 
 //------------------------------------------------------------------------
@@ -171,7 +228,9 @@ size_t MemTrackGetLiveAllocationCount()
 //------------------------------------------------------------------------
 size_t MemTrackGetLiveByteCount()
 {
-#if defined(MEM_TRACKING)
+#if defined(MEM_TRACKING) && (MEM_TRACKING == MEM_TRACK_SAMPLED)
+	return gSampledLiveBytes;
+#elif defined(MEM_TRACKING)
 	return gTotalBytesAllocated;
 #else
 	return 0;
@@ -188,51 +247,55 @@ bool MemVecSortFunction(LogTrackInfo_T const& a, LogTrackInfo_T const& b)
 void MemTrackLogLiveAllocations()
 {
 #if defined(MEM_TRACKING)
-	#if (MEM_TRACKING == MEM_TRACK_VERBOSE)
-		//Create a thread safe copy of the map but use callstack as key and pair of num allocations and alloc size as value
-
-		std::map<unsigned long, LogTrackInfo_T, std::less<unsigned long>, TemplatedUntrackedAllocator<std::pair<unsigned long const, LogTrackInfo_T>>> memLoggerMap;
-
-		std::map<unsigned long, LogTrackInfo_T, std::less<unsigned long>, TemplatedUntrackedAllocator<std::pair<unsigned long const, LogTrackInfo_T>>>::iterator memLoggerIterator;
-		std::map<void*, MemTrackInfo_T, std::less<void*>, TemplatedUntrackedAllocator<std::pair<void* const, MemTrackInfo_T>>>::iterator memTrackerIterator;
+	#if (MEM_TRACKING == MEM_TRACK_VERBOSE) || (MEM_TRACKING == MEM_TRACK_SAMPLED)
+		//Gather live allocations per callstack. Only untracked memory may be allocated while a shard is locked
+		typedef std::map<uint, LogTrackInfo_T, std::less<uint>, TemplatedPoolAllocator<std::pair<uint const, LogTrackInfo_T>>> MemLoggerMap;
+		MemLoggerMap memLoggerMap;
 
 		size_t totalAllocationSize = 0;
 		uint totalAllocations = 0;
 
-		memTrackerIterator = GetMemTrakingMap().begin();
+		GetMemTrackTable().ForEach([&](MemTrackRecord_T const& record)
 		{
-			std::scoped_lock lock(GetMemTrackerLock());
-			while (memTrackerIterator != GetMemTrakingMap().end())
+			//Sampled records stand in for everything that wasn't sampled, scale them up to an estimate
+		#if (MEM_TRACKING == MEM_TRACK_SAMPLED)
+			size_t recordBytes = MemTrackGetSampleWeight(record.m_byteSize, MEM_TRACK_SAMPLE_RATE_BYTES);
+			uint recordAllocations = (uint)((recordBytes + record.m_byteSize / 2) / record.m_byteSize);
+		#else
+			size_t recordBytes = record.m_byteSize;
+			uint recordAllocations = 1;
+		#endif
+
+			MemLoggerMap::iterator memLoggerIterator = memLoggerMap.find(record.m_callstackId);
+			if (memLoggerIterator == memLoggerMap.end())
 			{
-				memLoggerIterator = memLoggerMap.find(memTrackerIterator->second.m_callstack.m_hash);
-				if (memLoggerIterator == memLoggerMap.end())
-				{
-					//This hash doesn't exist in the map
-					LogTrackInfo_T info;
-					info.m_allocationSizeInBytes = memTrackerIterator->second.m_byteSize;
-					info.m_numAllocations = 1;
-					info.m_callstack = memTrackerIterator->second.m_callstack;
-
-					memLoggerMap[memTrackerIterator->second.m_callstack.m_hash] = info;
-				}
-				else
-				{
-					//Hash exists in map so update data (except the callstack as it will be the same)
-					memLoggerIterator->second.m_allocationSizeInBytes += memTrackerIterator->second.m_byteSize;
-					++memLoggerIterator->second.m_numAllocations;
-				}
-
-				totalAllocationSize += memTrackerIterator->second.m_byteSize;
-				totalAllocations++;
-				memTrackerIterator++;
+				//First allocation we have seen from this callstack
+				LogTrackInfo_T& info = memLoggerMap[record.m_callstackId];
+				info.m_allocationSizeInBytes = recordBytes;
+				info.m_numAllocations = recordAllocations;
+			}
+			else
+			{
+				memLoggerIterator->second.m_allocationSizeInBytes += recordBytes;
+				memLoggerIterator->second.m_numAllocations += recordAllocations;
 			}
-		}
 
+			totalAllocationSize += recordBytes;
+			totalAllocations += recordAllocations;
+		});
+
+		//Callstacks are only looked up once per unique stack, after the shards are unlocked
+		MemLoggerMap::iterator memLoggerIterator = memLoggerMap.begin();
+		while (memLoggerIterator != memLoggerMap.end())
+		{
+			GetCallstackTable().GetCallstack(memLoggerIterator->first, &memLoggerIterator->second.m_callstack);
+			memLoggerIterator++;
+		}
 
 		//Sort Map
 		std::vector<LogTrackInfo_T> logVector;
 
-		std::map<unsigned long, LogTrackInfo_T, std::less<unsigned long>, TemplatedUntrackedAllocator<std::pair<unsigned long const, LogTrackInfo_T>>>::iterator logMapItr;
+		MemLoggerMap::iterator logMapItr;
 		logMapItr = memLoggerMap.begin();
 
 		while (logMapItr != memLoggerMap.end())
@@ -245,6 +308,9 @@ void MemTrackLogLiveAllocations()
 
 		//Log all the elements in the vector
 		DebuggerPrintf("===== BEGIN MEMORY LOG =====");
+	#if (MEM_TRACKING == MEM_TRACK_SAMPLED)
+		DebuggerPrintf("\n Sampled every %u bytes, counts and sizes below are estimates", (uint)MEM_TRACK_SAMPLE_RATE_BYTES);
+	#endif
 		DebuggerPrintf("\n Total Allocations live: %u", totalAllocations);
 		std::string bytesAllocated = GetSizeString(totalAllocationSize);
 		DebuggerPrintf("\n %s \n", bytesAllocated.c_str());
@@ -255,7 +321,12 @@ void MemTrackLogLiveAllocations()
 			DebuggerPrintf("\n Num allocations for hash: %u", logVecItr->m_numAllocations);
 			bytesAllocated = GetSizeString(logVecItr->m_allocationSizeInBytes);
 			DebuggerPrintf("\n %s \n", bytesAllocated.c_str());
-			std::vector<std::string> callStackString = GetCallstackToString(logVecItr->m_callstack);
+
+			//Callstacks that didn't fit in the callstack table come through empty
+			if (logVecItr->m_callstack.m_depth > 2)
+			{
+				std::vector<std::string> callStackString = GetCallstackToString(logVecItr->m_callstack);
+			}
 
 			logVecItr++;
 		}
@@ -266,6 +337,49 @@ void MemTrackLogLiveAllocations()
 #endif
 }
 
+#if defined(ENGINE_USE_POOLED_NEW)
+	#if defined(MEM_TRACKING) && ((MEM_TRACKING == MEM_TRACK_VERBOSE) || (MEM_TRACKING == MEM_TRACK_SAMPLED))
+		#error ENGINE_USE_POOLED_NEW only works with MEM_TRACK_ALLOC_COUNT or no MEM_TRACKING, the tracked modes free with ::free
+	#endif
+
+//------------------------------------------------------------------------------------------------------------------------------
+// Global new and delete go through the size class pools (thread cached BlockAllocators, UntrackedAllocator for big ones)
+// The size header on every allocation lets delete keep the per thread byte counts the profiler reads
+//------------------------------------------------------------------------------------------------------------------------------
+void* operator new(size_t size)
+{
+	#if defined(MEM_TRACKING)
+		++gTotalAllocations;
+	#endif
+
+	++tTotalAllocations;
+	tTotalBytesAllocated += size;
+
+	void* buffer = PooledAlloc(size);
+	if (buffer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return buffer;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
+void operator delete(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	#if defined(MEM_TRACKING)
+		--gTotalAllocations;
+	#endif
+
+	++tTotalFrees;
+	tTotalBytesFreed += SizeClassAllocator::GetAllocationSize(ptr);
+
+	PooledFree(ptr);
+}
+#else
 //------------------------------------------------------------------------------------------------------------------------------
 void* operator new(size_t size)
 {
@@ -277,6 +391,7 @@ void operator delete(void* ptr)
 {
 	TrackedFree(ptr);
 }
+#endif
 
 //------------------------------------------------------------------------------------------------------------------------------
 void* operator new(size_t size, InternalAllocator& allocator)
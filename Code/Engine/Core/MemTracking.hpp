@@ -5,12 +5,27 @@
 #include <mutex>
 #include <string>
 
-struct MemTrackInfo_T
-{
-	void* m_originalPointer;
-	size_t m_byteSize;
-	Callstack m_callstack;
-};
+//------------------------------------------------------------------------------------------------------------------------------
+// MEM_TRACKING modes come from EngineBuildPreferences, these are the defaults for the ones it may leave out
+//------------------------------------------------------------------------------------------------------------------------------
+#include "Game/EngineBuildPreferences.hpp"
+
+#if !defined(MEM_TRACK_SAMPLED)
+	#define MEM_TRACK_SAMPLED 2
+#endif
+
+#if (defined(MEM_TRACK_ALLOC_COUNT) && (MEM_TRACK_SAMPLED == MEM_TRACK_ALLOC_COUNT)) || (defined(MEM_TRACK_VERBOSE) && (MEM_TRACK_SAMPLED == MEM_TRACK_VERBOSE))
+	#error MEM_TRACK_SAMPLED has the same value as another MEM_TRACKING mode, define it to something else in EngineBuildPreferences
+#endif
+
+// Sampled tracking records roughly one allocation per this many bytes allocated on each thread. The per-thread bytes
+// allocated and freed the profiler shows are estimated from the samples too, the allocation counts stay exact
+#if !defined(MEM_TRACK_SAMPLE_RATE_BYTES)
+	#define MEM_TRACK_SAMPLE_RATE_BYTES (512 * 1024)
+#endif
+
+// Define ENGINE_USE_POOLED_NEW in EngineBuildPreferences to route global new and delete into the size class pools
+// (see PooledAlloc). Only valid without MEM_TRACKING or with MEM_TRACK_ALLOC_COUNT.
 
 struct LogTrackInfo_T
 {
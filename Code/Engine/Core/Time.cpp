@@ -50,6 +50,30 @@ double GetHPCToSeconds(uint64_t hpc)
 	return (double)hpc * secondsPerCount;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------
+double GetProcessCPUTimeSeconds()
+{
+	FILETIME creationTime;
+	FILETIME exitTime;
+	FILETIME kernelTime;
+	FILETIME userTime;
+	if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+	{
+		return 0.0;
+	}
+
+	ULARGE_INTEGER kernel;
+	kernel.LowPart = kernelTime.dwLowDateTime;
+	kernel.HighPart = kernelTime.dwHighDateTime;
+
+	ULARGE_INTEGER user;
+	user.LowPart = userTime.dwLowDateTime;
+	user.HighPart = userTime.dwHighDateTime;
+
+	//FILETIME is in 100 nanosecond ticks
+	return (double)(kernel.QuadPart + user.QuadPart) * 0.0000001;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------
 std::string GetDateTime()
 {
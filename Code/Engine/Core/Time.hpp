@@ -11,4 +11,7 @@ double GetCurrentTimeSeconds();
 uint64_t GetCurrentTimeHPC();
 double GetHPCToSeconds(uint64_t hpc);
 
+//CPU time used by every thread in this process (user + kernel)
+double GetProcessCPUTimeSeconds();
+
 std::string GetDateTime();
\ No newline at end of file
@@ -2,6 +2,7 @@
 //3rd Party tools
 #include "ThirdParty/stb/stb_image.h"
 //Core systems
+#include "Engine/Allocators/FrameArenaAllocator.hpp"
 #include "Engine/Commons/Profiler/Profiler.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/Image.hpp"
@@ -567,6 +568,10 @@ void RenderContext::BeginFrame()
 {
 	gProfiler->ProfilerPush("RenderContext::BeginFrame");
 
+	//Per-frame scratch memory from last frame stays valid for this one, the frame before that gets reused.
+	//The first frame also creates the arena so it is never built lazily on a job thread
+	FrameArenaAllocator::GetInstance()->BeginFrame();
+
 	// Get the back buffer
 	ID3D11Texture2D *back_buffer = nullptr;
 	m_D3DSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&back_buffer);